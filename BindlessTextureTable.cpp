@@ -0,0 +1,74 @@
+#include "BindlessTextureTable.h"
+#include "globals.h"
+#include "LogicalDeviceWrapper.h"
+#include "DescriptorSetWrapper.h"
+
+/*
+
+	The layout is the bindless set of a pipeline layout, textureBinding and samplerBinding are its
+	SAMPLED_IMAGE and SAMPLER arrays. Their sizes come from the layout.
+
+*/
+BindlessTextureTable::BindlessTextureTable(LogicalDeviceWrapper* lDevice, DescriptorSetLayoutWrapper* layout, uint32_t textureBinding, uint32_t samplerBinding) : mTextureBinding(textureBinding), mSamplerBinding(samplerBinding), mTextureHead(0), mSamplerHead(0), mLogicalDevice(lDevice) {
+	if (layout->GetDescriptorType(textureBinding) != VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE || layout->GetDescriptorType(samplerBinding) != VK_DESCRIPTOR_TYPE_SAMPLER) {
+		throw std::runtime_error("Failed to create Bindless Texture Table! The layout needs a SAMPLED_IMAGE and a SAMPLER array.");
+	}
+	mTextureCapacity = layout->GetDescriptorCount(textureBinding);
+	mSamplerCapacity = layout->GetDescriptorCount(samplerBinding);
+
+	VkDescriptorPoolCreateFlags poolFlags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+	if (layout->IsUpdateAfterBind()) {
+		poolFlags |= VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+	}
+	mDescriptorPool = new DescriptorPoolWrapper(mLogicalDevice, layout->GetPoolSizes(1), 1, poolFlags);
+	mDescriptorSet = new DescriptorSetWrapper(mLogicalDevice, layout, mDescriptorPool);
+
+	std::cout << "Success: Bindless Texture Table created. (" << mTextureCapacity << " textures, " << mSamplerCapacity << " samplers)" << std::endl;
+}
+
+BindlessTextureTable::~BindlessTextureTable() {
+	delete mDescriptorSet;
+	delete mDescriptorPool;
+	std::cout << "Success: Bindless Texture Table destroyed." << std::endl;
+}
+
+uint32_t BindlessTextureTable::AddTexture(ImageViewWrapper* imageView) {
+	uint32_t slot;
+	if (!mFreeTextureSlots.empty()) {
+		slot = mFreeTextureSlots.back();
+		mFreeTextureSlots.pop_back();
+	} else if (mTextureHead < mTextureCapacity) {
+		slot = mTextureHead++;
+	} else {
+		throw std::runtime_error("Failed to add texture! The bindless table is full (" + std::to_string(mTextureCapacity) + " textures).");
+	}
+
+	mDescriptorSet->WriteImage(mTextureBinding, slot, imageView, nullptr);
+	return slot;
+}
+
+void BindlessTextureTable::RemoveTexture(uint32_t slot) {
+	if (slot >= mTextureHead) {
+		throw std::runtime_error("Attempted to remove texture slot " + std::to_string(slot) + " that was never added!");
+	}
+	// Partially bound, so the stale descriptor can stay until the slot is written again
+	mFreeTextureSlots.push_back(slot);
+}
+
+uint32_t BindlessTextureTable::AddSampler(SamplerWrapper* sampler) {
+	if (mSamplerHead >= mSamplerCapacity) {
+		throw std::runtime_error("Failed to add sampler! The bindless table is full (" + std::to_string(mSamplerCapacity) + " samplers).");
+	}
+
+	uint32_t slot = mSamplerHead++;
+	mDescriptorSet->WriteImage(mSamplerBinding, slot, nullptr, sampler);
+	return slot;
+}
+
+DescriptorSetWrapper* BindlessTextureTable::GetDescriptorSet() {
+	return mDescriptorSet;
+}
+
+uint32_t BindlessTextureTable::GetTextureCount() {
+	return mTextureHead - (uint32_t)mFreeTextureSlots.size();
+}
@@ -0,0 +1,60 @@
+#ifndef BINDLESS_TEXTURE_TABLE_H
+#define BINDLESS_TEXTURE_TABLE_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+
+class LogicalDeviceWrapper;
+class DescriptorSetLayoutWrapper;
+class DescriptorPoolWrapper;
+class DescriptorSetWrapper;
+class ImageViewWrapper;
+class SamplerWrapper;
+
+/*
+
+	BindlessTextureTable is one descriptor set holding every texture and sampler the renderer uses, as two
+	unbounded arrays (see DescriptorLayoutCache). Textures and samplers are registered into a slot and
+	shaders index the arrays with the slots they get through push constants, so a single bind of the
+	set covers every draw.
+
+	Notes:
+		- The arrays are PARTIALLY_BOUND, slots that were never written are fine as long as no shader
+		  reads them.
+		- They're UPDATE_AFTER_BIND too, so registering a texture doesn't invalidate command buffers that
+		  already bound the set. The caches of recorded frames can stay.
+		- Writing a slot while frames that use the set are still pending on the GPU is only legal because
+		  the bindings are also UPDATE_UNUSED_WHILE_PENDING (descriptorBindingUpdateUnusedWhilePending).
+		  That covers slots no pending frame reads, which is every slot AddTexture() / AddSampler() hand out.
+		- A slot given back with RemoveTexture() is handed out again by the next AddTexture(). The caller
+		  has to make sure no frame in flight still samples it.
+		- Doesn't own the image views or samplers.
+
+*/
+
+class BindlessTextureTable {
+public:
+	BindlessTextureTable(LogicalDeviceWrapper*, DescriptorSetLayoutWrapper*, uint32_t, uint32_t);
+	~BindlessTextureTable();
+
+	uint32_t AddTexture(ImageViewWrapper*);
+	void RemoveTexture(uint32_t);
+	uint32_t AddSampler(SamplerWrapper*);
+
+	DescriptorSetWrapper* GetDescriptorSet();
+	uint32_t GetTextureCount();
+private:
+	DescriptorPoolWrapper* mDescriptorPool;
+	DescriptorSetWrapper* mDescriptorSet;
+
+	uint32_t mTextureBinding;
+	uint32_t mSamplerBinding;
+	uint32_t mTextureCapacity;
+	uint32_t mSamplerCapacity;
+	uint32_t mTextureHead;								// Slots below the head have been handed out at least once
+	uint32_t mSamplerHead;
+	std::vector<uint32_t> mFreeTextureSlots;
+
+	LogicalDeviceWrapper* mLogicalDevice;
+};
+#endif
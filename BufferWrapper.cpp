@@ -2,24 +2,32 @@
 #include "globals.h"
 #include "PhysicalDeviceWrapper.h"
 #include "LogicalDeviceWrapper.h"
-#include "CommandPoolWrapper.h"
-#include "CommandBufferWrapper.h"
+#include "MemoryAllocator.h"
 #include "ImageWrapper.h"
 
 BufferWrapper::BufferWrapper(PhysicalDeviceWrapper* pDevice, LogicalDeviceWrapper* lDevice, VkDeviceSize dSize, VkBufferUsageFlags uFlags, VkMemoryPropertyFlags pFlags) : mPhysicalDevice(pDevice), mLogicalDevice(lDevice) {
-	CreateBuffer(dSize, uFlags, pFlags);
+	CreateBuffer(dSize, uFlags, { pFlags, 0, 0 });
+}
+
+BufferWrapper::BufferWrapper(PhysicalDeviceWrapper* pDevice, LogicalDeviceWrapper* lDevice, VkDeviceSize dSize, VkBufferUsageFlags uFlags, MemoryTypeRequest request) : mPhysicalDevice(pDevice), mLogicalDevice(lDevice) {
+	CreateBuffer(dSize, uFlags, request);
 }
 
 BufferWrapper::~BufferWrapper() {
 	vkDestroyBuffer(mLogicalDevice->GetLogicalDevice(), mBuffer, nullptr); std::cout << "Success: Buffer destroyed." << std::endl;
-	vkFreeMemory(mLogicalDevice->GetLogicalDevice(), mBufferMemory, nullptr); std::cout << "Success: Buffer Memory freed." << std::endl;
+	mLogicalDevice->GetMemoryAllocator()->Free(mBufferAllocation); std::cout << "Success: Buffer Memory freed." << std::endl;
 }
 
-void BufferWrapper::MapBufferMemory(void* iData, VkDeviceSize dSize) {
-	void* data;
-	vkMapMemory(mLogicalDevice->GetLogicalDevice(), mBufferMemory, 0, dSize, 0, &data);
-	memcpy(data, iData, static_cast<size_t>(dSize));
-	vkUnmapMemory(mLogicalDevice->GetLogicalDevice(), mBufferMemory);
+/*
+
+	The block this buffer lives in is already mapped by the allocator, so this is just a copy.
+
+*/
+void BufferWrapper::MapBufferMemory(const void* iData, VkDeviceSize dSize) {
+	if (mBufferAllocation.mMapped == nullptr) {
+		throw std::runtime_error("Attempted to map a Buffer that is not host visible!");
+	}
+	memcpy(mBufferAllocation.mMapped, iData, static_cast<size_t>(dSize));
 }
 
 VkBuffer BufferWrapper::GetBuffer() {
@@ -27,10 +35,26 @@ VkBuffer BufferWrapper::GetBuffer() {
 }
 
 VkDeviceMemory BufferWrapper::GetBufferMemory() {
-	return mBufferMemory;
+	return mBufferAllocation.mMemory;
+}
+
+VkDeviceSize BufferWrapper::GetBufferOffset() {
+	return mBufferAllocation.mOffset;
+}
+
+void* BufferWrapper::GetMappedData() {
+	return mBufferAllocation.mMapped;
+}
+
+uint32_t BufferWrapper::GetMemoryTypeIndex() {
+	return mBufferAllocation.mMemoryTypeIndex;
+}
+
+VkMemoryPropertyFlags BufferWrapper::GetMemoryPropertyFlags() {
+	return mPhysicalDevice->GetPhysicalDeviceMemoryProperties().memoryTypes[mBufferAllocation.mMemoryTypeIndex].propertyFlags;
 }
 
-void BufferWrapper::CreateBuffer(VkDeviceSize dSize, VkBufferUsageFlags uFlags, VkMemoryPropertyFlags pFlags) {
+void BufferWrapper::CreateBuffer(VkDeviceSize dSize, VkBufferUsageFlags uFlags, MemoryTypeRequest request) {
 	// Create Buffer struct
 	VkBufferCreateInfo bufferCI = {
 		VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,																								// sType
@@ -55,85 +79,14 @@ void BufferWrapper::CreateBuffer(VkDeviceSize dSize, VkBufferUsageFlags uFlags,
 	VkMemoryRequirements memoryRequirements;
 	vkGetBufferMemoryRequirements(mLogicalDevice->GetLogicalDevice(), mBuffer, &memoryRequirements);
 
-	// Allocate Memory for Buffer struct
-	VkMemoryAllocateInfo memoryAI = {
-		VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,																								// sType
-		nullptr,																															// pNext
-		memoryRequirements.size,																											// allocationSize
-		FindMemoryTypeIndex(mPhysicalDevice->GetPhysicalDevice(), memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)	// memoryTypeIndex
-	};
-
-	// Allocate Memory for Buffer
-	result = vkAllocateMemory(mLogicalDevice->GetLogicalDevice(), &memoryAI, nullptr, &mBufferMemory);
-	if (result == VK_SUCCESS) {
-		std::cout << "Success: Buffer Memory allocated!" << std::endl;
-	} else {
-		throw std::runtime_error("Failed to allocate Buffer Memory! Error Code: " + NT_CHECK_RESULT(result));
-	}
+	// Sub-allocate Memory for Buffer
+	uint32_t memoryTypeIndex = mPhysicalDevice->FindMemoryTypeIndex(memoryRequirements.memoryTypeBits, request);
+	mBufferAllocation = mLogicalDevice->GetMemoryAllocator()->Allocate(memoryRequirements, memoryTypeIndex, true);
+	std::cout << "Success: Buffer Memory allocated! (type " << memoryTypeIndex << ": " << NT_MEMORY_PROPERTY_STRING(GetMemoryPropertyFlags()) << ")" << std::endl;
 
 	// Bind Buffer Memory
-	vkBindBufferMemory(mLogicalDevice->GetLogicalDevice(), mBuffer, mBufferMemory, 0);
-}
-
-void CopyBuffer(LogicalDeviceWrapper* lDevice, CommandPoolWrapper* tCommandPool, BufferWrapper* srcBuffer, BufferWrapper* dstBuffer, VkDeviceSize bufferSize) {
-	// Create Transfer Command Buffer
-	CommandBufferWrapper* transferCommandBuffer = new CommandBufferWrapper(lDevice, tCommandPool);
-
-	// Begin Recording Transfer Command Buffer struct
-	VkCommandBufferBeginInfo commandBufferBI = {
-		VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,																						// sType
-		nullptr,																															// pNext
-		VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,																						// flags
-		nullptr																																// pInheritanceInfo
-	};
-
-	// Begin Recording Transfer Command Buffer
-	VkResult result = vkBeginCommandBuffer(transferCommandBuffer->GetCommandBuffer(), &commandBufferBI);
-	if (result != VK_SUCCESS) {
-		throw std::runtime_error("Failed to begin recording transfer command buffer! Error Code: " + NT_CHECK_RESULT(result));
-	}
-	
-		VkBufferCopy bufferCopy = {
-			0,																																// srcOffset
-			0,																																// dstOffset
-			bufferSize																														// size
-		};
-
-		vkCmdCopyBuffer(transferCommandBuffer->GetCommandBuffer(), srcBuffer->GetBuffer(), dstBuffer->GetBuffer(), 1, &bufferCopy);
-
-	result = vkEndCommandBuffer(transferCommandBuffer->GetCommandBuffer());
-	if (result != VK_SUCCESS) {
-		throw std::runtime_error("Failed to end recording transfer command buffer! Error Code: " + NT_CHECK_RESULT(result));
-	}
-
-	// Submit Transfer Command Buffer struct
-	VkCommandBuffer buffer = transferCommandBuffer->GetCommandBuffer();
-	VkSubmitInfo submitInfo = {
-		VK_STRUCTURE_TYPE_SUBMIT_INFO,																										// sType
-		nullptr,																															// pNext
-		0,																																	// waitSemaphoreCount
-		nullptr,																															// pWaitSemaphores
-		nullptr,																															// pWaitDstStageMask
-		1,																																	// commandBufferCount
-		&buffer,																															// pCommandBuffers
-		0,																																	// signalSemaphoreCount
-		nullptr																																// pSignalSemaphores
-	};
-
-	// Submit Transfer Command Buffer
-	result = vkQueueSubmit(lDevice->GetTransferQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+	result = vkBindBufferMemory(mLogicalDevice->GetLogicalDevice(), mBuffer, mBufferAllocation.mMemory, mBufferAllocation.mOffset);
 	if (result != VK_SUCCESS) {
-		throw std::runtime_error("Failed to submit copy command to queue! Error Code: " + NT_CHECK_RESULT(result));
+		throw std::runtime_error("Failed to bind Buffer Memory! Error Code: " + NT_CHECK_RESULT(result));
 	}
-
-	// Wait for Transfer Queue to finish
-	result = vkQueueWaitIdle(lDevice->GetTransferQueue());
-	if (result == VK_SUCCESS) {
-		std::cout << "Success: Data transferred." << std::endl;
-	} else {
-		throw std::runtime_error("Failed to wait for transfer queue! Error Code: " + NT_CHECK_RESULT(result));
-	}
-
-	// Free Transfer Command Buffer
-	vkFreeCommandBuffers(lDevice->GetLogicalDevice(), tCommandPool->GetCommandPool(), 1, &buffer);
 }
\ No newline at end of file
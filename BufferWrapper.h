@@ -3,36 +3,42 @@
 
 #include <iostream>
 #include <vulkan/vulkan.h>
+#include "MemoryAllocator.h"
 
 class PhysicalDeviceWrapper;
 class LogicalDeviceWrapper;
-class CommandPoolWrapper;
 class ImageWrapper;
+struct MemoryTypeRequest;
 
 /*
 
-	
+	BufferWrapper does not own a VkDeviceMemory anymore. Its memory is a sub-allocation of a
+	block owned by the MemoryAllocator, so the buffer has to be bound (and mapped) at mBufferAllocation.mOffset.
 
 */
 
 class BufferWrapper {
 public:
 	BufferWrapper(PhysicalDeviceWrapper*, LogicalDeviceWrapper*, VkDeviceSize, VkBufferUsageFlags, VkMemoryPropertyFlags);
+	BufferWrapper(PhysicalDeviceWrapper*, LogicalDeviceWrapper*, VkDeviceSize, VkBufferUsageFlags, MemoryTypeRequest);
 	~BufferWrapper();
 
-	void MapBufferMemory(void* data, VkDeviceSize dSize);
+	void MapBufferMemory(const void* data, VkDeviceSize dSize);
 
 	VkBuffer GetBuffer();
 	VkDeviceMemory GetBufferMemory();
+	VkDeviceSize GetBufferOffset();
+	void* GetMappedData();
+	uint32_t GetMemoryTypeIndex();
+	VkMemoryPropertyFlags GetMemoryPropertyFlags();
 private:
-	void CreateBuffer(VkDeviceSize, VkBufferUsageFlags, VkMemoryPropertyFlags);
+	void CreateBuffer(VkDeviceSize, VkBufferUsageFlags, MemoryTypeRequest);
 
 	VkBuffer mBuffer;
-	VkDeviceMemory mBufferMemory;
+	MemoryAllocation mBufferAllocation;
 
 	PhysicalDeviceWrapper* mPhysicalDevice;
 	LogicalDeviceWrapper* mLogicalDevice;
 };
 
-void CopyBuffer(LogicalDeviceWrapper*, CommandPoolWrapper*, BufferWrapper*, BufferWrapper*, VkDeviceSize);
 #endif
\ No newline at end of file
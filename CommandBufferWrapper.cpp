@@ -3,7 +3,11 @@
 #include "CommandPoolWrapper.h"
 
 CommandBufferWrapper::CommandBufferWrapper(LogicalDeviceWrapper* lDevice, CommandPoolWrapper* commandpool) : mLogicalDevice(lDevice), mCommandPool(commandpool) {
-	AllocateCommandBuffer();
+	AllocateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+}
+
+CommandBufferWrapper::CommandBufferWrapper(LogicalDeviceWrapper* lDevice, CommandPoolWrapper* commandpool, VkCommandBufferLevel level) : mLogicalDevice(lDevice), mCommandPool(commandpool) {
+	AllocateCommandBuffer(level);
 }
 
 CommandBufferWrapper::~CommandBufferWrapper() {
@@ -14,12 +18,12 @@ VkCommandBuffer CommandBufferWrapper::GetCommandBuffer() {
 	return mCommandBuffer;
 }
 
-void CommandBufferWrapper::AllocateCommandBuffer() {
+void CommandBufferWrapper::AllocateCommandBuffer(VkCommandBufferLevel level) {
 	VkCommandBufferAllocateInfo commandBufferAI = {
 		VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,			// sType
 		nullptr,												// pNext
 		mCommandPool->GetCommandPool(),							// commandPool
-		VK_COMMAND_BUFFER_LEVEL_PRIMARY,						// level
+		level,													// level
 		1														// commandBufferCount
 	};
 
@@ -15,11 +15,12 @@ class CommandPoolWrapper;
 class CommandBufferWrapper {
 public:
 	CommandBufferWrapper(LogicalDeviceWrapper*, CommandPoolWrapper*);
+	CommandBufferWrapper(LogicalDeviceWrapper*, CommandPoolWrapper*, VkCommandBufferLevel);
 	~CommandBufferWrapper();
 
 	VkCommandBuffer GetCommandBuffer();
 private:
-	void AllocateCommandBuffer();
+	void AllocateCommandBuffer(VkCommandBufferLevel);
 
 	VkCommandBuffer mCommandBuffer;
 
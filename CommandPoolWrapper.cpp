@@ -14,6 +14,18 @@ VkCommandPool CommandPoolWrapper::GetCommandPool() {
 	return mCommandPool;
 }
 
+/*
+
+	Resets every command buffer allocated from this pool in one go. None of them may still be pending.
+
+*/
+void CommandPoolWrapper::Reset() {
+	VkResult result = vkResetCommandPool(mLogicalDevice->GetLogicalDevice(), mCommandPool, 0);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to reset Command Pool! Error Code: " + NT_CHECK_RESULT(result));
+	}
+}
+
 void CommandPoolWrapper::CreateCommandPool(uint32_t index) {
 	VkCommandPoolCreateInfo poolCI = {
 		VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,			// sType
@@ -17,6 +17,8 @@ public:
 	~CommandPoolWrapper();
 
 	VkCommandPool GetCommandPool();
+
+	void Reset();
 private:
 	void CreateCommandPool(uint32_t);
 
@@ -0,0 +1,362 @@
+#include "ComputeContext.h"
+#include "globals.h"
+#include "PhysicalDeviceWrapper.h"
+#include "LogicalDeviceWrapper.h"
+#include "CommandPoolWrapper.h"
+#include "CommandBufferWrapper.h"
+#include "SynchronizationWrapper.h"
+#include "BufferWrapper.h"
+#include "ImageWrapper.h"
+#include "PipelineWrapper.h"
+#include "DescriptorSetWrapper.h"
+
+ComputeContext::ComputeContext(PhysicalDeviceWrapper* pDevice, LogicalDeviceWrapper* lDevice) : mRecordingBatch(nullptr), mPendingAcquireTicket(0), mLastTicket(0), mPhysicalDevice(pDevice), mLogicalDevice(lDevice) {
+	mPendingAcquire.mDstStages = 0;
+	mCommandPool = new CommandPoolWrapper(mLogicalDevice, mPhysicalDevice->GetQueueFamilyIndices().mCompute);
+	std::cout << "Success: Compute Context created." << std::endl;
+}
+
+ComputeContext::~ComputeContext() {
+	Flush();
+
+	for (size_t i = 0; i < mFreeBatches.size(); i++) {
+		delete mFreeBatches.at(i)->mCommandBuffer;
+		delete mFreeBatches.at(i);
+	}
+	delete mCommandPool;
+	std::cout << "Success: Compute Context destroyed." << std::endl;
+}
+
+void ComputeContext::Dispatch(PipelineWrapper* pipeline, std::vector<DescriptorSetWrapper*> descriptorSets, const void* pushConstants, uint32_t pushConstantSize, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
+	RecordDispatch(GetCommandBuffer(), pipeline, descriptorSets, pushConstants, pushConstantSize, groupCountX, groupCountY, groupCountZ);
+	mRecordingBatch->mDispatchCount++;
+}
+
+/*
+
+	Makes the compute writes to the buffer visible to the given graphics stages. Record it after the
+	dispatches that write the buffer, the graphics side is taken care of by RecordAcquires().
+
+*/
+void ComputeContext::ReleaseBufferToGraphics(BufferWrapper* buffer, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess) {
+	VkCommandBuffer commandBuffer = GetCommandBuffer();
+	BarrierScope src = { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_QUEUE_FAMILY_IGNORED };
+
+	if (!HasOwnFamily()) {
+		RecordBufferBarrier(commandBuffer, buffer, src, { dstStages, dstAccess, VK_QUEUE_FAMILY_IGNORED });
+		return;
+	}
+
+	QueueFamilyIndices indices = mPhysicalDevice->GetQueueFamilyIndices();
+	src.mQueueFamily = (uint32_t)indices.mCompute;
+	RecordBufferBarrier(commandBuffer, buffer, src, { VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, (uint32_t)indices.mGraphics });
+
+	mRecordingBatch->mAcquire.mBufferBarriers.push_back({
+		.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+		.pNext = nullptr,
+		.srcAccessMask = 0,
+		.dstAccessMask = dstAccess,
+		.srcQueueFamilyIndex = (uint32_t)indices.mCompute,
+		.dstQueueFamilyIndex = (uint32_t)indices.mGraphics,
+		.buffer = buffer->GetBuffer(),
+		.offset = 0,
+		.size = VK_WHOLE_SIZE
+	});
+	mRecordingBatch->mAcquire.mDstStages |= dstStages;
+}
+
+/*
+
+	Same as ReleaseBufferToGraphics(), and moves the image from oldLayout to newLayout on the way. Both
+	halves of an ownership transfer have to do the same transition.
+
+*/
+void ComputeContext::ReleaseImageToGraphics(ImageWrapper* image, VkImageLayout oldLayout, VkImageLayout newLayout, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess) {
+	VkCommandBuffer commandBuffer = GetCommandBuffer();
+	BarrierScope src = { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_QUEUE_FAMILY_IGNORED };
+
+	if (!HasOwnFamily()) {
+		RecordImageBarrier(commandBuffer, image, oldLayout, newLayout, src, { dstStages, dstAccess, VK_QUEUE_FAMILY_IGNORED });
+		return;
+	}
+
+	QueueFamilyIndices indices = mPhysicalDevice->GetQueueFamilyIndices();
+	src.mQueueFamily = (uint32_t)indices.mCompute;
+	RecordImageBarrier(commandBuffer, image, oldLayout, newLayout, src, { VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, (uint32_t)indices.mGraphics });
+
+	mRecordingBatch->mAcquire.mImageBarriers.push_back({
+		.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+		.pNext = nullptr,
+		.srcAccessMask = 0,
+		.dstAccessMask = dstAccess,
+		.oldLayout = oldLayout,
+		.newLayout = newLayout,
+		.srcQueueFamilyIndex = (uint32_t)indices.mCompute,
+		.dstQueueFamilyIndex = (uint32_t)indices.mGraphics,
+		.image = image->GetImage(),
+		.subresourceRange = {
+			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+			.baseMipLevel = 0,
+			.levelCount = image->GetMipLevels(),
+			.baseArrayLayer = 0,
+			.layerCount = 1
+		}
+	});
+	mRecordingBatch->mAcquire.mDstStages |= dstStages;
+}
+
+/*
+
+	Records the acquire half of every ownership transfer submitted since the last call into a graphics
+	command buffer. Returns the compute ticket that command buffer's submission has to wait on and
+	writes the stages the wait has to block to waitStages. Returns 0 (and no stages) if there is nothing to wait for.
+
+*/
+ComputeTicket ComputeContext::RecordAcquires(VkCommandBuffer commandBuffer, VkPipelineStageFlags* waitStages) {
+	*waitStages = 0;
+	if (mPendingAcquireTicket == 0) {
+		return 0;
+	}
+
+	// The semaphore wait blocks dstStages, so the acquire starts from there too
+	vkCmdPipelineBarrier(
+		commandBuffer,
+		mPendingAcquire.mDstStages,
+		mPendingAcquire.mDstStages,
+		0,
+		0,
+		nullptr,
+		(uint32_t)mPendingAcquire.mBufferBarriers.size(),
+		mPendingAcquire.mBufferBarriers.data(),
+		(uint32_t)mPendingAcquire.mImageBarriers.size(),
+		mPendingAcquire.mImageBarriers.data()
+	);
+
+	ComputeTicket ticket = mPendingAcquireTicket;
+	*waitStages = mPendingAcquire.mDstStages;
+
+	mPendingAcquire.mBufferBarriers.clear();
+	mPendingAcquire.mImageBarriers.clear();
+	mPendingAcquire.mDstStages = 0;
+	mPendingAcquireTicket = 0;
+
+	return ticket;
+}
+
+/*
+
+	Returns the command buffer of the batch being recorded, starting a new batch if there is none. Use it
+	to record anything the dispatches need around them (barriers between dependent dispatches, clears).
+
+*/
+VkCommandBuffer ComputeContext::GetCommandBuffer() {
+	if (mRecordingBatch == nullptr) {
+		BeginBatch();
+	}
+	return mRecordingBatch->mCommandBuffer->GetCommandBuffer();
+}
+
+/*
+
+	Submits the batch being recorded to the compute queue and returns its ticket. If nothing was recorded
+	the ticket of the last submitted batch is returned instead (0 if nothing was ever submitted).
+
+*/
+ComputeTicket ComputeContext::Submit() {
+	if (mRecordingBatch == nullptr) {
+		return mLastTicket;
+	}
+
+	VkCommandBuffer commandBuffer = mRecordingBatch->mCommandBuffer->GetCommandBuffer();
+
+	VkResult result = vkEndCommandBuffer(commandBuffer);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to end recording compute command buffer! Error Code: " + NT_CHECK_RESULT(result));
+	}
+
+	TimelineSemaphoreWrapper* timeline = mLogicalDevice->GetComputeTimeline();
+	VkSemaphore timelineSemaphore = timeline->GetSemaphore();
+	uint64_t ticket = timeline->NextValue();
+
+	VkTimelineSemaphoreSubmitInfo timelineSI = {
+		.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+		.pNext = nullptr,
+		.waitSemaphoreValueCount = 0,
+		.pWaitSemaphoreValues = nullptr,
+		.signalSemaphoreValueCount = 1,
+		.pSignalSemaphoreValues = &ticket
+	};
+	VkSubmitInfo submitInfo = {
+		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.pNext = &timelineSI,
+		.waitSemaphoreCount = 0,
+		.pWaitSemaphores = nullptr,
+		.pWaitDstStageMask = nullptr,
+		.commandBufferCount = 1,
+		.pCommandBuffers = &commandBuffer,
+		.signalSemaphoreCount = 1,
+		.pSignalSemaphores = &timelineSemaphore
+	};
+
+	result = vkQueueSubmit(mLogicalDevice->GetComputeQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to submit compute batch to queue! Error Code: " + NT_CHECK_RESULT(result));
+	}
+
+	mRecordingBatch->mTicket = ticket;
+	mLastTicket = ticket;
+
+	ComputeAcquire& acquire = mRecordingBatch->mAcquire;
+	if (acquire.mDstStages != 0) {
+		mPendingAcquire.mBufferBarriers.insert(mPendingAcquire.mBufferBarriers.end(), acquire.mBufferBarriers.begin(), acquire.mBufferBarriers.end());
+		mPendingAcquire.mImageBarriers.insert(mPendingAcquire.mImageBarriers.end(), acquire.mImageBarriers.begin(), acquire.mImageBarriers.end());
+		mPendingAcquire.mDstStages |= acquire.mDstStages;
+		mPendingAcquireTicket = ticket;
+	}
+
+	mInFlightBatches.push_back(mRecordingBatch);
+	mRecordingBatch = nullptr;
+
+	return ticket;
+}
+
+bool ComputeContext::IsComplete(ComputeTicket ticket) {
+	RetireBatches();
+	return mLogicalDevice->GetComputeTimeline()->IsComplete(ticket);
+}
+
+void ComputeContext::Wait(ComputeTicket ticket) {
+	if (ticket > mLastTicket) {
+		throw std::runtime_error("Attempted to wait on a compute ticket that was never submitted!");
+	}
+
+	mLogicalDevice->GetComputeTimeline()->Wait(ticket);
+
+	RetireBatches();
+}
+
+void ComputeContext::Flush() {
+	Wait(Submit());
+}
+
+void ComputeContext::BeginBatch() {
+	RetireBatches();
+
+	if (mFreeBatches.empty()) {
+		ComputeBatch* batch = new ComputeBatch();
+		batch->mCommandBuffer = new CommandBufferWrapper(mLogicalDevice, mCommandPool);
+		mFreeBatches.push_back(batch);
+	}
+
+	mRecordingBatch = mFreeBatches.back();
+	mFreeBatches.pop_back();
+
+	mRecordingBatch->mTicket = 0;
+	mRecordingBatch->mDispatchCount = 0;
+	mRecordingBatch->mAcquire.mBufferBarriers.clear();
+	mRecordingBatch->mAcquire.mImageBarriers.clear();
+	mRecordingBatch->mAcquire.mDstStages = 0;
+
+	VkCommandBufferBeginInfo commandBufferBI = {
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.pNext = nullptr,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+		.pInheritanceInfo = nullptr
+	};
+
+	VkResult result = vkBeginCommandBuffer(mRecordingBatch->mCommandBuffer->GetCommandBuffer(), &commandBufferBI);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to begin recording compute command buffer! Error Code: " + NT_CHECK_RESULT(result));
+	}
+}
+
+void ComputeContext::RetireBatches() {
+	uint64_t completed = mLogicalDevice->GetComputeTimeline()->GetCompletedValue();
+
+	for (size_t i = 0; i < mInFlightBatches.size(); ) {
+		if (mInFlightBatches.at(i)->mTicket > completed) {
+			i++;
+			continue;
+		}
+		mFreeBatches.push_back(mInFlightBatches.at(i));
+		mInFlightBatches.erase(mInFlightBatches.begin() + i);
+	}
+}
+
+bool ComputeContext::HasOwnFamily() {
+	QueueFamilyIndices indices = mPhysicalDevice->GetQueueFamilyIndices();
+	return indices.mCompute != indices.mGraphics;
+}
+
+/*
+
+	Binds the compute pipeline and its descriptor sets (starting at set 0), pushes the constants if there
+	are any and dispatches. Works on any command buffer whose queue supports compute.
+
+*/
+void RecordDispatch(VkCommandBuffer commandBuffer, PipelineWrapper* pipeline, std::vector<DescriptorSetWrapper*> descriptorSets, const void* pushConstants, uint32_t pushConstantSize, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
+	if (pipeline->GetBindPoint() != VK_PIPELINE_BIND_POINT_COMPUTE) {
+		throw std::runtime_error("Failed to record dispatch! The pipeline isn't a compute pipeline.");
+	}
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->GetPipeline());
+
+	if (!descriptorSets.empty()) {
+		std::vector<VkDescriptorSet> sets(descriptorSets.size());
+		for (size_t i = 0; i < descriptorSets.size(); i++) {
+			sets.at(i) = descriptorSets.at(i)->GetDescriptorSet();
+		}
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->GetPipelineLayout(), 0, (uint32_t)sets.size(), sets.data(), 0, nullptr);
+	}
+
+	if (pushConstantSize > 0) {
+		vkCmdPushConstants(commandBuffer, pipeline->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, pushConstantSize, pushConstants);
+	}
+
+	vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
+}
+
+void RecordBufferBarrier(VkCommandBuffer commandBuffer, BufferWrapper* buffer, BarrierScope src, BarrierScope dst) {
+	VkBufferMemoryBarrier bufferMemoryBarrier = {
+		.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+		.pNext = nullptr,
+		.srcAccessMask = src.mAccess,
+		.dstAccessMask = dst.mAccess,
+		.srcQueueFamilyIndex = src.mQueueFamily,
+		.dstQueueFamilyIndex = dst.mQueueFamily,
+		.buffer = buffer->GetBuffer(),
+		.offset = 0,
+		.size = VK_WHOLE_SIZE
+	};
+
+	vkCmdPipelineBarrier(commandBuffer, src.mStages, dst.mStages, 0, 0, nullptr, 1, &bufferMemoryBarrier, 0, nullptr);
+}
+
+/*
+
+	Unlike RecordTransitionImageLayout() the caller says exactly what to wait for, so this covers any
+	layout pair, including GENERAL -> GENERAL between dispatches. Covers every mip level.
+
+*/
+void RecordImageBarrier(VkCommandBuffer commandBuffer, ImageWrapper* image, VkImageLayout oldLayout, VkImageLayout newLayout, BarrierScope src, BarrierScope dst) {
+	VkImageMemoryBarrier imageMemoryBarrier = {
+		.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+		.pNext = nullptr,
+		.srcAccessMask = src.mAccess,
+		.dstAccessMask = dst.mAccess,
+		.oldLayout = oldLayout,
+		.newLayout = newLayout,
+		.srcQueueFamilyIndex = src.mQueueFamily,
+		.dstQueueFamilyIndex = dst.mQueueFamily,
+		.image = image->GetImage(),
+		.subresourceRange = {
+			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+			.baseMipLevel = 0,
+			.levelCount = image->GetMipLevels(),
+			.baseArrayLayer = 0,
+			.layerCount = 1
+		}
+	};
+
+	vkCmdPipelineBarrier(commandBuffer, src.mStages, dst.mStages, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+}
@@ -0,0 +1,100 @@
+#ifndef COMPUTE_CONTEXT_H
+#define COMPUTE_CONTEXT_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+
+class PhysicalDeviceWrapper;
+class LogicalDeviceWrapper;
+class CommandPoolWrapper;
+class CommandBufferWrapper;
+class BufferWrapper;
+class ImageWrapper;
+class PipelineWrapper;
+class DescriptorSetWrapper;
+
+/*
+
+	ComputeContext batches async compute work. Dispatch() records into the current batch's command buffer
+	and nothing is sent to the GPU until Submit(), which goes to the compute queue and hands back a
+	ticket (the compute timeline value the batch signals) that works like an UploadTicket.
+
+	Notes:
+		- Resources the graphics queue reads afterwards have to be handed over with ReleaseBufferToGraphics()
+		  / ReleaseImageToGraphics() after the dispatches that write them. When compute has a queue family
+		  of its own (EXCLUSIVE sharing) that is a queue family ownership transfer: the release is recorded
+		  here and the matching acquire is queued up until the renderer calls RecordAcquires() from the
+		  next frame's command buffer, which also tells it which compute ticket to wait on.
+		- When compute and graphics share the queue, the release is a plain barrier and submission order
+		  does the rest, so RecordAcquires() has nothing to record and returns 0.
+		- Only the compute -> graphics direction is handled. Whatever a batch reads has to be written by
+		  compute in the first place (or be fine with undefined contents), since nothing hands resources
+		  from graphics back to the compute family.
+		- Work that feeds back into itself every frame (ping-pong buffers, simulations that read what
+		  graphics wrote) is simpler to record inline on the graphics command buffer with the RecordXxx()
+		  helpers below, which don't care what queue the command buffer goes to.
+		- Command buffers are recycled once the compute timeline passes their batch, same as uploads.
+
+*/
+
+typedef uint64_t ComputeTicket;
+
+struct BarrierScope {
+	VkPipelineStageFlags mStages;
+	VkAccessFlags mAccess;
+	uint32_t mQueueFamily;							// VK_QUEUE_FAMILY_IGNORED unless ownership changes
+};
+
+struct ComputeAcquire {
+	std::vector<VkBufferMemoryBarrier> mBufferBarriers;
+	std::vector<VkImageMemoryBarrier> mImageBarriers;
+	VkPipelineStageFlags mDstStages;
+};
+
+struct ComputeBatch {
+	ComputeTicket mTicket;
+	CommandBufferWrapper* mCommandBuffer;
+	ComputeAcquire mAcquire;
+	uint32_t mDispatchCount;
+};
+
+class ComputeContext {
+public:
+	ComputeContext(PhysicalDeviceWrapper*, LogicalDeviceWrapper*);
+	~ComputeContext();
+
+	void Dispatch(PipelineWrapper*, std::vector<DescriptorSetWrapper*>, const void*, uint32_t, uint32_t, uint32_t, uint32_t);
+	void ReleaseBufferToGraphics(BufferWrapper*, VkPipelineStageFlags, VkAccessFlags);
+	void ReleaseImageToGraphics(ImageWrapper*, VkImageLayout, VkImageLayout, VkPipelineStageFlags, VkAccessFlags);
+	ComputeTicket RecordAcquires(VkCommandBuffer, VkPipelineStageFlags*);
+
+	VkCommandBuffer GetCommandBuffer();
+
+	ComputeTicket Submit();
+	bool IsComplete(ComputeTicket);
+	void Wait(ComputeTicket);
+	void Flush();
+private:
+	void BeginBatch();
+	void RetireBatches();
+	bool HasOwnFamily();
+
+	CommandPoolWrapper* mCommandPool;
+
+	ComputeBatch* mRecordingBatch;
+	std::vector<ComputeBatch*> mInFlightBatches;
+	std::vector<ComputeBatch*> mFreeBatches;
+
+	ComputeAcquire mPendingAcquire;				// Acquires of submitted batches not yet recorded by graphics
+	ComputeTicket mPendingAcquireTicket;
+
+	ComputeTicket mLastTicket;
+
+	PhysicalDeviceWrapper* mPhysicalDevice;
+	LogicalDeviceWrapper* mLogicalDevice;
+};
+
+void RecordDispatch(VkCommandBuffer, PipelineWrapper*, std::vector<DescriptorSetWrapper*>, const void*, uint32_t, uint32_t, uint32_t, uint32_t);
+void RecordBufferBarrier(VkCommandBuffer, BufferWrapper*, BarrierScope, BarrierScope);
+void RecordImageBarrier(VkCommandBuffer, ImageWrapper*, VkImageLayout, VkImageLayout, BarrierScope, BarrierScope);
+#endif
@@ -0,0 +1,382 @@
+#include "CookedModel.h"
+#include "globals.h"
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <assimp/Importer.hpp>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char COOKED_MODEL_MAGIC[4] = { 'N', 'T', 'M', 'D' };
+
+static uint64_t AlignOffset(uint64_t offset) {
+	return (offset + 15) & ~15ull;
+}
+
+static uint64_t HashBytes(uint64_t hash, const void* data, size_t size) {
+	const uint8_t* bytes = (const uint8_t*)data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+MappedFile::MappedFile(std::string filename) : mData(nullptr), mSize(0) {
+#ifdef _WIN32
+	mMapping = nullptr;
+	mFile = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (mFile == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(mFile, &size) || size.QuadPart == 0) {
+		return;
+	}
+	mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mMapping == nullptr) {
+		return;
+	}
+	mData = (const uint8_t*)MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+	mSize = mData != nullptr ? (size_t)size.QuadPart : 0;
+#else
+	mFile = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+	if (mFile < 0) {
+		return;
+	}
+	struct stat info;
+	if (fstat(mFile, &info) != 0 || info.st_size == 0) {
+		return;
+	}
+	void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, mFile, 0);
+	if (data == MAP_FAILED) {
+		return;
+	}
+	mData = (const uint8_t*)data;
+	mSize = (size_t)info.st_size;
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+	if (mData != nullptr) {
+		UnmapViewOfFile(mData);
+	}
+	if (mMapping != nullptr) {
+		CloseHandle(mMapping);
+	}
+	if (mFile != INVALID_HANDLE_VALUE) {
+		CloseHandle(mFile);
+	}
+#else
+	if (mData != nullptr) {
+		munmap((void*)mData, mSize);
+	}
+	if (mFile >= 0) {
+		close(mFile);
+	}
+#endif
+}
+
+const uint8_t* MappedFile::GetData() {
+	return mData;
+}
+
+size_t MappedFile::GetSize() {
+	return mSize;
+}
+
+CookedModel::CookedModel(std::string filename) : mHeader(nullptr) {
+	mFile = new MappedFile(filename);
+	if (Validate()) {
+		mHeader = (const CookedModelHeader*)mFile->GetData();
+	}
+}
+
+CookedModel::~CookedModel() {
+	delete mFile;
+}
+
+bool CookedModel::IsValid() {
+	return mHeader != nullptr;
+}
+
+uint64_t CookedModel::GetSourceHash() {
+	return mHeader->mSourceHash;
+}
+
+const Vertex* CookedModel::GetVertices() {
+	return (const Vertex*)(mFile->GetData() + mHeader->mVertexOffset);
+}
+
+uint32_t CookedModel::GetVertexCount() {
+	return mHeader->mVertexCount;
+}
+
+const uint32_t* CookedModel::GetIndices() {
+	return (const uint32_t*)(mFile->GetData() + mHeader->mIndexOffset);
+}
+
+uint32_t CookedModel::GetIndexCount() {
+	return mHeader->mIndexCount;
+}
+
+std::vector<Submesh> CookedModel::GetSubmeshes() {
+	const CookedSubmesh* cooked = (const CookedSubmesh*)(mFile->GetData() + mHeader->mSubmeshOffset);
+
+	std::vector<Submesh> submeshes;
+	submeshes.reserve(mHeader->mSubmeshCount);
+	for (uint32_t i = 0; i < mHeader->mSubmeshCount; i++) {
+		submeshes.push_back({
+			.mFirstIndex = cooked[i].mFirstIndex,
+			.mIndexCount = cooked[i].mIndexCount,
+			.mVertexOffset = cooked[i].mVertexOffset,
+			.mVertexCount = cooked[i].mVertexCount,
+			.mBoundsMin = glm::vec3(cooked[i].mBoundsMin[0], cooked[i].mBoundsMin[1], cooked[i].mBoundsMin[2]),
+			.mBoundsMax = glm::vec3(cooked[i].mBoundsMax[0], cooked[i].mBoundsMax[1], cooked[i].mBoundsMax[2]),
+			.mMaterialIndex = cooked[i].mMaterialIndex,
+			.mTexID = -1
+		});
+	}
+	return submeshes;
+}
+
+std::vector<ModelMaterial> CookedModel::GetMaterials() {
+	const CookedMaterial* cooked = (const CookedMaterial*)(mFile->GetData() + mHeader->mMaterialOffset);
+	const char* strings = (const char*)(mFile->GetData() + mHeader->mStringOffset);
+
+	std::vector<ModelMaterial> materials;
+	for (uint32_t i = 0; i < mHeader->mMaterialCount; i++) {
+		materials.push_back({
+			.mName = std::string(strings + cooked[i].mNameOffset, cooked[i].mNameLength),
+			.mDiffuseColor = glm::vec3(cooked[i].mDiffuseColor[0], cooked[i].mDiffuseColor[1], cooked[i].mDiffuseColor[2]),
+			.mDiffuseTexture = std::string(strings + cooked[i].mTextureOffset, cooked[i].mTextureLength)
+		});
+	}
+	return materials;
+}
+
+/*
+
+	Checks everything the accessors and the draws rely on: table ranges, submesh ranges, material and
+	string references, and every index against its submesh's vertex count. A damaged file is rejected
+	here instead of being read, or drawn, out of bounds.
+
+*/
+bool CookedModel::Validate() {
+	if (mFile->GetData() == nullptr || mFile->GetSize() < sizeof(CookedModelHeader)) {
+		return false;
+	}
+
+	const CookedModelHeader* header = (const CookedModelHeader*)mFile->GetData();
+	if (memcmp(header->mMagic, COOKED_MODEL_MAGIC, sizeof(COOKED_MODEL_MAGIC)) != 0 || header->mVersion != COOKED_MODEL_VERSION || header->mVertexStride != sizeof(Vertex)) {
+		return false;
+	}
+	if (!IsInFile(header->mVertexOffset, header->mVertexCount, sizeof(Vertex)) || !IsInFile(header->mIndexOffset, header->mIndexCount, sizeof(uint32_t)) ||
+		!IsInFile(header->mSubmeshOffset, header->mSubmeshCount, sizeof(CookedSubmesh)) || !IsInFile(header->mMaterialOffset, header->mMaterialCount, sizeof(CookedMaterial)) ||
+		!IsInFile(header->mStringOffset, header->mStringSize, 1)) {
+		return false;
+	}
+	if (header->mSubmeshCount == 0) {
+		return false;
+	}
+
+	const CookedSubmesh* submeshes = (const CookedSubmesh*)(mFile->GetData() + header->mSubmeshOffset);
+	const uint32_t* indices = (const uint32_t*)(mFile->GetData() + header->mIndexOffset);
+	for (uint32_t i = 0; i < header->mSubmeshCount; i++) {
+		const CookedSubmesh& submesh = submeshes[i];
+		bool indicesInRange = (uint64_t)submesh.mFirstIndex + submesh.mIndexCount <= header->mIndexCount;
+		bool verticesInRange = submesh.mVertexOffset >= 0 && (uint64_t)submesh.mVertexOffset + submesh.mVertexCount <= header->mVertexCount;
+		bool materialInRange = submesh.mMaterialIndex >= -1 && submesh.mMaterialIndex < (int32_t)header->mMaterialCount;
+		if (!indicesInRange || !verticesInRange || !materialInRange) {
+			return false;
+		}
+
+		// Out of range indices would reach vkCmdDrawIndexed, which is undefined without robustBufferAccess
+		for (uint32_t j = submesh.mFirstIndex; j < submesh.mFirstIndex + submesh.mIndexCount; j++) {
+			if (indices[j] >= submesh.mVertexCount) {
+				return false;
+			}
+		}
+	}
+
+	const CookedMaterial* materials = (const CookedMaterial*)(mFile->GetData() + header->mMaterialOffset);
+	for (uint32_t i = 0; i < header->mMaterialCount; i++) {
+		if ((uint64_t)materials[i].mNameOffset + materials[i].mNameLength > header->mStringSize || (uint64_t)materials[i].mTextureOffset + materials[i].mTextureLength > header->mStringSize) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool CookedModel::IsInFile(uint64_t offset, uint64_t count, size_t elementSize) {
+	return offset % 16 == 0 && offset <= mFile->GetSize() && count * elementSize <= mFile->GetSize() - offset;
+}
+
+std::string GetCookedModelPath(const std::string& source) {
+	return source + COOKED_MODEL_EXTENSION;
+}
+
+/*
+
+	Hash of everything a cooked model is built from. For OBJ files that includes the material libraries,
+	found by scanning for mtllib lines and resolved relative to the model, same as the importer does.
+
+*/
+uint64_t HashModelSource(const std::string& source) {
+	uint64_t hash = 14695981039346656037ull;
+	hash = HashBytes(hash, &COOKED_MODEL_VERSION, sizeof(COOKED_MODEL_VERSION));
+
+	MappedFile file(source);
+	if (file.GetData() == nullptr) {
+		throw std::runtime_error("Failed to hash model " + source + "! The file can't be read.");
+	}
+	hash = HashBytes(hash, file.GetData(), file.GetSize());
+
+	std::filesystem::path path(source);
+	if (path.extension() != ".obj" && path.extension() != ".OBJ") {
+		return hash;
+	}
+
+	std::string text((const char*)file.GetData(), file.GetSize());
+	size_t lineStart = 0;
+	while (lineStart < text.size()) {
+		size_t lineEnd = text.find('\n', lineStart);
+		if (lineEnd == std::string::npos) {
+			lineEnd = text.size();
+		}
+
+		if (text.compare(lineStart, 7, "mtllib ") == 0) {
+			std::string library = text.substr(lineStart + 7, lineEnd - lineStart - 7);
+			library.erase(library.find_last_not_of(" \t\r") + 1);
+
+			MappedFile libraryFile((path.parent_path() / library).string());
+			hash = HashBytes(hash, library.data(), library.size());
+			if (libraryFile.GetData() != nullptr) {
+				hash = HashBytes(hash, libraryFile.GetData(), libraryFile.GetSize());
+			}
+		}
+		lineStart = lineEnd + 1;
+	}
+	return hash;
+}
+
+/*
+
+	Imports source with Assimp and writes the result to cooked. The file is assembled in memory and written
+	to a temporary first, so an interrupted cook never leaves a half written file behind that looks valid.
+
+*/
+void CookModel(const std::string& source, const std::string& cooked) {
+	uint64_t sourceHash = HashModelSource(source);
+	ModelData model = ImportModel(source);
+
+	std::vector<CookedSubmesh> submeshes;
+	for (size_t i = 0; i < model.mSubmeshes.size(); i++) {
+		const Submesh& submesh = model.mSubmeshes.at(i);
+		submeshes.push_back({
+			.mFirstIndex = submesh.mFirstIndex,
+			.mIndexCount = submesh.mIndexCount,
+			.mVertexOffset = submesh.mVertexOffset,
+			.mVertexCount = submesh.mVertexCount,
+			.mBoundsMin = { submesh.mBoundsMin.x, submesh.mBoundsMin.y, submesh.mBoundsMin.z },
+			.mBoundsMax = { submesh.mBoundsMax.x, submesh.mBoundsMax.y, submesh.mBoundsMax.z },
+			.mMaterialIndex = submesh.mMaterialIndex
+		});
+	}
+
+	std::string strings;
+	std::vector<CookedMaterial> materials;
+	for (size_t i = 0; i < model.mMaterials.size(); i++) {
+		const ModelMaterial& material = model.mMaterials.at(i);
+		CookedMaterial cookedMaterial = {
+			.mDiffuseColor = { material.mDiffuseColor.r, material.mDiffuseColor.g, material.mDiffuseColor.b },
+			.mNameOffset = (uint32_t)strings.size(),
+			.mNameLength = (uint32_t)material.mName.size(),
+			.mTextureOffset = (uint32_t)(strings.size() + material.mName.size()),
+			.mTextureLength = (uint32_t)material.mDiffuseTexture.size()
+		};
+		strings += material.mName + material.mDiffuseTexture;
+		materials.push_back(cookedMaterial);
+	}
+
+	CookedModelHeader header = { };
+	memcpy(header.mMagic, COOKED_MODEL_MAGIC, sizeof(COOKED_MODEL_MAGIC));
+	header.mVersion = COOKED_MODEL_VERSION;
+	header.mSourceHash = sourceHash;
+	header.mVertexStride = sizeof(Vertex);
+	header.mVertexCount = (uint32_t)model.mVertices.size();
+	header.mIndexCount = (uint32_t)model.mIndices.size();
+	header.mSubmeshCount = (uint32_t)submeshes.size();
+	header.mMaterialCount = (uint32_t)materials.size();
+	header.mStringSize = (uint32_t)strings.size();
+	header.mVertexOffset = AlignOffset(sizeof(CookedModelHeader));
+	header.mIndexOffset = AlignOffset(header.mVertexOffset + sizeof(Vertex) * model.mVertices.size());
+	header.mSubmeshOffset = AlignOffset(header.mIndexOffset + sizeof(uint32_t) * model.mIndices.size());
+	header.mMaterialOffset = AlignOffset(header.mSubmeshOffset + sizeof(CookedSubmesh) * submeshes.size());
+	header.mStringOffset = AlignOffset(header.mMaterialOffset + sizeof(CookedMaterial) * materials.size());
+	memcpy(header.mBoundsMin, &model.mBoundsMin, sizeof(header.mBoundsMin));
+	memcpy(header.mBoundsMax, &model.mBoundsMax, sizeof(header.mBoundsMax));
+
+	std::vector<char> data(header.mStringOffset + strings.size(), 0);
+	memcpy(data.data(), &header, sizeof(header));
+	memcpy(data.data() + header.mVertexOffset, model.mVertices.data(), sizeof(Vertex) * model.mVertices.size());
+	memcpy(data.data() + header.mIndexOffset, model.mIndices.data(), sizeof(uint32_t) * model.mIndices.size());
+	memcpy(data.data() + header.mSubmeshOffset, submeshes.data(), sizeof(CookedSubmesh) * submeshes.size());
+	memcpy(data.data() + header.mMaterialOffset, materials.data(), sizeof(CookedMaterial) * materials.size());
+	memcpy(data.data() + header.mStringOffset, strings.data(), strings.size());
+
+	std::string temporary = cooked + ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		file.write(data.data(), data.size());
+		if (!file) {
+			throw std::runtime_error("Failed to write cooked model " + temporary + "!");
+		}
+	}
+	std::filesystem::rename(temporary, cooked);
+
+	std::cout << "Success: Model " << source << " cooked to " << cooked << " (" << data.size() << " bytes)." << std::endl;
+}
+
+// Scoped so the mapping is closed before the file gets replaced, Windows won't rename over a mapped file
+static bool IsCookedModelCurrent(const std::string& source, const std::string& cookedPath) {
+	CookedModel cooked(cookedPath);
+	return cooked.IsValid() && cooked.GetSourceHash() == HashModelSource(source);
+}
+
+/*
+
+	Cooks every model in directory whose cooked file is missing, invalid or stale. Returns how many were cooked.
+
+*/
+uint32_t CookModelDirectory(const std::string& directory) {
+	Assimp::Importer importer;
+
+	uint32_t cookedCount = 0;
+	for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+		std::string extension = entry.path().extension().string();
+		if (!entry.is_regular_file() || extension == COOKED_MODEL_EXTENSION || !importer.IsExtensionSupported(extension)) {
+			continue;
+		}
+
+		std::string source = entry.path().string();
+		std::string cookedPath = GetCookedModelPath(source);
+		if (IsCookedModelCurrent(source, cookedPath)) {
+			continue;
+		}
+
+		CookModel(source, cookedPath);
+		cookedCount++;
+	}
+	return cookedCount;
+}
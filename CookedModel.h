@@ -0,0 +1,120 @@
+#ifndef COOKED_MODEL_H
+#define COOKED_MODEL_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "Mesh.h"
+#include "ModelImporter.h"
+
+// Every offset is from the start of the file and 16 byte aligned, every count is in elements
+struct CookedModelHeader {
+	char mMagic[4];										// "NTMD"
+	uint32_t mVersion;									// COOKED_MODEL_VERSION
+	uint64_t mSourceHash;								// HashModelSource() of what was cooked
+	uint32_t mVertexStride;								// sizeof(Vertex), so a changed Vertex makes old files invalid
+	uint32_t mVertexCount;
+	uint32_t mIndexCount;
+	uint32_t mSubmeshCount;
+	uint32_t mMaterialCount;
+	uint32_t mStringSize;
+	uint64_t mVertexOffset;
+	uint64_t mIndexOffset;
+	uint64_t mSubmeshOffset;
+	uint64_t mMaterialOffset;
+	uint64_t mStringOffset;
+	float mBoundsMin[3];
+	float mBoundsMax[3];
+};
+
+struct CookedSubmesh {
+	uint32_t mFirstIndex;
+	uint32_t mIndexCount;
+	int32_t mVertexOffset;
+	uint32_t mVertexCount;
+	float mBoundsMin[3];
+	float mBoundsMax[3];
+	int32_t mMaterialIndex;
+};
+
+// Names and texture paths live in the string table, not null terminated
+struct CookedMaterial {
+	float mDiffuseColor[3];
+	uint32_t mNameOffset;
+	uint32_t mNameLength;
+	uint32_t mTextureOffset;
+	uint32_t mTextureLength;
+};
+
+/*
+
+	MappedFile maps a whole file read only. CreateFileMapping / MapViewOfFile on Windows, mmap elsewhere.
+	A file that doesn't exist or can't be mapped leaves GetData() at nullptr instead of throwing, since
+	callers fall back to something else anyway.
+
+*/
+
+class MappedFile {
+public:
+	MappedFile(std::string);
+	~MappedFile();
+
+	const uint8_t* GetData();
+	size_t GetSize();
+private:
+	const uint8_t* mData;
+	size_t mSize;
+
+#ifdef _WIN32
+	void* mFile;
+	void* mMapping;
+#else
+	int mFile;
+#endif
+};
+
+/*
+
+	CookedModel is a model file run through ImportModel() ahead of time and written out in the layout the
+	renderer uploads. Loading one is mapping the file and checking the header: the vertex and index blobs
+	are already Vertex / uint32_t arrays and get copied into staging memory straight from the mapping.
+
+	Notes:
+		- CookModel() writes X.ntmodel for a source X, CookModelDirectory() does it for every model in a
+		  directory whose cooked file is missing or stale (run with --cook).
+		- The header carries the source hash. HashModelSource() covers the source file, for OBJ files the
+		  material libraries it names with mtllib, and COOKED_MODEL_VERSION. Texture images aren't part of
+		  it, they are loaded at runtime by path.
+		- IsValid() is false for files that are missing, truncated, have the wrong magic, version or vertex
+		  stride, whose tables point outside the file, or with an index past its submesh's vertices.
+		  Renderer::LoadModel() falls back to Assimp then, and also when the source hash doesn't match.
+		- The accessors point into the mapping, they are only valid while the CookedModel is alive.
+
+*/
+
+class CookedModel {
+public:
+	CookedModel(std::string);
+	~CookedModel();
+
+	bool IsValid();
+	uint64_t GetSourceHash();
+	const Vertex* GetVertices();
+	uint32_t GetVertexCount();
+	const uint32_t* GetIndices();
+	uint32_t GetIndexCount();
+	std::vector<Submesh> GetSubmeshes();
+	std::vector<ModelMaterial> GetMaterials();
+private:
+	bool Validate();
+	bool IsInFile(uint64_t, uint64_t, size_t);
+
+	MappedFile* mFile;
+	const CookedModelHeader* mHeader;					// nullptr unless the file is valid
+};
+
+std::string GetCookedModelPath(const std::string&);
+uint64_t HashModelSource(const std::string&);
+void CookModel(const std::string&, const std::string&);
+uint32_t CookModelDirectory(const std::string&);
+#endif
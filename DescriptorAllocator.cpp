@@ -0,0 +1,207 @@
+#include "DescriptorAllocator.h"
+#include "globals.h"
+#include <algorithm>
+#include "LogicalDeviceWrapper.h"
+#include "DescriptorSetWrapper.h"
+
+/*
+
+	descriptorsPerSet is a starting guess of how many descriptors of each type a set needs, it may be
+	empty. initialSets is the size of the first pool.
+
+*/
+DescriptorAllocator::DescriptorAllocator(LogicalDeviceWrapper* lDevice, std::vector<VkDescriptorPoolSize> descriptorsPerSet, uint32_t initialSets, bool transient) : mDescriptorsPerSet(descriptorsPerSet), mCurrentPool(0), mNextPoolSets(std::max(1u, initialSets)), mTransient(transient), mLogicalDevice(lDevice) {
+	mStats = { };
+	std::cout << "Success: Descriptor Allocator created." << std::endl;
+}
+
+DescriptorAllocator::~DescriptorAllocator() {
+	// Destroying a pool frees whatever sets are still in it
+	for (size_t i = 0; i < mPools.size(); i++) {
+		delete mPools.at(i);
+	}
+	std::cout << "Success: Descriptor Allocator destroyed." << std::endl;
+}
+
+/*
+
+	Allocates a set of the given layout from the first pool with room, chaining a new pool if none has any.
+	A pool that was sized for the layout and still can't fit it is full, so later calls start after it.
+	Pools that only lack one of the layout's descriptor types are skipped this time, other layouts may
+	still fit.
+
+*/
+VkDescriptorSet DescriptorAllocator::Allocate(DescriptorSetLayoutWrapper* layout) {
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+	VkResult result = VK_ERROR_OUT_OF_POOL_MEMORY;
+
+	size_t pool = mCurrentPool;
+	for (; pool < mPools.size(); pool++) {
+		result = AllocateFromPool(pool, layout, &descriptorSet);
+		if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL) {
+			break;
+		}
+		if (pool == mCurrentPool && IsSizedFor(pool, layout)) {
+			mCurrentPool++;
+		}
+	}
+
+	if (pool == mPools.size()) {
+		CreatePool(layout);
+		result = AllocateFromPool(pool, layout, &descriptorSet);
+	}
+
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to allocate Descriptor Set! Error Code: " + NT_CHECK_RESULT(result));
+	}
+
+	if (!mTransient) {
+		mSetPools[descriptorSet] = pool;
+	}
+	mStats.mSetsAllocated++;
+	mStats.mLiveSets++;
+	return descriptorSet;
+}
+
+/*
+
+	Gives a set back to its pool. Sets of a transient allocator can't be freed on their own, they're all
+	dropped by the next Reset(), so this does nothing for them.
+
+*/
+void DescriptorAllocator::Free(VkDescriptorSet descriptorSet) {
+	if (mTransient) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto found = mSetPools.find(descriptorSet);
+	if (found == mSetPools.end()) {
+		throw std::runtime_error("Attempted to free a Descriptor Set that wasn't allocated by this allocator!");
+	}
+
+	VkResult result = vkFreeDescriptorSets(mLogicalDevice->GetLogicalDevice(), mPools.at(found->second)->GetDescriptorPool(), 1, &descriptorSet);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to free Descriptor Set! Error Code: " + NT_CHECK_RESULT(result));
+	}
+
+	// The pool has room again, look there first next time
+	mCurrentPool = std::min(mCurrentPool, found->second);
+	mSetPools.erase(found);
+	mStats.mSetsFreed++;
+	mStats.mLiveSets--;
+}
+
+/*
+
+	Drops every set of a transient allocator at once. The pools are kept and filled again from the first.
+
+*/
+void DescriptorAllocator::Reset() {
+	if (!mTransient) {
+		throw std::runtime_error("Attempted to reset a persistent Descriptor Allocator!");
+	}
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for (size_t i = 0; i < mPools.size(); i++) {
+		mPools.at(i)->Reset();
+	}
+	mCurrentPool = 0;
+	mStats.mResets++;
+	mStats.mLiveSets = 0;
+}
+
+bool DescriptorAllocator::IsTransient() {
+	return mTransient;
+}
+
+DescriptorAllocatorStats DescriptorAllocator::GetStats() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mStats;
+}
+
+void DescriptorAllocator::PrintStats() {
+	DescriptorAllocatorStats stats = GetStats();
+
+	std::cout << "Descriptor Allocator Stats (" << (mTransient ? "transient" : "persistent") << "):" << std::endl;
+	std::cout << "\tPools: " << stats.mPoolsCreated << " (" << stats.mSetCapacity << " sets)" << std::endl;
+	std::cout << "\tLive Sets: " << stats.mLiveSets << std::endl;
+	std::cout << "\tSets Allocated: " << stats.mSetsAllocated << ", Freed: " << stats.mSetsFreed << ", Resets: " << stats.mResets << std::endl;
+}
+
+/*
+
+	Chains a pool big enough for mNextPoolSets sets, after growing the per set counts to cover the layout.
+
+*/
+void DescriptorAllocator::CreatePool(DescriptorSetLayoutWrapper* layout) {
+	std::vector<VkDescriptorPoolSize> needed = layout->GetPoolSizes(1);
+	for (size_t i = 0; i < needed.size(); i++) {
+		bool found = false;
+		for (size_t j = 0; j < mDescriptorsPerSet.size(); j++) {
+			if (mDescriptorsPerSet.at(j).type == needed.at(i).type) {
+				mDescriptorsPerSet.at(j).descriptorCount = std::max(mDescriptorsPerSet.at(j).descriptorCount, needed.at(i).descriptorCount);
+				found = true;
+			}
+		}
+		if (!found) {
+			mDescriptorsPerSet.push_back(needed.at(i));
+		}
+	}
+
+	std::vector<VkDescriptorPoolSize> poolSizes;
+	for (size_t i = 0; i < mDescriptorsPerSet.size(); i++) {
+		if (mDescriptorsPerSet.at(i).descriptorCount > 0) {
+			poolSizes.push_back({ mDescriptorsPerSet.at(i).type, mDescriptorsPerSet.at(i).descriptorCount * mNextPoolSets });
+		}
+	}
+	if (poolSizes.empty()) {
+		// A layout without bindings still takes up a set, but a pool needs at least one pool size
+		poolSizes.push_back({ VK_DESCRIPTOR_TYPE_SAMPLER, 1 });
+	}
+
+	VkDescriptorPoolCreateFlags flags = mTransient ? 0 : VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+	mPools.push_back(new DescriptorPoolWrapper(mLogicalDevice, poolSizes, mNextPoolSets, flags));
+	mPoolDescriptorsPerSet.push_back(mDescriptorsPerSet);
+
+	mStats.mPoolsCreated++;
+	mStats.mSetCapacity += mNextPoolSets;
+	mNextPoolSets = std::min(mNextPoolSets * 2, DESCRIPTOR_POOL_MAX_SETS);
+}
+
+/*
+
+	Whether the pool was created with at least as many descriptors per set of every type as the layout uses.
+
+*/
+bool DescriptorAllocator::IsSizedFor(size_t pool, DescriptorSetLayoutWrapper* layout) {
+	std::vector<VkDescriptorPoolSize> needed = layout->GetPoolSizes(1);
+	const std::vector<VkDescriptorPoolSize>& sized = mPoolDescriptorsPerSet.at(pool);
+	for (size_t i = 0; i < needed.size(); i++) {
+		bool found = false;
+		for (size_t j = 0; j < sized.size() && !found; j++) {
+			found = sized.at(j).type == needed.at(i).type && sized.at(j).descriptorCount >= needed.at(i).descriptorCount;
+		}
+		if (!found) {
+			return false;
+		}
+	}
+	return true;
+}
+
+VkResult DescriptorAllocator::AllocateFromPool(size_t pool, DescriptorSetLayoutWrapper* layout, VkDescriptorSet* descriptorSet) {
+	VkDescriptorSetLayout setLayout = layout->GetDescriptorSetLayout();
+	VkDescriptorSetAllocateInfo descriptorSetAI = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.pNext = nullptr,
+		.descriptorPool = mPools.at(pool)->GetDescriptorPool(),
+		.descriptorSetCount = 1,
+		.pSetLayouts = &setLayout
+	};
+
+	return vkAllocateDescriptorSets(mLogicalDevice->GetLogicalDevice(), &descriptorSetAI, descriptorSet);
+}
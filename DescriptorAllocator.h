@@ -0,0 +1,75 @@
+#ifndef DESCRIPTOR_ALLOCATOR_H
+#define DESCRIPTOR_ALLOCATOR_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+
+class LogicalDeviceWrapper;
+class DescriptorSetLayoutWrapper;
+class DescriptorPoolWrapper;
+
+struct DescriptorAllocatorStats {
+	uint64_t mSetsAllocated;
+	uint64_t mSetsFreed;								// Freed one by one, sets dropped by Reset() aren't counted
+	uint64_t mResets;
+	uint32_t mPoolsCreated;
+	uint32_t mLiveSets;
+	uint32_t mSetCapacity;								// Sets every pool together can hold
+};
+
+/*
+
+	DescriptorAllocator hands out descriptor sets from a chain of pools. When the pools it has are full
+	it creates a bigger one instead of failing, so nothing has to know up front how many sets of which
+	layout will be needed.
+
+	Notes:
+		- A persistent allocator creates its pools with FREE_DESCRIPTOR_SET_BIT. Its sets are long-lived
+		  and given back one by one with Free(), which makes room in their pool again.
+		- A transient allocator's sets only live until Reset(), which resets every pool with one
+		  vkResetDescriptorPool each. FrameContext has one, reset in Begin() once the GPU is done with
+		  the frame. Its sets must only be used in commands recorded every frame, not in the cached
+		  secondaries.
+		- Pool sizes are descriptors per set times the pool's set count. The per set counts start out
+		  as given and grow to cover every layout that didn't fit, so a new pool is never too small
+		  for the layout that triggered it.
+		- Each new pool holds twice the sets of the last one, up to DESCRIPTOR_POOL_MAX_SETS.
+		- A pool only counts as full once a layout it was sized for doesn't fit anymore. One that merely
+		  lacks a descriptor type is still tried for the layouts that don't use it.
+		- DescriptorSetWrapper can allocate through one of these, its destructor calls Free().
+		- Thread safe.
+
+*/
+
+class DescriptorAllocator {
+public:
+	DescriptorAllocator(LogicalDeviceWrapper*, std::vector<VkDescriptorPoolSize>, uint32_t, bool);
+	~DescriptorAllocator();
+
+	VkDescriptorSet Allocate(DescriptorSetLayoutWrapper*);
+	void Free(VkDescriptorSet);
+	void Reset();
+
+	bool IsTransient();
+	DescriptorAllocatorStats GetStats();
+	void PrintStats();
+private:
+	void CreatePool(DescriptorSetLayoutWrapper*);
+	bool IsSizedFor(size_t, DescriptorSetLayoutWrapper*);
+	VkResult AllocateFromPool(size_t, DescriptorSetLayoutWrapper*, VkDescriptorSet*);
+
+	std::vector<DescriptorPoolWrapper*> mPools;
+	std::vector<VkDescriptorPoolSize> mDescriptorsPerSet;
+	std::vector<std::vector<VkDescriptorPoolSize>> mPoolDescriptorsPerSet;	// The per set counts each pool was created with
+	std::unordered_map<VkDescriptorSet, size_t> mSetPools;		// Pool index of every live set, persistent only
+	size_t mCurrentPool;										// Pools before it are full
+	uint32_t mNextPoolSets;
+	bool mTransient;
+	std::mutex mMutex;
+	DescriptorAllocatorStats mStats;
+
+	LogicalDeviceWrapper* mLogicalDevice;
+};
+#endif
@@ -0,0 +1,233 @@
+#include "DescriptorLayoutCache.h"
+#include "globals.h"
+#include <map>
+#include <algorithm>
+#include "ShaderWrapper.h"
+#include "ShaderReflection.h"
+#include "DescriptorSetWrapper.h"
+#include "PipelineLayoutWrapper.h"
+
+static size_t HashBytes(size_t hash, const void* data, size_t size) {
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+template <typename T>
+static size_t HashField(size_t hash, const T& field) {
+	return HashBytes(hash, &field, sizeof(T));
+}
+
+static bool SameBindings(DescriptorSetLayoutWrapper* layout, std::vector<VkDescriptorSetLayoutBinding> b, std::vector<VkDescriptorBindingFlags> bFlags) {
+	std::vector<VkDescriptorSetLayoutBinding> a = layout->GetBindings();
+	std::vector<VkDescriptorBindingFlags> aFlags = layout->GetBindingFlags();
+	if (a.size() != b.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < a.size(); i++) {
+		if (a.at(i).binding != b.at(i).binding || a.at(i).descriptorType != b.at(i).descriptorType || a.at(i).descriptorCount != b.at(i).descriptorCount || a.at(i).stageFlags != b.at(i).stageFlags || aFlags.at(i) != bFlags.at(i)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool SamePushConstantRanges(std::vector<VkPushConstantRange> a, std::vector<VkPushConstantRange> b) {
+	if (a.size() != b.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < a.size(); i++) {
+		if (a.at(i).stageFlags != b.at(i).stageFlags || a.at(i).offset != b.at(i).offset || a.at(i).size != b.at(i).size) {
+			return false;
+		}
+	}
+	return true;
+}
+
+DescriptorLayoutCache::DescriptorLayoutCache(LogicalDeviceWrapper* lDevice) : mLogicalDevice(lDevice) {
+	mStats = { };
+	std::cout << "Success: Descriptor Layout Cache created." << std::endl;
+}
+
+DescriptorLayoutCache::~DescriptorLayoutCache() {
+	// Pipeline layouts reference the set layouts
+	for (auto& bucket : mPipelineLayouts) {
+		for (size_t i = 0; i < bucket.second.size(); i++) {
+			delete bucket.second.at(i);
+		}
+	}
+	for (auto& bucket : mSetLayouts) {
+		for (size_t i = 0; i < bucket.second.size(); i++) {
+			delete bucket.second.at(i);
+		}
+	}
+	std::cout << "Success: Descriptor Layout Cache destroyed." << std::endl;
+}
+
+/*
+
+	Returns the set layout with exactly these bindings and binding flags (one per binding), creating it the
+	first time. Bindings are sorted first so the order they're listed in doesn't matter.
+
+*/
+DescriptorSetLayoutWrapper* DescriptorLayoutCache::GetDescriptorSetLayout(std::vector<VkDescriptorSetLayoutBinding> unsortedBindings, std::vector<VkDescriptorBindingFlags> unsortedFlags) {
+	std::vector<size_t> order(unsortedBindings.size());
+	for (size_t i = 0; i < order.size(); i++) {
+		order.at(i) = i;
+	}
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+		return unsortedBindings.at(a).binding < unsortedBindings.at(b).binding;
+	});
+
+	std::vector<VkDescriptorSetLayoutBinding> bindings;
+	std::vector<VkDescriptorBindingFlags> bindingFlags;
+	for (size_t i = 0; i < order.size(); i++) {
+		bindings.push_back(unsortedBindings.at(order.at(i)));
+		bindingFlags.push_back(unsortedFlags.at(order.at(i)));
+	}
+
+	size_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < bindings.size(); i++) {
+		hash = HashField(hash, bindings.at(i).binding);
+		hash = HashField(hash, bindings.at(i).descriptorType);
+		hash = HashField(hash, bindings.at(i).descriptorCount);
+		hash = HashField(hash, bindings.at(i).stageFlags);
+		hash = HashField(hash, bindingFlags.at(i));
+	}
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	mStats.mSetLayoutRequests++;
+
+	std::vector<DescriptorSetLayoutWrapper*>& bucket = mSetLayouts[hash];
+	for (size_t i = 0; i < bucket.size(); i++) {
+		if (SameBindings(bucket.at(i), bindings, bindingFlags)) {
+			return bucket.at(i);
+		}
+	}
+
+	DescriptorSetLayoutWrapper* layout = new DescriptorSetLayoutWrapper(mLogicalDevice, bindings, bindingFlags);
+	bucket.push_back(layout);
+	mStats.mSetLayoutsCreated++;
+	return layout;
+}
+
+/*
+
+	Returns the pipeline layout the given shader stages need together. Throws if two stages declare the
+	same binding differently.
+
+*/
+PipelineLayoutWrapper* DescriptorLayoutCache::GetPipelineLayout(std::vector<ShaderWrapper*> shaders) {
+	std::map<uint32_t, std::map<uint32_t, VkDescriptorSetLayoutBinding>> sets;
+	std::map<uint32_t, std::map<uint32_t, VkDescriptorBindingFlags>> setFlags;
+	VkPushConstantRange pushConstantRange = { 0, 0, 0 };
+
+	for (size_t i = 0; i < shaders.size(); i++) {
+		ShaderReflection* reflection = shaders.at(i)->GetReflection();
+		VkShaderStageFlagBits stage = reflection->GetStage();
+
+		std::vector<ReflectedBinding> reflectedBindings = reflection->GetBindings();
+		for (size_t j = 0; j < reflectedBindings.size(); j++) {
+			ReflectedBinding& reflected = reflectedBindings.at(j);
+
+			VkDescriptorType type = reflected.mType;
+			uint32_t count = reflected.mCount;
+			VkDescriptorBindingFlags flags = 0;
+			if (count == 0) {
+				if (type != VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE && type != VK_DESCRIPTOR_TYPE_SAMPLER && type != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) {
+					throw std::runtime_error("Failed to create pipeline layout! Only image and sampler arrays can be unbounded (set " + std::to_string(reflected.mSet) + ", binding " + std::to_string(reflected.mBinding) + ").");
+				}
+				count = type == VK_DESCRIPTOR_TYPE_SAMPLER ? BINDLESS_SAMPLER_CAPACITY : BINDLESS_TEXTURE_CAPACITY;
+				// UPDATE_UNUSED_WHILE_PENDING lets new slots be written while frames using the set are still in flight
+				flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+			}
+
+			if (type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER && stage != VK_SHADER_STAGE_COMPUTE_BIT && reflected.mSet < 32 && (DYNAMIC_UNIFORM_SET_MASK & (1u << reflected.mSet)) != 0) {
+				type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+			}
+
+			auto found = sets[reflected.mSet].find(reflected.mBinding);
+			if (found == sets[reflected.mSet].end()) {
+				sets[reflected.mSet][reflected.mBinding] = {
+					.binding = reflected.mBinding,
+					.descriptorType = type,
+					.descriptorCount = count,
+					.stageFlags = (VkShaderStageFlags)stage,
+					.pImmutableSamplers = nullptr
+				};
+				setFlags[reflected.mSet][reflected.mBinding] = flags;
+			} else if (found->second.descriptorType != type || found->second.descriptorCount != count || setFlags[reflected.mSet][reflected.mBinding] != flags) {
+				throw std::runtime_error("Failed to create pipeline layout! Stages disagree on set " + std::to_string(reflected.mSet) + ", binding " + std::to_string(reflected.mBinding) + ".");
+			} else {
+				found->second.stageFlags |= stage;
+			}
+		}
+
+		if (reflection->GetPushConstantSize() > 0) {
+			pushConstantRange.stageFlags |= stage;
+			pushConstantRange.size = std::max(pushConstantRange.size, reflection->GetPushConstantSize());
+		}
+	}
+
+	std::vector<DescriptorSetLayoutWrapper*> setLayouts;
+	uint32_t setCount = sets.empty() ? 0 : sets.rbegin()->first + 1;
+	for (uint32_t set = 0; set < setCount; set++) {
+		std::vector<VkDescriptorSetLayoutBinding> bindings;
+		std::vector<VkDescriptorBindingFlags> bindingFlags;
+		for (auto& binding : sets[set]) {
+			bindings.push_back(binding.second);
+			bindingFlags.push_back(setFlags[set][binding.first]);
+		}
+		setLayouts.push_back(GetDescriptorSetLayout(bindings, bindingFlags));
+	}
+
+	std::vector<VkPushConstantRange> pushConstantRanges;
+	if (pushConstantRange.size > 0) {
+		pushConstantRanges.push_back(pushConstantRange);
+	}
+	return GetPipelineLayout(setLayouts, pushConstantRanges);
+}
+
+DescriptorLayoutCacheStats DescriptorLayoutCache::GetStats() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mStats;
+}
+
+void DescriptorLayoutCache::PrintStats() {
+	DescriptorLayoutCacheStats stats = GetStats();
+	std::cout << "Descriptor Layout Cache: " << stats.mSetLayoutsCreated << " set layouts for " << stats.mSetLayoutRequests << " requests, " << stats.mPipelineLayoutsCreated << " pipeline layouts for " << stats.mPipelineLayoutRequests << " requests" << std::endl;
+}
+
+PipelineLayoutWrapper* DescriptorLayoutCache::GetPipelineLayout(std::vector<DescriptorSetLayoutWrapper*> setLayouts, std::vector<VkPushConstantRange> pushConstantRanges) {
+	size_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < setLayouts.size(); i++) {
+		hash = HashField(hash, setLayouts.at(i));
+	}
+	for (size_t i = 0; i < pushConstantRanges.size(); i++) {
+		hash = HashField(hash, pushConstantRanges.at(i).stageFlags);
+		hash = HashField(hash, pushConstantRanges.at(i).offset);
+		hash = HashField(hash, pushConstantRanges.at(i).size);
+	}
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	mStats.mPipelineLayoutRequests++;
+
+	std::vector<PipelineLayoutWrapper*>& bucket = mPipelineLayouts[hash];
+	for (size_t i = 0; i < bucket.size(); i++) {
+		bool same = bucket.at(i)->GetDescriptorSetLayoutCount() == setLayouts.size() && SamePushConstantRanges(bucket.at(i)->GetPushConstantRanges(), pushConstantRanges);
+		for (uint32_t set = 0; same && set < setLayouts.size(); set++) {
+			same = bucket.at(i)->GetDescriptorSetLayout(set) == setLayouts.at(set);
+		}
+		if (same) {
+			return bucket.at(i);
+		}
+	}
+
+	PipelineLayoutWrapper* layout = new PipelineLayoutWrapper(mLogicalDevice, setLayouts, pushConstantRanges);
+	bucket.push_back(layout);
+	mStats.mPipelineLayoutsCreated++;
+	return layout;
+}
@@ -0,0 +1,62 @@
+#ifndef DESCRIPTOR_LAYOUT_CACHE_H
+#define DESCRIPTOR_LAYOUT_CACHE_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+
+class LogicalDeviceWrapper;
+class ShaderWrapper;
+class DescriptorSetLayoutWrapper;
+class PipelineLayoutWrapper;
+
+struct DescriptorLayoutCacheStats {
+	uint64_t mSetLayoutRequests;
+	uint32_t mSetLayoutsCreated;
+	uint64_t mPipelineLayoutRequests;
+	uint32_t mPipelineLayoutsCreated;
+};
+
+/*
+
+	DescriptorLayoutCache builds descriptor set layouts and pipeline layouts from what shaders declare
+	and creates each distinct one only once.
+
+	Notes:
+		- GetPipelineLayout() merges the reflection of every stage: a binding used by several stages gets
+		  all their stage flags, push constants become one range covering the largest block. Sets a
+		  shader skips get an empty layout so set numbers stay what the shader says.
+		- Uniform buffers in the sets of DYNAMIC_UNIFORM_SET_MASK are created as UNIFORM_BUFFER_DYNAMIC.
+		  Compute shaders are left alone, the mask describes how the graphics passes bind per object data.
+		- Unbounded arrays (texture2D textures[]) are the bindless tables. They get BINDLESS_TEXTURE_CAPACITY
+		  descriptors (BINDLESS_SAMPLER_CAPACITY for samplers) and are PARTIALLY_BOUND | UPDATE_AFTER_BIND |
+		  UPDATE_UNUSED_WHILE_PENDING.
+		  Only image and sampler arrays can be unbounded, those are the descriptor indexing features we enable.
+		- Layouts are looked up by hash and compared on a hit, so a collision never hands out the wrong
+		  one. Since set layouts are unique, pipeline layouts compare set layout handles.
+		- Owns every layout it creates. Thread safe.
+
+*/
+
+class DescriptorLayoutCache {
+public:
+	DescriptorLayoutCache(LogicalDeviceWrapper*);
+	~DescriptorLayoutCache();
+
+	DescriptorSetLayoutWrapper* GetDescriptorSetLayout(std::vector<VkDescriptorSetLayoutBinding>, std::vector<VkDescriptorBindingFlags>);
+	PipelineLayoutWrapper* GetPipelineLayout(std::vector<ShaderWrapper*>);
+
+	DescriptorLayoutCacheStats GetStats();
+	void PrintStats();
+private:
+	PipelineLayoutWrapper* GetPipelineLayout(std::vector<DescriptorSetLayoutWrapper*>, std::vector<VkPushConstantRange>);
+
+	std::unordered_map<size_t, std::vector<DescriptorSetLayoutWrapper*>> mSetLayouts;
+	std::unordered_map<size_t, std::vector<PipelineLayoutWrapper*>> mPipelineLayouts;
+	std::mutex mMutex;
+	DescriptorLayoutCacheStats mStats;
+
+	LogicalDeviceWrapper* mLogicalDevice;
+};
+#endif
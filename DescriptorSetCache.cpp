@@ -0,0 +1,101 @@
+#include "DescriptorSetCache.h"
+#include "globals.h"
+#include "LogicalDeviceWrapper.h"
+#include "BufferWrapper.h"
+#include "ImageViewWrapper.h"
+#include "DescriptorAllocator.h"
+
+DescriptorSetCache::DescriptorSetCache(LogicalDeviceWrapper* lDevice, DescriptorAllocator* allocator) : mLogicalDevice(lDevice), mDescriptorAllocator(allocator) {
+	mStats = { };
+	std::cout << "Success: Descriptor Set Cache created." << std::endl;
+}
+
+DescriptorSetCache::~DescriptorSetCache() {
+	for (auto& bucket : mDescriptorSets) {
+		for (size_t i = 0; i < bucket.second.size(); i++) {
+			delete bucket.second.at(i).mDescriptorSet;
+		}
+	}
+	std::cout << "Success: Descriptor Set Cache destroyed." << std::endl;
+}
+
+/*
+
+	Returns the set bound to exactly these contents, creating and writing it the first time they're asked for.
+
+*/
+DescriptorSetWrapper* DescriptorSetCache::GetDescriptorSet(const DescriptorSetContents& contents) {
+	if (!contents.IsComplete()) {
+		throw std::runtime_error("Failed to get Descriptor Set! Not every descriptor has been set.");
+	}
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	mStats.mRequests++;
+
+	std::vector<DescriptorSetCacheEntry>& bucket = mDescriptorSets[contents.GetHash()];
+	for (size_t i = 0; i < bucket.size(); i++) {
+		if (bucket.at(i).mContents == contents) {
+			mStats.mHits++;
+			return bucket.at(i).mDescriptorSet;
+		}
+	}
+
+	DescriptorSetWrapper* descriptorSet = new DescriptorSetWrapper(mLogicalDevice, contents.GetLayout(), mDescriptorAllocator);
+	descriptorSet->Write(contents);
+	bucket.push_back({ contents, descriptorSet });
+
+	mStats.mSetsCreated++;
+	mStats.mDescriptorsWritten += contents.GetDescriptorCount();
+	mStats.mLiveSets++;
+	return descriptorSet;
+}
+
+void DescriptorSetCache::EvictBuffer(BufferWrapper* buffer) {
+	VkBuffer handle = buffer->GetBuffer();
+	Evict([handle](const DescriptorSetContents& contents) { return contents.UsesBuffer(handle); });
+}
+
+void DescriptorSetCache::EvictImageView(ImageViewWrapper* imageView) {
+	VkImageView handle = imageView->GetImageView();
+	Evict([handle](const DescriptorSetContents& contents) { return contents.UsesImageView(handle); });
+}
+
+DescriptorSetCacheStats DescriptorSetCache::GetStats() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mStats;
+}
+
+void DescriptorSetCache::PrintStats() {
+	DescriptorSetCacheStats stats = GetStats();
+	double hitRate = stats.mRequests > 0 ? 100.0 * stats.mHits / stats.mRequests : 0.0;
+
+	std::cout << "Descriptor Set Cache Stats:" << std::endl;
+	std::cout << "\tLive Sets: " << stats.mLiveSets << " (" << stats.mSetsCreated << " created, " << stats.mSetsEvicted << " evicted)" << std::endl;
+	std::cout << "\tRequests: " << stats.mRequests << ", Hits: " << stats.mHits << " (" << hitRate << "%)" << std::endl;
+	std::cout << "\tDescriptors Written: " << stats.mDescriptorsWritten << std::endl;
+}
+
+/*
+
+	Deletes every set whose contents match the predicate.
+
+*/
+template <typename Predicate>
+void DescriptorSetCache::Evict(Predicate uses) {
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for (auto it = mDescriptorSets.begin(); it != mDescriptorSets.end();) {
+		std::vector<DescriptorSetCacheEntry>& bucket = it->second;
+		for (size_t i = 0; i < bucket.size();) {
+			if (uses(bucket.at(i).mContents)) {
+				delete bucket.at(i).mDescriptorSet;
+				bucket.erase(bucket.begin() + i);
+				mStats.mSetsEvicted++;
+				mStats.mLiveSets--;
+			} else {
+				i++;
+			}
+		}
+		it = bucket.empty() ? mDescriptorSets.erase(it) : std::next(it);
+	}
+}
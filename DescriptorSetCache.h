@@ -0,0 +1,69 @@
+#ifndef DESCRIPTOR_SET_CACHE_H
+#define DESCRIPTOR_SET_CACHE_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include "DescriptorSetWrapper.h"
+
+class LogicalDeviceWrapper;
+class DescriptorAllocator;
+class BufferWrapper;
+class ImageViewWrapper;
+
+struct DescriptorSetCacheStats {
+	uint64_t mRequests;
+	uint64_t mHits;
+	uint64_t mSetsCreated;
+	uint64_t mDescriptorsWritten;
+	uint64_t mSetsEvicted;
+	uint32_t mLiveSets;
+};
+
+struct DescriptorSetCacheEntry {
+	DescriptorSetContents mContents;
+	DescriptorSetWrapper* mDescriptorSet;
+};
+
+/*
+
+	DescriptorSetCache shares descriptor sets between everything that binds the same resources. Sets are
+	looked up by the hash of their DescriptorSetContents (layout plus every bound buffer, view, sampler
+	and range), so two materials with the same textures and buffers end up with one set, written once.
+
+	Notes:
+		- A miss allocates the set from the DescriptorAllocator given to the constructor and writes it
+		  with the layout's update template. Sets are never rewritten after that, the contents are the key.
+		- The cache owns its sets. Don't delete them, and don't write to them, other users would see it.
+		- When a buffer or image view is destroyed, EvictBuffer() / EvictImageView() first, so a later
+		  resource with the same handle value can't hit a stale set. The caller has to make sure no frame
+		  in flight still uses the evicted sets.
+		- Only layouts with an update template (no binding flags) can be cached.
+		- Thread safe.
+
+*/
+
+class DescriptorSetCache {
+public:
+	DescriptorSetCache(LogicalDeviceWrapper*, DescriptorAllocator*);
+	~DescriptorSetCache();
+
+	DescriptorSetWrapper* GetDescriptorSet(const DescriptorSetContents&);
+	void EvictBuffer(BufferWrapper*);
+	void EvictImageView(ImageViewWrapper*);
+
+	DescriptorSetCacheStats GetStats();
+	void PrintStats();
+private:
+	template <typename Predicate>
+	void Evict(Predicate);
+
+	std::unordered_map<size_t, std::vector<DescriptorSetCacheEntry>> mDescriptorSets;		// Keyed by content hash
+	std::mutex mMutex;
+	DescriptorSetCacheStats mStats;
+
+	LogicalDeviceWrapper* mLogicalDevice;
+	DescriptorAllocator* mDescriptorAllocator;
+};
+#endif
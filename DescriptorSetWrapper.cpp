@@ -1,27 +1,27 @@
 #include "DescriptorSetWrapper.h"
 #include "globals.h"
+#include <cstring>
 #include "LogicalDeviceWrapper.h"
 #include "BufferWrapper.h"
 #include "ImageViewWrapper.h"
 #include "SamplerWrapper.h"
+#include "DescriptorAllocator.h"
 
-DescriptorSetLayoutWrapper::DescriptorSetLayoutWrapper(LogicalDeviceWrapper* lDevice, DESCRIPTOR_TYPE type) : mLogicalDeviceWrapper(lDevice) {
-	switch (type) {
-		case GENERIC:
-			CreateGenericDescriptorSetLayout();
-			break;
-		case DYNAMIC:
-			CreateDynamicDescriptorSetLayout();
-			break;
-		case TEXTURE:
-			CreateTextureDescriptorSetLayout();
-			break;
-		default:
-			throw std::runtime_error("Designated an incorrect DESCRIPTOR_TYPE value!");
+DescriptorSetLayoutWrapper::DescriptorSetLayoutWrapper(LogicalDeviceWrapper* lDevice, std::vector<VkDescriptorSetLayoutBinding> bindings) : mBindings(bindings), mBindingFlags(bindings.size(), 0), mLogicalDeviceWrapper(lDevice) {
+	CreateDescriptorSetLayout();
+}
+
+DescriptorSetLayoutWrapper::DescriptorSetLayoutWrapper(LogicalDeviceWrapper* lDevice, std::vector<VkDescriptorSetLayoutBinding> bindings, std::vector<VkDescriptorBindingFlags> bindingFlags) : mBindings(bindings), mBindingFlags(bindingFlags), mLogicalDeviceWrapper(lDevice) {
+	if (mBindingFlags.size() != mBindings.size()) {
+		throw std::runtime_error("Failed to create Descriptor Set Layout! Every binding needs binding flags.");
 	}
+	CreateDescriptorSetLayout();
 }
 
 DescriptorSetLayoutWrapper::~DescriptorSetLayoutWrapper() {
+	if (mUpdateTemplate != VK_NULL_HANDLE) {
+		vkDestroyDescriptorUpdateTemplate(mLogicalDeviceWrapper->GetLogicalDevice(), mUpdateTemplate, nullptr);
+	}
 	vkDestroyDescriptorSetLayout(mLogicalDeviceWrapper->GetLogicalDevice(), mDescriptorSetLayout, nullptr); std::cout << "Success: Descriptor Set Layout destroyed." << std::endl;
 }
 
@@ -29,173 +29,307 @@ VkDescriptorSetLayout DescriptorSetLayoutWrapper::GetDescriptorSetLayout() {
 	return mDescriptorSetLayout;
 }
 
+std::vector<VkDescriptorSetLayoutBinding> DescriptorSetLayoutWrapper::GetBindings() {
+	return mBindings;
+}
+
+std::vector<VkDescriptorBindingFlags> DescriptorSetLayoutWrapper::GetBindingFlags() {
+	return mBindingFlags;
+}
+
+VkDescriptorType DescriptorSetLayoutWrapper::GetDescriptorType(uint32_t binding) {
+	for (size_t i = 0; i < mBindings.size(); i++) {
+		if (mBindings.at(i).binding == binding) {
+			return mBindings.at(i).descriptorType;
+		}
+	}
+	throw std::runtime_error("Descriptor Set Layout has no binding " + std::to_string(binding) + "!");
+}
+
+uint32_t DescriptorSetLayoutWrapper::GetDescriptorCount(uint32_t binding) {
+	for (size_t i = 0; i < mBindings.size(); i++) {
+		if (mBindings.at(i).binding == binding) {
+			return mBindings.at(i).descriptorCount;
+		}
+	}
+	throw std::runtime_error("Descriptor Set Layout has no binding " + std::to_string(binding) + "!");
+}
+
 /*
 
-	Creates a simple DescriptorSetLayout that only has a uniform binding.
+	How many descriptors of each type a pool needs to hold setCount sets of this layout.
 
 */
-void DescriptorSetLayoutWrapper::CreateGenericDescriptorSetLayout() {
-	// MVP Binding Information
-	VkDescriptorSetLayoutBinding mvpLayoutBinding = {
-		0,																// binding
-		VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,								// descriptorType
-		1,																// descriptorCount
-		VK_SHADER_STAGE_VERTEX_BIT,										// stageFlags
-		nullptr															// pImmutableSamplers
-	};
-
-	// Create Descriptor Set Layout with given bindings
-	VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCI = {
-		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,			// sType
-		nullptr,														// pNext
-		0,																// flags
-		1,																// bindingCount
-		&mvpLayoutBinding												// pBindings
-	};
+std::vector<VkDescriptorPoolSize> DescriptorSetLayoutWrapper::GetPoolSizes(uint32_t setCount) {
+	std::vector<VkDescriptorPoolSize> poolSizes;
+	for (size_t i = 0; i < mBindings.size(); i++) {
+		bool found = false;
+		for (size_t j = 0; j < poolSizes.size(); j++) {
+			if (poolSizes.at(j).type == mBindings.at(i).descriptorType) {
+				poolSizes.at(j).descriptorCount += mBindings.at(i).descriptorCount * setCount;
+				found = true;
+			}
+		}
+		if (!found) {
+			poolSizes.push_back({ mBindings.at(i).descriptorType, mBindings.at(i).descriptorCount * setCount });
+		}
+	}
+	return poolSizes;
+}
 
-	VkResult result = vkCreateDescriptorSetLayout(mLogicalDeviceWrapper->GetLogicalDevice(), &descriptorSetLayoutCI, nullptr, &mDescriptorSetLayout);
-	if (result == VK_SUCCESS) {
-		std::cout << "Success: Generic Descriptor Set Layout created." << std::endl;
-	} else {
-		throw std::runtime_error("Failed to create Generic Descriptor Set Layout! Error Code: " + NT_CHECK_RESULT(result));
+VkDescriptorUpdateTemplate DescriptorSetLayoutWrapper::GetUpdateTemplate() {
+	if (mUpdateTemplate == VK_NULL_HANDLE) {
+		throw std::runtime_error("Descriptor Set Layout has no update template! Layouts with binding flags are written one descriptor at a time.");
 	}
+	return mUpdateTemplate;
 }
 
 /*
 
-	Creates a DescriptorSetLayout that has support for both a uniform binding and a dynamic uniform binding
+	Index of the given array element of a binding in the data the update template reads.
 
 */
-void DescriptorSetLayoutWrapper::CreateDynamicDescriptorSetLayout() {
-	// Uniform Descriptor Set Layout Binding
-	VkDescriptorSetLayoutBinding viewProjectionLayoutBinding = {
-		0,																// binding
-		VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,								// descriptorType
-		1,																// descriptorCount
-		VK_SHADER_STAGE_VERTEX_BIT,										// stageFlags
-		nullptr															// pImmutableSamplers
-	};
+uint32_t DescriptorSetLayoutWrapper::GetDescriptorIndex(uint32_t binding, uint32_t arrayElement) {
+	for (size_t i = 0; i < mBindings.size(); i++) {
+		if (mBindings.at(i).binding == binding) {
+			if (arrayElement >= mBindings.at(i).descriptorCount) {
+				throw std::runtime_error("Descriptor Set Layout binding " + std::to_string(binding) + " has no element " + std::to_string(arrayElement) + "!");
+			}
+			return mDescriptorIndices.at(i) + arrayElement;
+		}
+	}
+	throw std::runtime_error("Descriptor Set Layout has no binding " + std::to_string(binding) + "!");
+}
 
-	// Dynamic Uniform Descriptor Set Layout Binding
-	VkDescriptorSetLayoutBinding modelLayoutBinding = {
-		1,																// binding
-		VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,						// descriptorType
-		1,																// descriptorCount
-		VK_SHADER_STAGE_VERTEX_BIT,										// stageFlags
-		nullptr															// pImmutableSamplers
-	};
+uint32_t DescriptorSetLayoutWrapper::GetTotalDescriptorCount() {
+	return mTotalDescriptorCount;
+}
 
-	std::vector<VkDescriptorSetLayoutBinding> layoutBindings = { viewProjectionLayoutBinding, modelLayoutBinding };
+bool DescriptorSetLayoutWrapper::IsUpdateAfterBind() {
+	for (size_t i = 0; i < mBindingFlags.size(); i++) {
+		if (mBindingFlags.at(i) & VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void DescriptorSetLayoutWrapper::CreateDescriptorSetLayout() {
+	bool hasBindingFlags = false;
+	for (size_t i = 0; i < mBindingFlags.size(); i++) {
+		hasBindingFlags = hasBindingFlags || mBindingFlags.at(i) != 0;
+	}
 
+	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCI = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+		.pNext = nullptr,
+		.bindingCount = (uint32_t)mBindingFlags.size(),
+		.pBindingFlags = mBindingFlags.data()
+	};
 	VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCI = {
-		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,			// sType
-		nullptr,														// pNext
-		0,																// flags
-		(uint32_t)layoutBindings.size(),								// bindingCount
-		layoutBindings.data()											// pBindings
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		.pNext = hasBindingFlags ? &bindingFlagsCI : nullptr,
+		.flags = IsUpdateAfterBind() ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT : (VkDescriptorSetLayoutCreateFlags)0,
+		.bindingCount = (uint32_t)mBindings.size(),
+		.pBindings = mBindings.data()
 	};
 
 	VkResult result = vkCreateDescriptorSetLayout(mLogicalDeviceWrapper->GetLogicalDevice(), &descriptorSetLayoutCI, nullptr, &mDescriptorSetLayout);
 	if (result == VK_SUCCESS) {
-		std::cout << "Success: Dynamic Descriptor Set Layout created." << std::endl;
+		std::cout << "Success: Descriptor Set Layout created." << std::endl;
 	} else {
-		throw std::runtime_error("Failed to create Dynamic Descriptor Set Layout! Error Code: " + NT_CHECK_RESULT(result));
+		throw std::runtime_error("Failed to create Descriptor Set Layout! Error Code: " + NT_CHECK_RESULT(result));
+	}
+
+	mTotalDescriptorCount = 0;
+	for (size_t i = 0; i < mBindings.size(); i++) {
+		mDescriptorIndices.push_back(mTotalDescriptorCount);
+		mTotalDescriptorCount += mBindings.at(i).descriptorCount;
+	}
+
+	// Bindless arrays are huge and only ever written a slot at a time, a template would have to cover all of it
+	mUpdateTemplate = VK_NULL_HANDLE;
+	if (!hasBindingFlags && !mBindings.empty()) {
+		CreateUpdateTemplate();
 	}
 }
 
-void DescriptorSetLayoutWrapper::CreateTextureDescriptorSetLayout() {
-	// Texture Sampler Descriptor Set Layout Binding
-	VkDescriptorSetLayoutBinding textureSamplerLayoutBinding = {
-		.binding = 0,
-		.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-		.descriptorCount = 1,
-		.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
-		.pImmutableSamplers = nullptr
-	};
+/*
 
-	VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCI = {
-		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+	One template entry per binding. The data is a DescriptorInfo array with every binding's descriptors
+	back to back, in the order of mBindings.
+
+*/
+void DescriptorSetLayoutWrapper::CreateUpdateTemplate() {
+	std::vector<VkDescriptorUpdateTemplateEntry> entries;
+	for (size_t i = 0; i < mBindings.size(); i++) {
+		entries.push_back({
+			.dstBinding = mBindings.at(i).binding,
+			.dstArrayElement = 0,
+			.descriptorCount = mBindings.at(i).descriptorCount,
+			.descriptorType = mBindings.at(i).descriptorType,
+			.offset = mDescriptorIndices.at(i) * sizeof(DescriptorInfo),
+			.stride = sizeof(DescriptorInfo)
+		});
+	}
+
+	VkDescriptorUpdateTemplateCreateInfo updateTemplateCI = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO,
 		.pNext = nullptr,
 		.flags = 0,
-		.bindingCount = 1,
-		.pBindings = &textureSamplerLayoutBinding
+		.descriptorUpdateEntryCount = (uint32_t)entries.size(),
+		.pDescriptorUpdateEntries = entries.data(),
+		.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET,
+		.descriptorSetLayout = mDescriptorSetLayout,
+		.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,		// Only used for push descriptor templates
+		.pipelineLayout = VK_NULL_HANDLE,
+		.set = 0
 	};
 
-	VkResult result = vkCreateDescriptorSetLayout(mLogicalDeviceWrapper->GetLogicalDevice(), &descriptorSetLayoutCI, nullptr, &mDescriptorSetLayout);
-	if (result == VK_SUCCESS) {
-		std::cout << "Success: Texture Descriptor Set Layout created." << std::endl;
-	} else {
-		throw std::runtime_error("Failed to create Texture Descriptor Set! Error Code: " + NT_CHECK_RESULT(result));
+	VkResult result = vkCreateDescriptorUpdateTemplate(mLogicalDeviceWrapper->GetLogicalDevice(), &updateTemplateCI, nullptr, &mUpdateTemplate);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create Descriptor Update Template! Error Code: " + NT_CHECK_RESULT(result));
 	}
 }
 
-DescriptorPoolWrapper::DescriptorPoolWrapper(LogicalDeviceWrapper* lDevice, DESCRIPTOR_TYPE type) : mLogicalDevice(lDevice) {
-	switch (type) {
-	case GENERIC:
-		CreateGenericDescriptorPool();
-		break;
-	case DYNAMIC:
-		CreateDynamicDescriptorPool();
-		break;
-	case TEXTURE:
-		CreateTextureDescriptorPool();
-		break;
-	default:
-		throw std::runtime_error("Designated an incorrect DESCRIPTOR_TYPE value!");
+DescriptorSetContents::DescriptorSetContents(DescriptorSetLayoutWrapper* layout) : mDescriptorSetLayout(layout) {
+	uint32_t count = mDescriptorSetLayout->GetTotalDescriptorCount();
+
+	DescriptorInfo empty;
+	memset(&empty, 0, sizeof(DescriptorInfo));
+	mData.resize(count, empty);
+	mWritten.resize(count, false);
+
+	std::vector<VkDescriptorSetLayoutBinding> bindings = mDescriptorSetLayout->GetBindings();
+	for (size_t i = 0; i < bindings.size(); i++) {
+		mTypes.insert(mTypes.end(), bindings.at(i).descriptorCount, bindings.at(i).descriptorType);
 	}
 }
 
-DescriptorPoolWrapper::~DescriptorPoolWrapper() {
-	vkDestroyDescriptorPool(mLogicalDevice->GetLogicalDevice(), mDescriptorPool, nullptr); std::cout << "Success: Descriptor Pool destroyed." << std::endl;
+/*
+
+	Same meaning as DescriptorSetWrapper::WriteBuffer(), the buffer is bound from offset 0.
+
+*/
+void DescriptorSetContents::SetBuffer(uint32_t binding, BufferWrapper* buffer, VkDeviceSize range) {
+	DescriptorInfo& info = GetInfo(binding, 0);
+	info.mBuffer.buffer = buffer->GetBuffer();
+	info.mBuffer.offset = 0;
+	info.mBuffer.range = range;
 }
 
-VkDescriptorPool DescriptorPoolWrapper::GetDescriptorPool() {
-	return mDescriptorPool;
+void DescriptorSetContents::SetImage(uint32_t binding, ImageViewWrapper* imageView, SamplerWrapper* sampler) {
+	SetImage(binding, 0, imageView, sampler);
 }
 
-void DescriptorPoolWrapper::CreateGenericDescriptorPool() {
-	VkDescriptorPoolSize poolSize = {
-		VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,								// sType
-		SWAPCHAIN_IMAGE_COUNT											// descriptorCount
-	};
+void DescriptorSetContents::SetImage(uint32_t binding, uint32_t arrayElement, ImageViewWrapper* imageView, SamplerWrapper* sampler) {
+	DescriptorInfo& info = GetInfo(binding, arrayElement);
+	info.mImage.sampler = sampler != nullptr ? sampler->GetSampler() : VK_NULL_HANDLE;
+	info.mImage.imageView = imageView != nullptr ? imageView->GetImageView() : VK_NULL_HANDLE;
+	info.mImage.imageLayout = mDescriptorSetLayout->GetDescriptorType(binding) == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+}
 
-	VkDescriptorPoolCreateInfo descriptorPoolCI = {
-		VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,					// sType
-		nullptr,														// pNext
-		VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,				// flags
-		SWAPCHAIN_IMAGE_COUNT,											// maxSets
-		1,																// poolSizeCount
-		&poolSize														// pPoolSizes
-	};
+DescriptorSetLayoutWrapper* DescriptorSetContents::GetLayout() const {
+	return mDescriptorSetLayout;
+}
 
-	VkResult result = vkCreateDescriptorPool(mLogicalDevice->GetLogicalDevice(), &descriptorPoolCI, nullptr, &mDescriptorPool);
-	if (result == VK_SUCCESS) {
-		std::cout << "Success: Descriptor Pool created!" << std::endl;
-	} else {
-		throw std::runtime_error("Failed to create Descriptor Pool! Error Code: " + NT_CHECK_RESULT(result));
+const DescriptorInfo* DescriptorSetContents::GetData() const {
+	return mData.data();
+}
+
+uint32_t DescriptorSetContents::GetDescriptorCount() const {
+	return (uint32_t)mData.size();
+}
+
+size_t DescriptorSetContents::GetHash() const {
+	size_t hash = 14695981039346656037ull;
+	hash = (hash ^ (size_t)mDescriptorSetLayout) * 1099511628211ull;
+
+	const unsigned char* bytes = (const unsigned char*)mData.data();
+	for (size_t i = 0; i < mData.size() * sizeof(DescriptorInfo); i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
 	}
+	return hash;
 }
 
-void DescriptorPoolWrapper::CreateDynamicDescriptorPool() {
-	VkDescriptorPoolSize uniformPoolSize = {
-		VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,								// sType
-		SWAPCHAIN_IMAGE_COUNT											// descriptorCount
-	};
+bool DescriptorSetContents::IsComplete() const {
+	for (size_t i = 0; i < mWritten.size(); i++) {
+		if (!mWritten.at(i)) {
+			return false;
+		}
+	}
+	return true;
+}
 
-	VkDescriptorPoolSize dynamicPoolSize = {
-		VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,						// sType
-		SWAPCHAIN_IMAGE_COUNT											// descriptorCount
-	};
+bool DescriptorSetContents::UsesBuffer(VkBuffer buffer) const {
+	for (size_t i = 0; i < mData.size(); i++) {
+		bool isBuffer = mTypes.at(i) == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER || mTypes.at(i) == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER || mTypes.at(i) == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC || mTypes.at(i) == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+		if (isBuffer && mData.at(i).mBuffer.buffer == buffer) {
+			return true;
+		}
+	}
+	return false;
+}
 
-	std::vector<VkDescriptorPoolSize> poolSizes = { uniformPoolSize, dynamicPoolSize };
+bool DescriptorSetContents::UsesImageView(VkImageView imageView) const {
+	for (size_t i = 0; i < mData.size(); i++) {
+		bool isImage = mTypes.at(i) == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER || mTypes.at(i) == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE || mTypes.at(i) == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE || mTypes.at(i) == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+		if (isImage && mData.at(i).mImage.imageView == imageView) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool DescriptorSetContents::operator==(const DescriptorSetContents& other) const {
+	return mDescriptorSetLayout == other.mDescriptorSetLayout && mData.size() == other.mData.size() && memcmp(mData.data(), other.mData.data(), mData.size() * sizeof(DescriptorInfo)) == 0;
+}
+
+DescriptorInfo& DescriptorSetContents::GetInfo(uint32_t binding, uint32_t arrayElement) {
+	uint32_t index = mDescriptorSetLayout->GetDescriptorIndex(binding, arrayElement);
+	mWritten.at(index) = true;
+	return mData.at(index);
+}
 
+DescriptorPoolWrapper::DescriptorPoolWrapper(LogicalDeviceWrapper* lDevice, std::vector<VkDescriptorPoolSize> poolSizes, uint32_t maxSets) : mLogicalDevice(lDevice) {
+	CreateDescriptorPool(poolSizes, maxSets, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
+}
+
+/*
+
+	Sets allocated from the pool are freed individually when their DescriptorSetWrapper is deleted, so
+	flags should include FREE_DESCRIPTOR_SET_BIT unless the sets are never deleted on their own.
+
+*/
+DescriptorPoolWrapper::DescriptorPoolWrapper(LogicalDeviceWrapper* lDevice, std::vector<VkDescriptorPoolSize> poolSizes, uint32_t maxSets, VkDescriptorPoolCreateFlags flags) : mLogicalDevice(lDevice) {
+	CreateDescriptorPool(poolSizes, maxSets, flags);
+}
+
+DescriptorPoolWrapper::~DescriptorPoolWrapper() {
+	vkDestroyDescriptorPool(mLogicalDevice->GetLogicalDevice(), mDescriptorPool, nullptr); std::cout << "Success: Descriptor Pool destroyed." << std::endl;
+}
+
+VkDescriptorPool DescriptorPoolWrapper::GetDescriptorPool() {
+	return mDescriptorPool;
+}
+
+// Returns every set allocated from the pool to it at once
+void DescriptorPoolWrapper::Reset() {
+	VkResult result = vkResetDescriptorPool(mLogicalDevice->GetLogicalDevice(), mDescriptorPool, 0);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to reset Descriptor Pool! Error Code: " + NT_CHECK_RESULT(result));
+	}
+}
+
+void DescriptorPoolWrapper::CreateDescriptorPool(std::vector<VkDescriptorPoolSize> poolSizes, uint32_t maxSets, VkDescriptorPoolCreateFlags flags) {
 	VkDescriptorPoolCreateInfo descriptorPoolCI = {
-		VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,					// sType
-		nullptr,														// pNext
-		VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,				// flags
-		SWAPCHAIN_IMAGE_COUNT,											// maxSets
-		(uint32_t)poolSizes.size(),										// poolSizeCount
-		poolSizes.data()												// pPoolSizes
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.pNext = nullptr,
+		.flags = flags,
+		.maxSets = maxSets,
+		.poolSizeCount = (uint32_t)poolSizes.size(),
+		.pPoolSizes = poolSizes.data()
 	};
 
 	VkResult result = vkCreateDescriptorPool(mLogicalDevice->GetLogicalDevice(), &descriptorPoolCI, nullptr, &mDescriptorPool);
@@ -206,129 +340,79 @@ void DescriptorPoolWrapper::CreateDynamicDescriptorPool() {
 	}
 }
 
-void DescriptorPoolWrapper::CreateTextureDescriptorPool() {
-	VkDescriptorPoolSize texturePoolSize = {
-		.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-		.descriptorCount = MAX_OBJECTS
-	};
+DescriptorSetWrapper::DescriptorSetWrapper(LogicalDeviceWrapper* lDevice , DescriptorSetLayoutWrapper* layout, DescriptorPoolWrapper* pool) : mLogicalDevice(lDevice), mDescriptorSetLayout(layout), mDescriptorPool(pool), mDescriptorAllocator(nullptr) {
+	CreateDescriptorSet();
+}
 
-	VkDescriptorPoolCreateInfo texturePoolCI = {
-		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-		.pNext = nullptr,
-		.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
-		.maxSets = MAX_OBJECTS,
-		.poolSizeCount = 1,
-		.pPoolSizes = &texturePoolSize
-	};
+DescriptorSetWrapper::DescriptorSetWrapper(LogicalDeviceWrapper* lDevice, DescriptorSetLayoutWrapper* layout, DescriptorAllocator* allocator) : mLogicalDevice(lDevice), mDescriptorSetLayout(layout), mDescriptorPool(nullptr), mDescriptorAllocator(allocator) {
+	mDescriptorSet = mDescriptorAllocator->Allocate(mDescriptorSetLayout);
+}
 
-	VkResult result = vkCreateDescriptorPool(mLogicalDevice->GetLogicalDevice(), &texturePoolCI, nullptr, &mDescriptorPool);
-	if (result == VK_SUCCESS) {
-		std::cout << "Success: Texture Descriptor Pool created!" << std::endl;
+DescriptorSetWrapper::~DescriptorSetWrapper() {
+	if (mDescriptorAllocator != nullptr) {
+		mDescriptorAllocator->Free(mDescriptorSet);
 	} else {
-		throw std::runtime_error("Failed to create Texture Descriptor Pool! Error Code: " + NT_CHECK_RESULT(result));
+		vkFreeDescriptorSets(mLogicalDevice->GetLogicalDevice(), mDescriptorPool->GetDescriptorPool(), 1, &mDescriptorSet); std::cout << "Success: Descriptor Set freed." << std::endl;
 	}
 }
 
-DescriptorSetWrapper::DescriptorSetWrapper(LogicalDeviceWrapper* lDevice , DescriptorSetLayoutWrapper* layout, DescriptorPoolWrapper* pool, DESCRIPTOR_TYPE type) : mLogicalDevice(lDevice), mDescriptorSetLayout(layout), mDescriptorPool(pool) {
-	switch (type) {
-		case GENERIC:
-			CreateGenericDescriptorSet();
-			break;
-		case DYNAMIC:
-			CreateDynamicDescriptorSet();
-			break;
-		case TEXTURE:
-			CreateTextureDescriptorSet();
-			break;
-	}
-}
+/*
 
-DescriptorSetWrapper::~DescriptorSetWrapper() {
-	vkFreeDescriptorSets(mLogicalDevice->GetLogicalDevice(), mDescriptorPool->GetDescriptorPool(), 1, &mDescriptorSet); std::cout << "Success: Descriptor Set freed." << std::endl;
-}
+	Points a buffer binding at the start of the buffer. For dynamic bindings the range should only cover
+	a single element, the actual location is picked every bind through the dynamic offsets.
 
-void DescriptorSetWrapper::WriteGenericDescriptorSet(BufferWrapper* buffer) {
-	VkDescriptorBufferInfo descriptorBI = {
-		buffer->GetBuffer(),											// buffer
-		0,																// offset
-		VK_WHOLE_SIZE													// range
+*/
+void DescriptorSetWrapper::WriteBuffer(uint32_t binding, BufferWrapper* buffer, VkDeviceSize range) {
+	VkDescriptorBufferInfo bufferInfo = {
+		.buffer = buffer->GetBuffer(),
+		.offset = 0,
+		.range = range
 	};
 
-	VkWriteDescriptorSet writeDescriptorSet = {
-		VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,							// sType
-		nullptr,														// pNext
-		mDescriptorSet,													// dstSet
-		0,																// dstBinding
-		0,																// dstArrayElement
-		1,																// descriptorCount
-		VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,								// descriptorType
-		nullptr,														// pImageInfo
-		&descriptorBI,													// pBufferInfo
-		nullptr															// pTexelBufferView
+	VkWriteDescriptorSet descriptorWrite = {
+		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.pNext = nullptr,
+		.dstSet = mDescriptorSet,
+		.dstBinding = binding,
+		.dstArrayElement = 0,
+		.descriptorCount = 1,
+		.descriptorType = mDescriptorSetLayout->GetDescriptorType(binding),
+		.pImageInfo = nullptr,
+		.pBufferInfo = &bufferInfo,
+		.pTexelBufferView = nullptr
 	};
 
-	vkUpdateDescriptorSets(mLogicalDevice->GetLogicalDevice(), 1, &writeDescriptorSet, 0, nullptr);
+	vkUpdateDescriptorSets(mLogicalDevice->GetLogicalDevice(), 1, &descriptorWrite, 0, nullptr);
 }
 
-void DescriptorSetWrapper::WriteDynamicDescriptorSet(BufferWrapper* viewProj, BufferWrapper* model) {
-	VkDescriptorBufferInfo viewProjBI = {
-		viewProj->GetBuffer(),											// buffer
-		0,																// offset
-		VK_WHOLE_SIZE,													// range
-	};
-
-	VkWriteDescriptorSet viewProjWriteDescriptorSet = {
-		VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,							// sType
-		nullptr,														// pNext
-		mDescriptorSet,													// dstSet
-		0,																// dstBinding
-		0,																// dstArrayElement
-		1,																// descriptorCount
-		VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,								// descriptorType
-		nullptr,														// pImageInfo
-		&viewProjBI,													// pBufferInfo
-		nullptr															// pTexelBufferView
-	};
-
-	VkDescriptorBufferInfo modelBI = {
-		model->GetBuffer(),												// buffer
-		0,																// offset
-		sizeof(glm::mat4)												// range (NOTE: WRONG WAY TO DO THIS. SHOULD GRAB ALIGN VALUE FROM RENDERER)
-	};
+void DescriptorSetWrapper::WriteImage(uint32_t binding, ImageViewWrapper* imageView, SamplerWrapper* sampler) {
+	WriteImage(binding, 0, imageView, sampler);
+}
 
-	VkWriteDescriptorSet modelWriteDescriptorSet = {
-		VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,							// sType
-		nullptr,														// pNext
-		mDescriptorSet,													// dstSet
-		1,																// dstBinding
-		0,																// dstArrayElement
-		1,																// descriptorCount
-		VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,						// descriptorType
-		nullptr,														// pImageInfo
-		&modelBI,														// pBufferInfo
-		nullptr,														// pTexelBufferView
-	};
+/*
 
-	std::vector<VkWriteDescriptorSet> writeDescriptorSets = { viewProjWriteDescriptorSet, modelWriteDescriptorSet };
+	Writes one element of an arrayed binding. Either the image view or the sampler can be nullptr when the
+	binding doesn't take one (SAMPLED_IMAGE / SAMPLER).
 
-	vkUpdateDescriptorSets(mLogicalDevice->GetLogicalDevice(), (uint32_t)writeDescriptorSets.size(), writeDescriptorSets.data(), 0, nullptr);
-}
+*/
+void DescriptorSetWrapper::WriteImage(uint32_t binding, uint32_t arrayElement, ImageViewWrapper* imageView, SamplerWrapper* sampler) {
+	VkDescriptorType descriptorType = mDescriptorSetLayout->GetDescriptorType(binding);
 
-void DescriptorSetWrapper::WriteTextureDescriptorSet(ImageViewWrapper* imageView, SamplerWrapper* sampler) {
+	// Storage images are written by compute shaders, which needs the GENERAL layout
 	VkDescriptorImageInfo imageInfo = {
-		.sampler = sampler->GetSampler(),
-		.imageView = imageView->GetImageView(),
-		.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+		.sampler = sampler != nullptr ? sampler->GetSampler() : VK_NULL_HANDLE,
+		.imageView = imageView != nullptr ? imageView->GetImageView() : VK_NULL_HANDLE,
+		.imageLayout = descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
 	};
 
 	VkWriteDescriptorSet descriptorWrite = {
 		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
 		.pNext = nullptr,
 		.dstSet = mDescriptorSet,
-		.dstBinding = 0,
-		.dstArrayElement = 0,
+		.dstBinding = binding,
+		.dstArrayElement = arrayElement,
 		.descriptorCount = 1,
-		.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		.descriptorType = descriptorType,
 		.pImageInfo = &imageInfo,
 		.pBufferInfo = nullptr,
 		.pTexelBufferView = nullptr
@@ -337,54 +421,31 @@ void DescriptorSetWrapper::WriteTextureDescriptorSet(ImageViewWrapper* imageView
 	vkUpdateDescriptorSets(mLogicalDevice->GetLogicalDevice(), 1, &descriptorWrite, 0, nullptr);
 }
 
-VkDescriptorSet DescriptorSetWrapper::GetDescriptorSet() {
-	return mDescriptorSet;
-}
+/*
 
-void DescriptorSetWrapper::CreateGenericDescriptorSet() {
-	VkDescriptorSetLayout layout = mDescriptorSetLayout->GetDescriptorSetLayout();
-	VkDescriptorSetAllocateInfo descriptorSetAI = {
-		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,					// sType
-		nullptr,														// pNext
-		mDescriptorPool->GetDescriptorPool(),							// descriptorPool
-		1,																// descriptorSetCount
-		&layout															// pSetLayouts
-	};
+	Writes every descriptor of the set at once through the layout's update template.
 
-	VkResult result = vkAllocateDescriptorSets(mLogicalDevice->GetLogicalDevice(), &descriptorSetAI, &mDescriptorSet);
-	if (result == VK_SUCCESS) {
-		std::cout << "Success: Descriptor Set allocated." << std::endl;
-	} else {
-		throw std::runtime_error("Failed to allocate Descriptor Set! Error Code: " + NT_CHECK_RESULT(result));
+*/
+void DescriptorSetWrapper::Write(const DescriptorSetContents& contents) {
+	if (contents.GetLayout() != mDescriptorSetLayout) {
+		throw std::runtime_error("Failed to write Descriptor Set! The contents are for a different layout.");
+	}
+	if (!contents.IsComplete()) {
+		throw std::runtime_error("Failed to write Descriptor Set! Not every descriptor has been set.");
 	}
-}
-
-
-/*
 
-	Do not really need another function to create dynamic descriptor sets since they are basically the same. 
-	But for pedagogical reasons I will keep it. 
+	vkUpdateDescriptorSetWithTemplate(mLogicalDevice->GetLogicalDevice(), mDescriptorSet, mDescriptorSetLayout->GetUpdateTemplate(), contents.GetData());
+}
 
-*/
-void DescriptorSetWrapper::CreateDynamicDescriptorSet() {
-	VkDescriptorSetLayout layout = mDescriptorSetLayout->GetDescriptorSetLayout();
-	VkDescriptorSetAllocateInfo descriptorSetAI = {
-		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,					// sType
-		nullptr,														// pNext
-		mDescriptorPool->GetDescriptorPool(),							// descriptorPool
-		1,																// descriptorSetCount
-		&layout															// pSetLayouts
-	};
+VkDescriptorSet DescriptorSetWrapper::GetDescriptorSet() {
+	return mDescriptorSet;
+}
 
-	VkResult result = vkAllocateDescriptorSets(mLogicalDevice->GetLogicalDevice(), &descriptorSetAI, &mDescriptorSet);
-	if (result == VK_SUCCESS) {
-		std::cout << "Success: Descriptor Set allocated." << std::endl;
-	} else {
-		throw std::runtime_error("Failed to allocate Descriptor Set! Error Code: " + NT_CHECK_RESULT(result));
-	}
+DescriptorSetLayoutWrapper* DescriptorSetWrapper::GetDescriptorSetLayout() {
+	return mDescriptorSetLayout;
 }
 
-void DescriptorSetWrapper::CreateTextureDescriptorSet() {
+void DescriptorSetWrapper::CreateDescriptorSet() {
 	VkDescriptorSetLayout layout = mDescriptorSetLayout->GetDescriptorSetLayout();
 	VkDescriptorSetAllocateInfo descriptorSetAI = {
 		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
@@ -2,69 +2,136 @@
 #define DESCRIPTOR_SET_WRAPPER
 
 #include <vulkan/vulkan.h>
+#include <vector>
 
 class LogicalDeviceWrapper;
 class BufferWrapper;
 class ImageViewWrapper;
 class SamplerWrapper;
+class DescriptorAllocator;
 
-enum DESCRIPTOR_TYPE {
-	GENERIC,
-	DYNAMIC,
-	TEXTURE
+/*
+
+	Notes:
+		- Layouts aren't written by hand anymore, their bindings come from shader reflection. Get them
+		  from the DescriptorLayoutCache (through PipelineRegistry::GetPipelineLayout()), which creates
+		  each distinct layout once.
+		- Pools are sized from a layout with GetPoolSizes(), sets look up the descriptor type of a binding
+		  in their layout, so none of the three classes knows what a set is used for.
+		- Bindings can carry VkDescriptorBindingFlags (descriptor indexing). A layout with an
+		  UPDATE_AFTER_BIND binding is created with the UPDATE_AFTER_BIND_POOL flag, and its sets have to
+		  come from a pool created with the matching pool flag, see IsUpdateAfterBind().
+		- Sets come either from a fixed DescriptorPoolWrapper or from a DescriptorAllocator, which grows
+		  instead of running out. Prefer the allocator unless the set needs special pool flags.
+		- Every layout without binding flags gets a VkDescriptorUpdateTemplate covering all of its
+		  descriptors. Fill a DescriptorSetContents and Write() it to update the whole set with one
+		  vkUpdateDescriptorSetWithTemplate call. Contents are hashable, DescriptorSetCache uses them to
+		  share sets. WriteBuffer() / WriteImage() stay for single descriptors, like bindless table slots.
+
+*/
+
+// One descriptor as the update templates read it. Zeroed before it's filled, so hashing the bytes works.
+union DescriptorInfo {
+	VkDescriptorImageInfo mImage;
+	VkDescriptorBufferInfo mBuffer;
+	VkBufferView mTexelBufferView;
 };
 
 class DescriptorSetLayoutWrapper {
 public:
-	DescriptorSetLayoutWrapper(LogicalDeviceWrapper*, DESCRIPTOR_TYPE);
+	DescriptorSetLayoutWrapper(LogicalDeviceWrapper*, std::vector<VkDescriptorSetLayoutBinding>);
+	DescriptorSetLayoutWrapper(LogicalDeviceWrapper*, std::vector<VkDescriptorSetLayoutBinding>, std::vector<VkDescriptorBindingFlags>);
 	~DescriptorSetLayoutWrapper();
 
 	VkDescriptorSetLayout GetDescriptorSetLayout();
+	std::vector<VkDescriptorSetLayoutBinding> GetBindings();
+	std::vector<VkDescriptorBindingFlags> GetBindingFlags();
+	VkDescriptorType GetDescriptorType(uint32_t);
+	uint32_t GetDescriptorCount(uint32_t);
+	std::vector<VkDescriptorPoolSize> GetPoolSizes(uint32_t);
+	bool IsUpdateAfterBind();
+
+	VkDescriptorUpdateTemplate GetUpdateTemplate();
+	uint32_t GetDescriptorIndex(uint32_t, uint32_t);
+	uint32_t GetTotalDescriptorCount();
 private:
-	void CreateGenericDescriptorSetLayout();
-	void CreateDynamicDescriptorSetLayout();
-	void CreateTextureDescriptorSetLayout();
+	void CreateDescriptorSetLayout();
+	void CreateUpdateTemplate();
 
 	VkDescriptorSetLayout mDescriptorSetLayout;
+	VkDescriptorUpdateTemplate mUpdateTemplate;					// VK_NULL_HANDLE for layouts with binding flags
+	std::vector<VkDescriptorSetLayoutBinding> mBindings;
+	std::vector<VkDescriptorBindingFlags> mBindingFlags;		// One per binding, all 0 without descriptor indexing
+	std::vector<uint32_t> mDescriptorIndices;					// Where each binding starts in the template data
+	uint32_t mTotalDescriptorCount;
 
 	LogicalDeviceWrapper* mLogicalDeviceWrapper;
 };
 
 class DescriptorPoolWrapper {
 public:
-	DescriptorPoolWrapper(LogicalDeviceWrapper*, DESCRIPTOR_TYPE);
+	DescriptorPoolWrapper(LogicalDeviceWrapper*, std::vector<VkDescriptorPoolSize>, uint32_t);
+	DescriptorPoolWrapper(LogicalDeviceWrapper*, std::vector<VkDescriptorPoolSize>, uint32_t, VkDescriptorPoolCreateFlags);
 	~DescriptorPoolWrapper();
 
 	VkDescriptorPool GetDescriptorPool();
+	void Reset();
 private:
-	void CreateGenericDescriptorPool();
-	void CreateDynamicDescriptorPool();
-	void CreateTextureDescriptorPool();
+	void CreateDescriptorPool(std::vector<VkDescriptorPoolSize>, uint32_t, VkDescriptorPoolCreateFlags);
 
 	VkDescriptorPool mDescriptorPool;
 	
 	LogicalDeviceWrapper* mLogicalDevice;
 };
 
+class DescriptorSetContents {
+public:
+	DescriptorSetContents(DescriptorSetLayoutWrapper*);
+
+	void SetBuffer(uint32_t, BufferWrapper*, VkDeviceSize);
+	void SetImage(uint32_t, ImageViewWrapper*, SamplerWrapper*);
+	void SetImage(uint32_t, uint32_t, ImageViewWrapper*, SamplerWrapper*);
+
+	DescriptorSetLayoutWrapper* GetLayout() const;
+	const DescriptorInfo* GetData() const;
+	uint32_t GetDescriptorCount() const;
+	size_t GetHash() const;
+	bool IsComplete() const;
+	bool UsesBuffer(VkBuffer) const;
+	bool UsesImageView(VkImageView) const;
+
+	bool operator==(const DescriptorSetContents&) const;
+private:
+	DescriptorInfo& GetInfo(uint32_t, uint32_t);
+
+	std::vector<DescriptorInfo> mData;
+	std::vector<VkDescriptorType> mTypes;						// Type of every descriptor in mData
+	std::vector<bool> mWritten;
+
+	DescriptorSetLayoutWrapper* mDescriptorSetLayout;
+};
+
 class DescriptorSetWrapper {
 public:
-	DescriptorSetWrapper(LogicalDeviceWrapper*, DescriptorSetLayoutWrapper*, DescriptorPoolWrapper*, DESCRIPTOR_TYPE);
+	DescriptorSetWrapper(LogicalDeviceWrapper*, DescriptorSetLayoutWrapper*, DescriptorPoolWrapper*);
+	DescriptorSetWrapper(LogicalDeviceWrapper*, DescriptorSetLayoutWrapper*, DescriptorAllocator*);
 	~DescriptorSetWrapper();
 
-	void WriteGenericDescriptorSet(BufferWrapper*);
-	void WriteDynamicDescriptorSet(BufferWrapper*, BufferWrapper*);
-	void WriteTextureDescriptorSet(ImageViewWrapper*, SamplerWrapper*);
+	void WriteBuffer(uint32_t, BufferWrapper*, VkDeviceSize);
+	void WriteImage(uint32_t, ImageViewWrapper*, SamplerWrapper*);
+	void WriteImage(uint32_t, uint32_t, ImageViewWrapper*, SamplerWrapper*);
+	void Write(const DescriptorSetContents&);
 
 	VkDescriptorSet GetDescriptorSet();
+	DescriptorSetLayoutWrapper* GetDescriptorSetLayout();
 private:
-	void CreateGenericDescriptorSet();
-	void CreateDynamicDescriptorSet();
-	void CreateTextureDescriptorSet();
+	void CreateDescriptorSet();
 
 	VkDescriptorSet mDescriptorSet;
 
 	LogicalDeviceWrapper* mLogicalDevice;
 	DescriptorSetLayoutWrapper* mDescriptorSetLayout;
-	DescriptorPoolWrapper* mDescriptorPool;
+	DescriptorPoolWrapper* mDescriptorPool;				// Exactly one of these two is set
+	DescriptorAllocator* mDescriptorAllocator;
 };
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,134 @@
+#include "FrameContext.h"
+#include "globals.h"
+#include <chrono>
+#include "PhysicalDeviceWrapper.h"
+#include "LogicalDeviceWrapper.h"
+#include "CommandPoolWrapper.h"
+#include "CommandBufferWrapper.h"
+#include "SynchronizationWrapper.h"
+#include "DescriptorSetWrapper.h"
+#include "DescriptorAllocator.h"
+
+FrameContext::FrameContext(PhysicalDeviceWrapper* pDevice, LogicalDeviceWrapper* lDevice, uint32_t index, uint32_t recordingTaskCount, UniformRingBuffer* ring, DescriptorSetWrapper* descriptorSet) : mIndex(index), mDescriptorSet(descriptorSet), mPhysicalDevice(pDevice), mLogicalDevice(lDevice), mUniformRing(ring) {
+	uint32_t graphicsFamily = mPhysicalDevice->GetQueueFamilyIndices().mGraphics;
+
+	mCommandPool = new CommandPoolWrapper(mLogicalDevice, graphicsFamily);
+	mCommandBuffer = new CommandBufferWrapper(mLogicalDevice, mCommandPool);
+
+	// Every recording task gets its own pool, since a pool can only be used by one thread at a time
+	for (uint32_t i = 0; i < recordingTaskCount; i++) {
+		mRecordingCommandPools.push_back(new CommandPoolWrapper(mLogicalDevice, graphicsFamily));
+		mSecondaryCommandBuffers.push_back(new CommandBufferWrapper(mLogicalDevice, mRecordingCommandPools.at(i), VK_COMMAND_BUFFER_LEVEL_SECONDARY));
+	}
+
+	mTransientDescriptors = new DescriptorAllocator(mLogicalDevice, { }, 16, true);
+
+	mImageAvailableSemaphore = new SemaphoreWrapper(mLogicalDevice);
+	mRenderFinishedSemaphore = new SemaphoreWrapper(mLogicalDevice);
+	mTimeline = mLogicalDevice->GetGraphicsTimeline();
+	mSubmittedValue = 0;
+	mStallTime = 0.0;
+
+	mRecordedSceneVersion = UINT64_MAX;
+	mRecordedDrawTaskCount = 0;
+}
+
+FrameContext::~FrameContext() {
+	delete mRenderFinishedSemaphore;
+	delete mImageAvailableSemaphore;
+	delete mTransientDescriptors;
+	for (size_t i = 0; i < mSecondaryCommandBuffers.size(); i++) {
+		delete mSecondaryCommandBuffers.at(i);
+		delete mRecordingCommandPools.at(i);
+	}
+	delete mCommandBuffer;
+	delete mCommandPool;
+}
+
+/*
+
+	Waits until the GPU is done with the last submission from this slot, rewinds the slot's uniform
+	region and drops its transient descriptor sets. Everything owned by the context may be written to
+	afterwards.
+
+*/
+void FrameContext::Begin() {
+	mStallTime = 0.0;
+	if (!mTimeline->IsComplete(mSubmittedValue)) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		mTimeline->Wait(mSubmittedValue);
+		mStallTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	mUniformRing->BeginFrame(mIndex);
+	mTransientDescriptors->Reset();
+}
+
+UniformAllocation FrameContext::AllocateUniform(VkDeviceSize size) {
+	return mUniformRing->Allocate(size);
+}
+
+uint32_t FrameContext::GetIndex() {
+	return mIndex;
+}
+
+CommandPoolWrapper* FrameContext::GetCommandPool() {
+	return mCommandPool;
+}
+
+CommandBufferWrapper* FrameContext::GetCommandBuffer() {
+	return mCommandBuffer;
+}
+
+size_t FrameContext::GetRecordingTaskCount() {
+	return mRecordingCommandPools.size();
+}
+
+CommandPoolWrapper* FrameContext::GetRecordingCommandPool(size_t task) {
+	return mRecordingCommandPools.at(task);
+}
+
+CommandBufferWrapper* FrameContext::GetSecondaryCommandBuffer(size_t task) {
+	return mSecondaryCommandBuffers.at(task);
+}
+
+DescriptorSetWrapper* FrameContext::GetDescriptorSet() {
+	return mDescriptorSet;
+}
+
+DescriptorAllocator* FrameContext::GetTransientDescriptorAllocator() {
+	return mTransientDescriptors;
+}
+
+SemaphoreWrapper* FrameContext::GetImageAvailableSemaphore() {
+	return mImageAvailableSemaphore;
+}
+
+SemaphoreWrapper* FrameContext::GetRenderFinishedSemaphore() {
+	return mRenderFinishedSemaphore;
+}
+
+uint64_t FrameContext::GetSubmittedValue() {
+	return mSubmittedValue;
+}
+
+void FrameContext::SetSubmittedValue(uint64_t value) {
+	mSubmittedValue = value;
+}
+
+double FrameContext::GetStallTime() {
+	return mStallTime;
+}
+
+uint64_t FrameContext::GetRecordedSceneVersion() {
+	return mRecordedSceneVersion;
+}
+
+size_t FrameContext::GetRecordedDrawTaskCount() {
+	return mRecordedDrawTaskCount;
+}
+
+void FrameContext::SetRecorded(uint64_t sceneVersion, size_t drawTaskCount) {
+	mRecordedSceneVersion = sceneVersion;
+	mRecordedDrawTaskCount = drawTaskCount;
+}
@@ -0,0 +1,88 @@
+#ifndef FRAME_CONTEXT_H
+#define FRAME_CONTEXT_H
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+#include "UniformRingBuffer.h"
+
+class PhysicalDeviceWrapper;
+class LogicalDeviceWrapper;
+class CommandPoolWrapper;
+class CommandBufferWrapper;
+class SemaphoreWrapper;
+class TimelineSemaphoreWrapper;
+class DescriptorSetLayoutWrapper;
+class DescriptorAllocator;
+class DescriptorSetWrapper;
+
+/*
+
+	FrameContext owns everything one frame in flight writes to on the CPU: its command pools and
+	buffers, its region of the UniformRingBuffer, its descriptor set and its synchronization objects.
+	All of it is indexed by frame slot, never by swapchain image index, so waiting in Begin() for the
+	graphics timeline to reach the slot's last submitted value is enough to know none of it is still in
+	use by the GPU. How long that wait took is kept as the frame's CPU stall time.
+
+	Notes:
+		- The Renderer owns between 1 and MAX_FRAMES_IN_FLIGHT of these. The uniform ring is sized for
+		  MAX_FRAMES_IN_FLIGHT so the count can change at runtime. The uniform descriptor set comes from
+		  the Renderer's DescriptorSetCache. Every slot binds the same ring buffer with the same ranges,
+		  so all of them share one set, which the context doesn't own.
+		- Sets that are only needed for one frame come from the context's transient DescriptorAllocator,
+		  which Begin() resets. Only use them in commands recorded every frame, never in the secondaries.
+		- The primary command pool is reset every frame. The recording pools are only reset when the
+		  secondaries get re-recorded, see Renderer::RecordFrameCommands().
+
+*/
+
+class FrameContext {
+public:
+	FrameContext(PhysicalDeviceWrapper*, LogicalDeviceWrapper*, uint32_t, uint32_t, UniformRingBuffer*, DescriptorSetWrapper*);
+	~FrameContext();
+
+	void Begin();
+	UniformAllocation AllocateUniform(VkDeviceSize);
+
+	uint32_t GetIndex();
+	CommandPoolWrapper* GetCommandPool();
+	CommandBufferWrapper* GetCommandBuffer();
+	size_t GetRecordingTaskCount();
+	CommandPoolWrapper* GetRecordingCommandPool(size_t);
+	CommandBufferWrapper* GetSecondaryCommandBuffer(size_t);
+	DescriptorSetWrapper* GetDescriptorSet();
+	DescriptorAllocator* GetTransientDescriptorAllocator();
+	SemaphoreWrapper* GetImageAvailableSemaphore();
+	SemaphoreWrapper* GetRenderFinishedSemaphore();
+
+	uint64_t GetSubmittedValue();
+	void SetSubmittedValue(uint64_t);
+	double GetStallTime();
+
+	uint64_t GetRecordedSceneVersion();
+	size_t GetRecordedDrawTaskCount();
+	void SetRecorded(uint64_t, size_t);
+private:
+	uint32_t mIndex;
+
+	CommandPoolWrapper* mCommandPool;
+	CommandBufferWrapper* mCommandBuffer;
+	std::vector<CommandPoolWrapper*> mRecordingCommandPools;		// One per recording task
+	std::vector<CommandBufferWrapper*> mSecondaryCommandBuffers;	// One per recording task
+	DescriptorSetWrapper* mDescriptorSet;							// Owned by the Renderer's DescriptorSetCache
+	DescriptorAllocator* mTransientDescriptors;
+	SemaphoreWrapper* mImageAvailableSemaphore;
+	SemaphoreWrapper* mRenderFinishedSemaphore;
+	TimelineSemaphoreWrapper* mTimeline;
+	uint64_t mSubmittedValue;										// Graphics timeline value of the last submission from this slot
+	double mStallTime;												// Milliseconds Begin() spent waiting on the GPU
+
+	uint64_t mRecordedSceneVersion;									// Scene version the secondaries were recorded at
+	size_t mRecordedDrawTaskCount;									// How many secondaries hold draws
+
+	PhysicalDeviceWrapper* mPhysicalDevice;
+	LogicalDeviceWrapper* mLogicalDevice;
+	UniformRingBuffer* mUniformRing;
+};
+#endif
@@ -0,0 +1,98 @@
+#include "FrameSink.h"
+#include "globals.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <stdexcept>
+#include "ImageWriter.h"
+
+RawFrameSink::RawFrameSink(std::string path) : mPath(path) {
+	mFile.open(path, std::ios::binary | std::ios::trunc);
+	if (!mFile.is_open()) {
+		throw std::runtime_error("Failed to open " + path + " for writing!");
+	}
+	std::cout << "Success: Raw Frame Sink created. (" << path << ")" << std::endl;
+}
+
+RawFrameSink::~RawFrameSink() {
+	mFile.close(); std::cout << "Success: Raw Frame Sink destroyed." << std::endl;
+}
+
+void RawFrameSink::WriteFrame(const uint8_t* pixels, uint32_t width, uint32_t height, uint64_t frameNumber) {
+	mFile.write((const char*)pixels, (std::streamsize)width * height * 4);
+	if (!mFile) {
+		throw std::runtime_error("Failed to write frame " + std::to_string(frameNumber) + " to " + mPath + "!");
+	}
+}
+
+Y4MFrameSink::Y4MFrameSink(std::string path, uint32_t framesPerSecond) : mPath(path), mFramesPerSecond(framesPerSecond), mWidth(0), mHeight(0) {
+	mFile.open(path, std::ios::binary | std::ios::trunc);
+	if (!mFile.is_open()) {
+		throw std::runtime_error("Failed to open " + path + " for writing!");
+	}
+	std::cout << "Success: Y4M Frame Sink created. (" << path << ")" << std::endl;
+}
+
+Y4MFrameSink::~Y4MFrameSink() {
+	mFile.close(); std::cout << "Success: Y4M Frame Sink destroyed." << std::endl;
+}
+
+/*
+
+	The stream header is written with the first frame, that's the first time the size is known. Every
+	later frame has to match it.
+
+*/
+void Y4MFrameSink::WriteFrame(const uint8_t* pixels, uint32_t width, uint32_t height, uint64_t frameNumber) {
+	if (mWidth == 0) {
+		mWidth = width;
+		mHeight = height;
+		mPlanes.resize((size_t)width * height * 3);
+		mFile << "YUV4MPEG2 W" << width << " H" << height << " F" << mFramesPerSecond << ":1 Ip A1:1 C444\n";
+	} else if (width != mWidth || height != mHeight) {
+		throw std::runtime_error("Y4M streams can't change size mid stream!");
+	}
+
+	size_t pixelCount = (size_t)width * height;
+	uint8_t* y = mPlanes.data();
+	uint8_t* u = y + pixelCount;
+	uint8_t* v = u + pixelCount;
+	for (size_t i = 0; i < pixelCount; i++) {
+		int r = pixels[i * 4 + 0];
+		int g = pixels[i * 4 + 1];
+		int b = pixels[i * 4 + 2];
+		y[i] = (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+		u[i] = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+		v[i] = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+	}
+
+	mFile << "FRAME\n";
+	mFile.write((const char*)mPlanes.data(), (std::streamsize)mPlanes.size());
+	if (!mFile) {
+		throw std::runtime_error("Failed to write frame " + std::to_string(frameNumber) + " to " + mPath + "!");
+	}
+}
+
+PNGSequenceFrameSink::PNGSequenceFrameSink(std::string prefix) : mPrefix(prefix) {
+	std::cout << "Success: PNG Sequence Frame Sink created. (" << prefix << "_######.png)" << std::endl;
+}
+
+void PNGSequenceFrameSink::WriteFrame(const uint8_t* pixels, uint32_t width, uint32_t height, uint64_t frameNumber) {
+	char number[32];
+	snprintf(number, sizeof(number), "_%06llu.png", (unsigned long long)frameNumber);
+	WritePNG(mPrefix + number, pixels, width, height);
+}
+
+FrameSink* CreateFrameSink(const std::string& path) {
+	size_t dot = path.find_last_of('.');
+	std::string extension = dot == std::string::npos ? "" : path.substr(dot + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+	if (extension == "rgba" || extension == "raw") {
+		return new RawFrameSink(path);
+	}
+	if (extension == "y4m") {
+		return new Y4MFrameSink(path, FRAME_STREAM_FPS);
+	}
+	return new PNGSequenceFrameSink(path);
+}
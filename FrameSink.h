@@ -0,0 +1,68 @@
+#ifndef FRAME_SINK_H
+#define FRAME_SINK_H
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <cstdint>
+
+/*
+
+	A FrameSink is where a stream of headless frames ends up. Frames arrive in order as tightly packed
+	RGBA8 rows, always on the FrameStreamer's worker thread, never on the render thread.
+
+	Notes:
+		- RawFrameSink appends the RGBA bytes of every frame to one file. Good for piping into other tools,
+		  e.g. ffmpeg -f rawvideo -pix_fmt rgba -s WxH -i file.
+		- Y4MFrameSink writes a YUV4MPEG2 stream with 4:4:4 chroma (BT.601, limited range). Skipping the chroma
+		  subsampling keeps the conversion a per pixel operation, encoders downsample anyway.
+		- PNGSequenceFrameSink writes prefix_000000.png, prefix_000001.png, ... numbered by frame.
+		- CreateFrameSink() picks one from the extension like WriteImage() does: .rgba / .raw, .y4m,
+		  anything else is taken as the prefix of a PNG sequence.
+
+*/
+
+class FrameSink {
+public:
+	virtual ~FrameSink() = default;
+
+	virtual void WriteFrame(const uint8_t*, uint32_t, uint32_t, uint64_t) = 0;
+};
+
+class RawFrameSink : public FrameSink {
+public:
+	RawFrameSink(std::string);
+	~RawFrameSink();
+
+	void WriteFrame(const uint8_t*, uint32_t, uint32_t, uint64_t) override;
+private:
+	std::ofstream mFile;
+	std::string mPath;
+};
+
+class Y4MFrameSink : public FrameSink {
+public:
+	Y4MFrameSink(std::string, uint32_t);
+	~Y4MFrameSink();
+
+	void WriteFrame(const uint8_t*, uint32_t, uint32_t, uint64_t) override;
+private:
+	std::ofstream mFile;
+	std::string mPath;
+	uint32_t mFramesPerSecond;
+	uint32_t mWidth;
+	uint32_t mHeight;
+	std::vector<uint8_t> mPlanes;					// Y, U and V planes of the frame being written
+};
+
+class PNGSequenceFrameSink : public FrameSink {
+public:
+	PNGSequenceFrameSink(std::string);
+
+	void WriteFrame(const uint8_t*, uint32_t, uint32_t, uint64_t) override;
+private:
+	std::string mPrefix;
+};
+
+FrameSink* CreateFrameSink(const std::string&);
+#endif
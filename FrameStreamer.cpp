@@ -0,0 +1,110 @@
+#include "FrameStreamer.h"
+#include "globals.h"
+#include <chrono>
+#include "FrameSink.h"
+
+FrameStreamer::FrameStreamer(FrameSink* sink, uint32_t width, uint32_t height, uint32_t queueDepth) : mSink(sink), mWidth(width), mHeight(height), mWriting(false), mBlockedTime(0.0), mException(nullptr), mStopping(false) {
+	mQueueDepth = queueDepth == 0 ? 1 : queueDepth;
+	mThread = std::thread(&FrameStreamer::WorkerLoop, this);
+	std::cout << "Success: Frame Streamer created. (queue depth " << mQueueDepth << ")" << std::endl;
+}
+
+FrameStreamer::~FrameStreamer() {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+	mFrameAvailable.notify_all();
+
+	mThread.join(); std::cout << "Success: Frame Streamer destroyed." << std::endl;
+}
+
+std::vector<uint8_t> FrameStreamer::AcquireBuffer() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (mFreeBuffers.empty()) {
+		return std::vector<uint8_t>((size_t)mWidth * mHeight * 4);
+	}
+
+	std::vector<uint8_t> buffer = std::move(mFreeBuffers.back());
+	mFreeBuffers.pop_back();
+	return buffer;
+}
+
+void FrameStreamer::Submit(std::vector<uint8_t>&& pixels, uint64_t frameNumber) {
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		if (mFrames.size() >= mQueueDepth) {
+			auto start = std::chrono::high_resolution_clock::now();
+			mFrameWritten.wait(lock, [this] { return mFrames.size() < mQueueDepth || mException != nullptr; });
+			mBlockedTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		}
+		RethrowWorkerException();
+
+		mFrames.push({ std::move(pixels), frameNumber });
+	}
+	mFrameAvailable.notify_one();
+}
+
+/*
+
+	Blocks until the sink has written every submitted frame.
+
+*/
+void FrameStreamer::Flush() {
+	std::unique_lock<std::mutex> lock(mMutex);
+	mFrameWritten.wait(lock, [this] { return (mFrames.empty() && !mWriting) || mException != nullptr; });
+	RethrowWorkerException();
+}
+
+FrameSink* FrameStreamer::GetSink() {
+	return mSink;
+}
+
+double FrameStreamer::GetBlockedTime() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mBlockedTime;
+}
+
+// Must be called with mMutex held
+void FrameStreamer::RethrowWorkerException() {
+	if (mException != nullptr) {
+		std::exception_ptr exception = mException;
+		mException = nullptr;
+		std::rethrow_exception(exception);
+	}
+}
+
+void FrameStreamer::WorkerLoop() {
+	while (true) {
+		StreamedFrame frame;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mFrameAvailable.wait(lock, [this] { return mStopping || !mFrames.empty(); });
+
+			if (mStopping && mFrames.empty()) {
+				return;
+			}
+
+			frame = std::move(mFrames.front());
+			mFrames.pop();
+			mWriting = true;
+		}
+
+		std::exception_ptr exception = nullptr;
+		try {
+			mSink->WriteFrame(frame.mPixels.data(), mWidth, mHeight, frame.mFrameNumber);
+		} catch (...) {
+			exception = std::current_exception();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (exception != nullptr && mException == nullptr) {
+				mException = exception;
+			}
+			mFreeBuffers.push_back(std::move(frame.mPixels));
+			mWriting = false;
+		}
+		mFrameWritten.notify_all();
+	}
+}
@@ -0,0 +1,68 @@
+#ifndef FRAME_STREAMER_H
+#define FRAME_STREAMER_H
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <cstdint>
+
+class FrameSink;
+
+/*
+
+	FrameStreamer hands read back frames to a FrameSink on its own worker thread, so encoding and disk
+	writes overlap with rendering.
+
+	Notes:
+		- The queue is bounded by the depth given at creation. Submit() blocks once the worker is that
+		  many frames behind, which keeps memory in check when the sink is slower than the GPU.
+		- Frame buffers are recycled. AcquireBuffer() hands out one the worker is done with (or a new
+		  one), Submit() gives it back. After warm up no allocation happens per frame.
+		- Like the ThreadPool, an exception thrown by the sink is rethrown on the render thread, from
+		  the next Submit() or Flush().
+		- The sink is not owned.
+
+*/
+
+struct StreamedFrame {
+	std::vector<uint8_t> mPixels;
+	uint64_t mFrameNumber;
+};
+
+class FrameStreamer {
+public:
+	FrameStreamer(FrameSink*, uint32_t, uint32_t, uint32_t);
+	~FrameStreamer();
+
+	std::vector<uint8_t> AcquireBuffer();
+	void Submit(std::vector<uint8_t>&&, uint64_t);
+	void Flush();
+
+	FrameSink* GetSink();
+	double GetBlockedTime();
+private:
+	void WorkerLoop();
+	void RethrowWorkerException();
+
+	FrameSink* mSink;
+	uint32_t mWidth;
+	uint32_t mHeight;
+	uint32_t mQueueDepth;
+
+	std::thread mThread;
+	std::queue<StreamedFrame> mFrames;
+	std::vector<std::vector<uint8_t>> mFreeBuffers;
+
+	std::mutex mMutex;
+	std::condition_variable mFrameAvailable;
+	std::condition_variable mFrameWritten;
+
+	bool mWriting;
+	double mBlockedTime;							// Total time Submit() spent waiting on a full queue, in milliseconds
+	std::exception_ptr mException;
+	bool mStopping;
+};
+#endif
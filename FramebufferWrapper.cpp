@@ -13,6 +13,14 @@ FramebufferWrapper::FramebufferWrapper(LogicalDeviceWrapper* lDevice, SwapchainW
 	CreateFramebuffer(index, imageView);
 }
 
+/*
+
+	Headless: renders into the given color view instead of a swapchain image.
+
+*/
+FramebufferWrapper::FramebufferWrapper(LogicalDeviceWrapper* lDevice, RenderPassWrapper* renderpass, ImageViewWrapper* colorView, ImageViewWrapper* depthView, VkExtent2D extent) : mLogicalDevice(lDevice), mSwapchain(nullptr), mRenderPass(renderpass) {
+	CreateFramebuffer(colorView, depthView, extent);
+}
 
 FramebufferWrapper::~FramebufferWrapper() {
 	vkDestroyFramebuffer(mLogicalDevice->GetLogicalDevice(), mFramebuffer, nullptr); std::cout << "Success: Framebuffer destroyed." << std::endl;
@@ -70,3 +78,28 @@ void FramebufferWrapper::CreateFramebuffer(int index, ImageViewWrapper* imageVie
 		throw std::runtime_error("Failed to create framebuffer! Error Code: " + NT_CHECK_RESULT(result));
 	}
 }
+
+void FramebufferWrapper::CreateFramebuffer(ImageViewWrapper* colorView, ImageViewWrapper* depthView, VkExtent2D extent) {
+	std::vector<VkImageView> framebufferAttachments = {
+		colorView->GetImageView(),
+		depthView->GetImageView()
+	};
+	VkFramebufferCreateInfo framebufferCI = {
+		VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,						// sType
+		nullptr,														// pNext
+		0,																// flags
+		mRenderPass->GetRenderPass(),									// renderPass
+		static_cast<uint32_t>(framebufferAttachments.size()),			// attachmentCount
+		framebufferAttachments.data(),									// pAttachments
+		extent.width,													// width
+		extent.height,													// height
+		1																// layers
+	};
+
+	VkResult result = vkCreateFramebuffer(mLogicalDevice->GetLogicalDevice(), &framebufferCI, nullptr, &mFramebuffer);
+	if (result == VK_SUCCESS) {
+		std::cout << "Success: Framebuffer created." << std::endl;
+	} else {
+		throw std::runtime_error("Failed to create framebuffer! Error Code: " + NT_CHECK_RESULT(result));
+	}
+}
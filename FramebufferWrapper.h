@@ -19,12 +19,14 @@ class FramebufferWrapper {
 public:
 	FramebufferWrapper(LogicalDeviceWrapper*, SwapchainWrapper*, RenderPassWrapper*, int);
 	FramebufferWrapper(LogicalDeviceWrapper*, SwapchainWrapper*, RenderPassWrapper*, int, ImageViewWrapper*);
+	FramebufferWrapper(LogicalDeviceWrapper*, RenderPassWrapper*, ImageViewWrapper*, ImageViewWrapper*, VkExtent2D);
 	~FramebufferWrapper();
 
 	VkFramebuffer GetFramebuffer();
 private:
 	void CreateFramebuffer(int);
 	void CreateFramebuffer(int, ImageViewWrapper*);
+	void CreateFramebuffer(ImageViewWrapper*, ImageViewWrapper*, VkExtent2D);
 
 	VkFramebuffer mFramebuffer;
 
@@ -4,7 +4,11 @@
 
 
 ImageViewWrapper::ImageViewWrapper(LogicalDeviceWrapper* lDevice, VkImage image, VkFormat format, VkImageAspectFlags flags) : mLogicalDevice(lDevice) {
-	CreateImageView(image, format, flags);
+	CreateImageView(image, format, flags, 1);
+}
+
+ImageViewWrapper::ImageViewWrapper(LogicalDeviceWrapper* lDevice, VkImage image, VkFormat format, VkImageAspectFlags flags, uint32_t mipLevels) : mLogicalDevice(lDevice) {
+	CreateImageView(image, format, flags, mipLevels);
 }
 
 ImageViewWrapper::~ImageViewWrapper() {
@@ -15,7 +19,7 @@ VkImageView ImageViewWrapper::GetImageView() {
 	return mImageView;
 }
 
-void ImageViewWrapper::CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags flags) {
+void ImageViewWrapper::CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags flags, uint32_t mipLevels) {
 	// Describe the ImageView
 	VkComponentMapping imageViewComponentMapping = {
 		.r = VK_COMPONENT_SWIZZLE_IDENTITY,
@@ -26,7 +30,7 @@ void ImageViewWrapper::CreateImageView(VkImage image, VkFormat format, VkImageAs
 	VkImageSubresourceRange imageSubresourceRange = {
 		.aspectMask = flags,
 		.baseMipLevel = 0,
-		.levelCount = 1,
+		.levelCount = mipLevels,
 		.baseArrayLayer = 0,
 		.layerCount = 1
 	};
@@ -14,11 +14,12 @@ class LogicalDeviceWrapper;
 class ImageViewWrapper {
 public:
 	ImageViewWrapper(LogicalDeviceWrapper*, VkImage, VkFormat, VkImageAspectFlags);
+	ImageViewWrapper(LogicalDeviceWrapper*, VkImage, VkFormat, VkImageAspectFlags, uint32_t);
 	~ImageViewWrapper();
 
 	VkImageView GetImageView();
 private:
-	void CreateImageView(VkImage, VkFormat, VkImageAspectFlags);
+	void CreateImageView(VkImage, VkFormat, VkImageAspectFlags, uint32_t);
 
 	VkImageView mImageView;
 
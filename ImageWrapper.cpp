@@ -1,29 +1,55 @@
 #include "ImageWrapper.h"
 #include "globals.h"
+#include <algorithm>
+#include <cmath>
 #include "PhysicalDeviceWrapper.h"
 #include "LogicalDeviceWrapper.h"
-#include "CommandPoolWrapper.h"
-#include "CommandBufferWrapper.h"
-#include "BufferWrapper.h"
+#include "MemoryAllocator.h"
+#include "UploadContext.h"
 
-ImageWrapper::ImageWrapper(PhysicalDeviceWrapper* pDevice, LogicalDeviceWrapper* lDevice, CommandPoolWrapper* gPool, uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags useFlags, VkMemoryPropertyFlags propFlags) : mPhysicalDevice(pDevice), mLogicalDevice(lDevice), mGraphicsCommandPool(gPool) {
-	CreateImage(width, height, format, tiling, useFlags, propFlags);
+ImageWrapper::ImageWrapper(PhysicalDeviceWrapper* pDevice, LogicalDeviceWrapper* lDevice, uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags useFlags, VkMemoryPropertyFlags propFlags) : mPhysicalDevice(pDevice), mLogicalDevice(lDevice) {
+	CreateImage(width, height, 1, format, tiling, useFlags, propFlags);
 }
 
-ImageWrapper::ImageWrapper(PhysicalDeviceWrapper* pDevice, LogicalDeviceWrapper* lDevice, CommandPoolWrapper* gPool, std::string filename) : mPhysicalDevice(pDevice), mLogicalDevice(lDevice), mGraphicsCommandPool(gPool) {
-	CreateTextureImage(filename);
+ImageWrapper::ImageWrapper(PhysicalDeviceWrapper* pDevice, LogicalDeviceWrapper* lDevice, UploadContext* upload, std::string filename) : mPhysicalDevice(pDevice), mLogicalDevice(lDevice) {
+	CreateTextureImage(upload, filename);
 }
 
 ImageWrapper::~ImageWrapper() {
 	vkDestroyImage(mLogicalDevice->GetLogicalDevice(), mImage, nullptr);
-	vkFreeMemory(mLogicalDevice->GetLogicalDevice(), mImageMemory, nullptr);
+	mLogicalDevice->GetMemoryAllocator()->Free(mImageAllocation);
 }
 
 VkImage ImageWrapper::GetImage() {
 	return mImage;
 }
 
-void ImageWrapper::CreateImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags useFlags, VkMemoryPropertyFlags propFlags) {
+VkFormat ImageWrapper::GetFormat() {
+	return mFormat;
+}
+
+uint32_t ImageWrapper::GetWidth() {
+	return mWidth;
+}
+
+uint32_t ImageWrapper::GetHeight() {
+	return mHeight;
+}
+
+uint32_t ImageWrapper::GetMipLevels() {
+	return mMipLevels;
+}
+
+uint32_t ImageWrapper::GetMemoryTypeIndex() {
+	return mImageAllocation.mMemoryTypeIndex;
+}
+
+void ImageWrapper::CreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags useFlags, VkMemoryPropertyFlags propFlags) {
+	mFormat = format;
+	mWidth = width;
+	mHeight = height;
+	mMipLevels = mipLevels;
+
 	VkImageCreateInfo imageCI = {
 		.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
 		.pNext = nullptr,
@@ -35,7 +61,7 @@ void ImageWrapper::CreateImage(uint32_t width, uint32_t height, VkFormat format,
 			.height = height,
 			.depth = 1
 		},
-		.mipLevels = 1,
+		.mipLevels = mipLevels,
 		.arrayLayers = 1,
 		.samples = VK_SAMPLE_COUNT_1_BIT,
 		.tiling = tiling,
@@ -56,41 +82,48 @@ void ImageWrapper::CreateImage(uint32_t width, uint32_t height, VkFormat format,
 	VkMemoryRequirements memoryRequirements;
 	vkGetImageMemoryRequirements(mLogicalDevice->GetLogicalDevice(), mImage, &memoryRequirements);
 
-	VkMemoryAllocateInfo memoryAI = {
-		.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-		.pNext = nullptr,
-		.allocationSize = memoryRequirements.size,
-		.memoryTypeIndex = FindMemoryTypeIndex(mPhysicalDevice->GetPhysicalDevice(), memoryRequirements.memoryTypeBits, propFlags)
-	};
+	uint32_t memoryTypeIndex = mPhysicalDevice->FindMemoryTypeIndex(memoryRequirements.memoryTypeBits, { propFlags, 0, 0 });
+	mImageAllocation = mLogicalDevice->GetMemoryAllocator()->Allocate(memoryRequirements, memoryTypeIndex, tiling == VK_IMAGE_TILING_LINEAR);
+	std::cout << "Success: Image Memory allocated. (type " << memoryTypeIndex << ": " << NT_MEMORY_PROPERTY_STRING(mPhysicalDevice->GetPhysicalDeviceMemoryProperties().memoryTypes[memoryTypeIndex].propertyFlags) << ")" << std::endl;
 
-	result = vkAllocateMemory(mLogicalDevice->GetLogicalDevice(), &memoryAI, nullptr, &mImageMemory);
-	if (result == VK_SUCCESS) {
-		std::cout << "Success: Image Memory allocated." << std::endl;
-	} else {
-		throw std::runtime_error("Failed to allocate image memory! Error Code: " + NT_CHECK_RESULT(result));
+	result = vkBindImageMemory(mLogicalDevice->GetLogicalDevice(), mImage, mImageAllocation.mMemory, mImageAllocation.mOffset);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to bind image memory! Error Code: " + NT_CHECK_RESULT(result));
 	}
-
-	vkBindImageMemory(mLogicalDevice->GetLogicalDevice(), mImage, mImageMemory, 0);
 }
 
-void ImageWrapper::CreateTextureImage(std::string filename) {
+void ImageWrapper::CreateTextureImage(UploadContext* upload, std::string filename) {
 	int width, height;
 	VkDeviceSize imageSize;
 	stbi_uc* imageData = LoadTextureFile(filename, &width, &height, &imageSize);
 
-	BufferWrapper stagingBuffer(mPhysicalDevice, mLogicalDevice, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	uint32_t mipLevels = CalculateMipLevels(width, height, VK_FORMAT_R8G8B8A8_UNORM);
 
-	stagingBuffer.MapBufferMemory(imageData, imageSize);
+	// TRANSFER_SRC is needed since every mip level is blitted from the one above it
+	CreateImage(width, height, mipLevels, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+	// The pixels are copied into staging memory right away, so the file data can be freed before the batch is submitted
+	upload->UploadImage(this, imageData, imageSize, width, height);
 
 	stbi_image_free(imageData);
+}
 
-	CreateImage(width, height, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+/*
 
-	TransitionImageLayout(mLogicalDevice, mGraphicsCommandPool, this, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	Full chain down to 1x1, or a single level if the format can't be linearly blitted with optimal tiling.
 
-	CopyImageBuffer(mLogicalDevice, mGraphicsCommandPool, &stagingBuffer, this, width, height);
+*/
+uint32_t ImageWrapper::CalculateMipLevels(uint32_t width, uint32_t height, VkFormat format) {
+	VkFormatProperties formatProperties;
+	vkGetPhysicalDeviceFormatProperties(mPhysicalDevice->GetPhysicalDevice(), format, &formatProperties);
 
-	TransitionImageLayout(mLogicalDevice, mGraphicsCommandPool, this, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	const VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	if ((formatProperties.optimalTilingFeatures & blitFeatures) != blitFeatures) {
+		std::cout << "Warning: Format does not support linear blits. Texture will not have mip levels." << std::endl;
+		return 1;
+	}
+
+	return (uint32_t)std::floor(std::log2(std::max(width, height))) + 1;
 }
 
 stbi_uc* LoadTextureFile(std::string filename, int* width, int* height, VkDeviceSize* imageSize) {
@@ -107,26 +140,9 @@ stbi_uc* LoadTextureFile(std::string filename, int* width, int* height, VkDevice
 	return image;
 }
 
-void CopyImageBuffer(LogicalDeviceWrapper* lDevice, CommandPoolWrapper* tPool, BufferWrapper* srcBuffer, ImageWrapper* dstImage, uint32_t width, uint32_t height) {
-	// Create Transfer Command Buffer
-	CommandBufferWrapper* transferCommandBuffer = new CommandBufferWrapper(lDevice, tPool);
-
-	// Begin Recording Transfer Command Buffer struct
-	VkCommandBufferBeginInfo commandBufferBI = {
-		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-		.pNext = nullptr,
-		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-		.pInheritanceInfo = nullptr
-	};
-
-	// Begin Recording Transfer Command Buffer
-	VkResult result = vkBeginCommandBuffer(transferCommandBuffer->GetCommandBuffer(), &commandBufferBI);
-	if (result != VK_SUCCESS) {
-		throw std::runtime_error("Failed to begin recording transfer command buffer! Error Code: " + NT_CHECK_RESULT(result));
-	}
-
+void RecordCopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkDeviceSize srcOffset, ImageWrapper* dstImage, uint32_t width, uint32_t height) {
 	VkBufferImageCopy imageRegion = {
-		.bufferOffset = 0,
+		.bufferOffset = srcOffset,
 		.bufferRowLength = 0,
 		.bufferImageHeight = 0,
 		.imageSubresource = {
@@ -147,63 +163,16 @@ void CopyImageBuffer(LogicalDeviceWrapper* lDevice, CommandPoolWrapper* tPool, B
 		}
 	};
 
-	vkCmdCopyBufferToImage(transferCommandBuffer->GetCommandBuffer(), srcBuffer->GetBuffer(), dstImage->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageRegion);
-
-	result = vkEndCommandBuffer(transferCommandBuffer->GetCommandBuffer());
-	if (result != VK_SUCCESS) {
-		throw std::runtime_error("Failed to end recording transfer command buffer! Error Code: " + NT_CHECK_RESULT(result));
-	}
-
-	// Submit Transfer Command Buffer struct
-	VkCommandBuffer buffer = transferCommandBuffer->GetCommandBuffer();
-	VkSubmitInfo submitInfo = {
-		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-		.pNext = nullptr,
-		.waitSemaphoreCount = 0,
-		.pWaitSemaphores = nullptr,
-		.pWaitDstStageMask = nullptr,
-		.commandBufferCount = 1,
-		.pCommandBuffers = &buffer,
-		.signalSemaphoreCount = 0,
-		.pSignalSemaphores = nullptr
-	};
-
-	// Submit Transfer Command Buffer
-	result = vkQueueSubmit(lDevice->GetGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-	if (result != VK_SUCCESS) {
-		throw std::runtime_error("Failed to submit copy command to queue! Error Code: " + NT_CHECK_RESULT(result));
-	}
-
-	// Wait for Transfer Queue to finish
-	result = vkQueueWaitIdle(lDevice->GetGraphicsQueue());
-	if (result == VK_SUCCESS) {
-		std::cout << "Success: Data transferred." << std::endl;
-	} else {
-		throw std::runtime_error("Failed to wait for transfer queue! Error Code: " + NT_CHECK_RESULT(result));
-	}
-
-	// Free Transfer Command Buffer
-	vkFreeCommandBuffers(lDevice->GetLogicalDevice(), tPool->GetCommandPool(), 1, &buffer);
+	vkCmdCopyBufferToImage(commandBuffer, srcBuffer, dstImage->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageRegion);
 }
 
-void TransitionImageLayout(LogicalDeviceWrapper* lDevice, CommandPoolWrapper* tPool, ImageWrapper* image, VkImageLayout oldLayout, VkImageLayout newLayout) {
-	// Create Transfer Command Buffer
-	CommandBufferWrapper* transferCommandBuffer = new CommandBufferWrapper(lDevice, tPool);
+/*
 
-	// Begin Recording Transfer Command Buffer struct
-	VkCommandBufferBeginInfo commandBufferBI = {
-		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-		.pNext = nullptr,
-		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-		.pInheritanceInfo = nullptr
-	};
-
-	// Begin Recording Transfer Command Buffer
-	VkResult result = vkBeginCommandBuffer(transferCommandBuffer->GetCommandBuffer(), &commandBufferBI);
-	if (result != VK_SUCCESS) {
-		throw std::runtime_error("Failed to begin recording transfer command buffer! Error Code: " + NT_CHECK_RESULT(result));
-	}
+	Records a layout transition for the given range of mip levels. Only the transitions the upload path
+	needs are supported.
 
+*/
+void RecordTransitionImageLayout(VkCommandBuffer commandBuffer, ImageWrapper* image, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t baseMipLevel, uint32_t levelCount) {
 	VkImageMemoryBarrier imageMemoryBarrier = {
 		.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
 		.pNext = nullptr,
@@ -216,8 +185,8 @@ void TransitionImageLayout(LogicalDeviceWrapper* lDevice, CommandPoolWrapper* tP
 		.image = image->GetImage(),
 		.subresourceRange = {
 			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-			.baseMipLevel = 0,
-			.levelCount = 1,
+			.baseMipLevel = baseMipLevel,
+			.levelCount = levelCount,
 			.baseArrayLayer = 0,
 			.layerCount = 1
 		}
@@ -231,16 +200,30 @@ void TransitionImageLayout(LogicalDeviceWrapper* lDevice, CommandPoolWrapper* tP
 
 		srcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
 		dstStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	} else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
+		imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+		srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		dstStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	} else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+		imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
 	} else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
 		imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
 		imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
 		srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
 		dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	} else {
+		throw std::runtime_error("Unsupported image layout transition!");
 	}
 
 	vkCmdPipelineBarrier(
-		transferCommandBuffer->GetCommandBuffer(),
+		commandBuffer,
 		srcStage,
 		dstStage,
 		0,
@@ -251,40 +234,50 @@ void TransitionImageLayout(LogicalDeviceWrapper* lDevice, CommandPoolWrapper* tP
 		1,
 		&imageMemoryBarrier
 	);
+}
 
-	result = vkEndCommandBuffer(transferCommandBuffer->GetCommandBuffer());
-	if (result != VK_SUCCESS) {
-		throw std::runtime_error("Failed to end recording transfer command buffer! Error Code: " + NT_CHECK_RESULT(result));
-	}
-
-	// Submit Transfer Command Buffer struct
-	VkCommandBuffer buffer = transferCommandBuffer->GetCommandBuffer();
-	VkSubmitInfo submitInfo = {
-		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-		.pNext = nullptr,
-		.waitSemaphoreCount = 0,
-		.pWaitSemaphores = nullptr,
-		.pWaitDstStageMask = nullptr,
-		.commandBufferCount = 1,
-		.pCommandBuffers = &buffer,
-		.signalSemaphoreCount = 0,
-		.pSignalSemaphores = nullptr
-	};
-
-	// Submit Transfer Command Buffer
-	result = vkQueueSubmit(lDevice->GetGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-	if (result != VK_SUCCESS) {
-		throw std::runtime_error("Failed to submit copy command to queue! Error Code: " + NT_CHECK_RESULT(result));
-	}
-
-	// Wait for Transfer Queue to finish
-	result = vkQueueWaitIdle(lDevice->GetGraphicsQueue());
-	if (result == VK_SUCCESS) {
-		std::cout << "Success: Data transferred." << std::endl;
-	} else {
-		throw std::runtime_error("Failed to wait for transfer queue! Error Code: " + NT_CHECK_RESULT(result));
+/*
+
+	Expects every mip level in TRANSFER_DST_OPTIMAL with level 0 already filled in. Each level is blitted
+	down from the one above it, and a level is moved to SHADER_READ_ONLY_OPTIMAL as soon as it has been
+	read from for the last time. The whole image ends up in SHADER_READ_ONLY_OPTIMAL.
+
+*/
+void RecordGenerateMipmaps(VkCommandBuffer commandBuffer, ImageWrapper* image) {
+	int32_t mipWidth = (int32_t)image->GetWidth();
+	int32_t mipHeight = (int32_t)image->GetHeight();
+
+	for (uint32_t i = 1; i < image->GetMipLevels(); i++) {
+		RecordTransitionImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, i - 1, 1);
+
+		int32_t nextWidth = mipWidth > 1 ? mipWidth / 2 : 1;
+		int32_t nextHeight = mipHeight > 1 ? mipHeight / 2 : 1;
+
+		VkImageBlit imageBlit = {
+			.srcSubresource = {
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.mipLevel = i - 1,
+				.baseArrayLayer = 0,
+				.layerCount = 1
+			},
+			.srcOffsets = { { 0, 0, 0 }, { mipWidth, mipHeight, 1 } },
+			.dstSubresource = {
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.mipLevel = i,
+				.baseArrayLayer = 0,
+				.layerCount = 1
+			},
+			.dstOffsets = { { 0, 0, 0 }, { nextWidth, nextHeight, 1 } }
+		};
+
+		vkCmdBlitImage(commandBuffer, image->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageBlit, VK_FILTER_LINEAR);
+
+		RecordTransitionImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, i - 1, 1);
+
+		mipWidth = nextWidth;
+		mipHeight = nextHeight;
 	}
 
-	// Free Transfer Command Buffer
-	vkFreeCommandBuffers(lDevice->GetLogicalDevice(), tPool->GetCommandPool(), 1, &buffer);
+	// The last level is never blitted from
+	RecordTransitionImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, image->GetMipLevels() - 1, 1);
 }
\ No newline at end of file
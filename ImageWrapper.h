@@ -4,41 +4,53 @@
 #include "stb_image.h"
 #include <vulkan/vulkan.h>
 #include <string>
+#include "MemoryAllocator.h"
 
 class LogicalDeviceWrapper;
 class PhysicalDeviceWrapper;
-class CommandPoolWrapper;
-class BufferWrapper;
+class UploadContext;
 
 /*
 
-	Note: There is a problem with the CopyImageBuffer / TransitionImageLayout functions that I fixed
-	in a hacky way once again. The queues and command pools are getting mixed up in the parameters.
-	Need to sort that out at some point in time. As of now, just using the graphics queue works since
-	it is all purpose. But should really fix it later.
+	Note: Textures are uploaded through the UploadContext. The RecordXxx() helpers below only record
+	into a command buffer, so the copy and both layout transitions of a texture end up in the same
+	upload batch as everything else instead of three blocking submits on the graphics queue.
+
+	Note: Textures get a full mip chain that is generated on the GPU with vkCmdBlitImage, as long as the
+	format supports linear filtering with optimal tiling. Otherwise they stay at a single level.
 
 */
 
 class ImageWrapper {
 public:
-	ImageWrapper(PhysicalDeviceWrapper*, LogicalDeviceWrapper*, CommandPoolWrapper*, uint32_t, uint32_t, VkFormat, VkImageTiling, VkImageUsageFlags, VkMemoryPropertyFlags);
-	ImageWrapper(PhysicalDeviceWrapper*, LogicalDeviceWrapper*, CommandPoolWrapper*, std::string);
+	ImageWrapper(PhysicalDeviceWrapper*, LogicalDeviceWrapper*, uint32_t, uint32_t, VkFormat, VkImageTiling, VkImageUsageFlags, VkMemoryPropertyFlags);
+	ImageWrapper(PhysicalDeviceWrapper*, LogicalDeviceWrapper*, UploadContext*, std::string);
 	~ImageWrapper();
 
 	VkImage GetImage();
+	VkFormat GetFormat();
+	uint32_t GetWidth();
+	uint32_t GetHeight();
+	uint32_t GetMipLevels();
+	uint32_t GetMemoryTypeIndex();
 private:
-	void CreateImage(uint32_t, uint32_t, VkFormat, VkImageTiling, VkImageUsageFlags, VkMemoryPropertyFlags);
-	void CreateTextureImage(std::string filename);
+	void CreateImage(uint32_t, uint32_t, uint32_t, VkFormat, VkImageTiling, VkImageUsageFlags, VkMemoryPropertyFlags);
+	uint32_t CalculateMipLevels(uint32_t, uint32_t, VkFormat);
+	void CreateTextureImage(UploadContext*, std::string filename);
 
 	VkImage mImage;
-	VkDeviceMemory mImageMemory;
+	VkFormat mFormat;
+	uint32_t mWidth;
+	uint32_t mHeight;
+	uint32_t mMipLevels;
+	MemoryAllocation mImageAllocation;
 
 	PhysicalDeviceWrapper* mPhysicalDevice;
 	LogicalDeviceWrapper* mLogicalDevice;
-	CommandPoolWrapper* mGraphicsCommandPool;
 };
 
 stbi_uc* LoadTextureFile(std::string filename, int* width, int* height, VkDeviceSize* imageSize);
-void CopyImageBuffer(LogicalDeviceWrapper*, CommandPoolWrapper*, BufferWrapper*, ImageWrapper*, uint32_t, uint32_t);
-void TransitionImageLayout(LogicalDeviceWrapper*, CommandPoolWrapper*, ImageWrapper*, VkImageLayout, VkImageLayout);
+void RecordCopyBufferToImage(VkCommandBuffer, VkBuffer, VkDeviceSize, ImageWrapper*, uint32_t, uint32_t);
+void RecordTransitionImageLayout(VkCommandBuffer, ImageWrapper*, VkImageLayout, VkImageLayout, uint32_t, uint32_t);
+void RecordGenerateMipmaps(VkCommandBuffer, ImageWrapper*);
 #endif
\ No newline at end of file
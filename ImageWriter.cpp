@@ -0,0 +1,138 @@
+#include "ImageWriter.h"
+
+#include <fstream>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+#include <cctype>
+
+static uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+	static uint32_t table[256];
+	static bool tableReady = false;
+	if (!tableReady) {
+		for (uint32_t i = 0; i < 256; i++) {
+			uint32_t c = i;
+			for (int k = 0; k < 8; k++) {
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			}
+			table[i] = c;
+		}
+		tableReady = true;
+	}
+
+	crc = ~crc;
+	for (size_t i = 0; i < size; i++) {
+		crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+static void AppendBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+	out.push_back((uint8_t)(value >> 24));
+	out.push_back((uint8_t)(value >> 16));
+	out.push_back((uint8_t)(value >> 8));
+	out.push_back((uint8_t)value);
+}
+
+static void AppendChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) {
+	AppendBigEndian(out, (uint32_t)data.size());
+	size_t typeStart = out.size();
+	out.insert(out.end(), type, type + 4);
+	out.insert(out.end(), data.begin(), data.end());
+	AppendBigEndian(out, Crc32(out.data() + typeStart, out.size() - typeStart));
+}
+
+void WritePPM(const std::string& path, const uint8_t* pixels, uint32_t width, uint32_t height) {
+	std::ofstream file(path, std::ios::binary);
+	if (!file.is_open()) {
+		throw std::runtime_error("Failed to open " + path + " for writing!");
+	}
+
+	file << "P6\n" << width << " " << height << "\n255\n";
+	std::vector<uint8_t> row(width * 3);
+	for (uint32_t y = 0; y < height; y++) {
+		const uint8_t* src = pixels + (size_t)y * width * 4;
+		for (uint32_t x = 0; x < width; x++) {
+			row[x * 3 + 0] = src[x * 4 + 0];
+			row[x * 3 + 1] = src[x * 4 + 1];
+			row[x * 3 + 2] = src[x * 4 + 2];
+		}
+		file.write((const char*)row.data(), row.size());
+	}
+
+	if (!file) {
+		throw std::runtime_error("Failed to write " + path + "!");
+	}
+}
+
+void WritePNG(const std::string& path, const uint8_t* pixels, uint32_t width, uint32_t height) {
+	// Raw scanlines, each prefixed with filter type 0 (none)
+	size_t stride = (size_t)width * 4;
+	std::vector<uint8_t> raw;
+	raw.reserve((stride + 1) * height);
+	for (uint32_t y = 0; y < height; y++) {
+		raw.push_back(0);
+		raw.insert(raw.end(), pixels + y * stride, pixels + (y + 1) * stride);
+	}
+
+	// zlib stream made of stored deflate blocks, at most 65535 bytes each
+	std::vector<uint8_t> zlib = { 0x78, 0x01 };
+	size_t offset = 0;
+	do {
+		uint16_t blockSize = (uint16_t)std::min<size_t>(raw.size() - offset, 65535);
+		bool last = offset + blockSize == raw.size();
+		zlib.push_back(last ? 1 : 0);
+		zlib.push_back((uint8_t)(blockSize & 0xFF));
+		zlib.push_back((uint8_t)(blockSize >> 8));
+		zlib.push_back((uint8_t)(~blockSize & 0xFF));
+		zlib.push_back((uint8_t)((~blockSize >> 8) & 0xFF));
+		zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+		offset += blockSize;
+	} while (offset < raw.size());
+
+	uint32_t a = 1, b = 0;
+	for (size_t i = 0; i < raw.size(); i++) {
+		a = (a + raw[i]) % 65521;
+		b = (b + a) % 65521;
+	}
+	AppendBigEndian(zlib, (b << 16) | a);
+
+	std::vector<uint8_t> header;
+	AppendBigEndian(header, width);
+	AppendBigEndian(header, height);
+	header.push_back(8);	// Bit depth
+	header.push_back(6);	// Color type RGBA
+	header.push_back(0);	// Compression
+	header.push_back(0);	// Filter
+	header.push_back(0);	// Interlace
+
+	std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	AppendChunk(png, "IHDR", header);
+	AppendChunk(png, "IDAT", zlib);
+	AppendChunk(png, "IEND", {});
+
+	std::ofstream file(path, std::ios::binary);
+	if (!file.is_open()) {
+		throw std::runtime_error("Failed to open " + path + " for writing!");
+	}
+	file.write((const char*)png.data(), png.size());
+	if (!file) {
+		throw std::runtime_error("Failed to write " + path + "!");
+	}
+}
+
+void WriteImage(const std::string& path, const uint8_t* pixels, uint32_t width, uint32_t height) {
+	size_t dot = path.find_last_of('.');
+	std::string extension = dot == std::string::npos ? "" : path.substr(dot + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+	if (extension == "png") {
+		WritePNG(path, pixels, width, height);
+	}
+	else if (extension == "ppm") {
+		WritePPM(path, pixels, width, height);
+	}
+	else {
+		throw std::runtime_error("Failed to write " + path + "! Unsupported image format, use .png or .ppm");
+	}
+}
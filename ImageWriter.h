@@ -0,0 +1,22 @@
+#ifndef IMAGE_WRITER_H
+#define IMAGE_WRITER_H
+
+#include <string>
+#include <cstdint>
+
+/*
+
+	Small helpers for dumping RGBA8 pixels to disk, used by the headless backend.
+
+	Notes:
+		- WritePNG writes uncompressed (stored) deflate blocks. The files are bigger than they need to be
+		  but it keeps the renderer free of an image encoding dependency, stb_image only decodes.
+		- WriteImage picks the format from the extension (.png or .ppm), anything else is an error.
+		- All writers throw on failure like the rest of the renderer.
+
+*/
+
+void WritePPM(const std::string&, const uint8_t*, uint32_t, uint32_t);
+void WritePNG(const std::string&, const uint8_t*, uint32_t, uint32_t);
+void WriteImage(const std::string&, const uint8_t*, uint32_t, uint32_t);
+#endif
@@ -1,12 +1,16 @@
 #include "InstanceWrapper.h"
 #include "globals.h"
 
-InstanceWrapper::InstanceWrapper() {
+InstanceWrapper::InstanceWrapper() : mHeadless(false) {
 	CreateInstance();
 	//OutputInstanceExtensions();
 	//OutputLayers();
 }
 
+InstanceWrapper::InstanceWrapper(bool headless) : mHeadless(headless) {
+	CreateInstance();
+}
+
 InstanceWrapper::~InstanceWrapper() {
 	vkDestroyInstance(mInstance, nullptr); std::cout << "Success: Instance destroyed." << std::endl;
 }
@@ -27,14 +31,16 @@ void InstanceWrapper::CreateInstance() {
 		.apiVersion = VULKAN_API_VERSION
 	};
 
-	// Grab GLFW Extensions
-	uint32_t glfwExtensionCount = 0;
-	const char** glfwExtensions;
-	glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+	// Grab GLFW Extensions, there is no surface to create when headless
+	if (!mHeadless) {
+		uint32_t glfwExtensionCount = 0;
+		const char** glfwExtensions;
+		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 
-	// Push to Instance Level Extensions List
-	for (uint32_t i = 0; i < glfwExtensionCount; i++) {
-		mExtensions.push_back(glfwExtensions[i]);
+		// Push to Instance Level Extensions List
+		for (uint32_t i = 0; i < glfwExtensionCount; i++) {
+			mExtensions.push_back(glfwExtensions[i]);
+		}
 	}
 
 	// Add any extra requested Instance Level Extensions here
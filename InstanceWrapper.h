@@ -12,11 +12,16 @@
 
 	TODO: Add proper Validation Layer handling
 
+	Notes:
+		- A headless instance doesn't ask GLFW for its surface extensions, so it works without a
+		  window system (render nodes, CI with lavapipe).
+
 */
 
 class InstanceWrapper {
 public:
 	InstanceWrapper();
+	InstanceWrapper(bool);
 	~InstanceWrapper();
 
 	VkInstance GetInstance();
@@ -30,6 +35,7 @@ private:
 	bool checkValidationLayerSupport();
 
 	VkInstance mInstance;
+	bool mHeadless;
 	std::vector<const char*> mExtensions;		// Instance Level Extensions List
 };
 #endif
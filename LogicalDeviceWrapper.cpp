@@ -1,12 +1,24 @@
 #include "LogicalDeviceWrapper.h"
 #include "globals.h"
 #include "PhysicalDeviceWrapper.h"
+#include "MemoryAllocator.h"
+#include "SynchronizationWrapper.h"
+#include "PipelineCacheWrapper.h"
 
 LogicalDeviceWrapper::LogicalDeviceWrapper(PhysicalDeviceWrapper* pDevice) : mPhysicalDevice(pDevice) {
 	CreateLogicalDevice();
 }
 
 LogicalDeviceWrapper::~LogicalDeviceWrapper() {
+	delete mPipelineCache;
+	if (mComputeTimeline != mGraphicsTimeline && mComputeTimeline != mTransferTimeline) {
+		delete mComputeTimeline;
+	}
+	if (mTransferTimeline != mGraphicsTimeline) {
+		delete mTransferTimeline;
+	}
+	delete mGraphicsTimeline;
+	delete mMemoryAllocator;
 	vkDestroyDevice(mLogicalDevice, nullptr); std::cout << "Success: Logical Device destroyed." << std::endl;
 }
 
@@ -26,58 +38,97 @@ VkQueue LogicalDeviceWrapper::GetTransferQueue() {
 	return mTransferQueue;
 }
 
+VkQueue LogicalDeviceWrapper::GetComputeQueue() {
+	return mComputeQueue;
+}
+
+TimelineSemaphoreWrapper* LogicalDeviceWrapper::GetGraphicsTimeline() {
+	return mGraphicsTimeline;
+}
+
+TimelineSemaphoreWrapper* LogicalDeviceWrapper::GetTransferTimeline() {
+	return mTransferTimeline;
+}
+
+TimelineSemaphoreWrapper* LogicalDeviceWrapper::GetComputeTimeline() {
+	return mComputeTimeline;
+}
+
+MemoryAllocator* LogicalDeviceWrapper::GetMemoryAllocator() {
+	return mMemoryAllocator;
+}
+
+PipelineCacheWrapper* LogicalDeviceWrapper::GetPipelineCache() {
+	return mPipelineCache;
+}
+
+bool LogicalDeviceWrapper::IsExtensionEnabled(const char* extension) {
+	for (size_t i = 0; i < mExtensions.size(); i++) {
+		if (strcmp(mExtensions.at(i), extension) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
 void LogicalDeviceWrapper::CreateLogicalDevice() {
 	// Describe the queues to be created on the logical device
 	float queuePriority = 1.0f;
-	VkDeviceQueueCreateInfo graphicsQueueCI = { 
-		.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-		.pNext = nullptr,
-		.flags = 0,
-		.queueFamilyIndex = (uint32_t)mPhysicalDevice->GetQueueFamilyIndices().mGraphics,
-		.queueCount = 1,
-		.pQueuePriorities = &queuePriority
-	};
-	VkDeviceQueueCreateInfo presentQueueCI = {
-		.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-		.pNext = nullptr,
-		.flags = 0,
-		.queueFamilyIndex = (uint32_t)mPhysicalDevice->GetQueueFamilyIndices().mPresent,
-		.queueCount = 1,
-		.pQueuePriorities = &queuePriority
-	};
-	VkDeviceQueueCreateInfo transferQueueCI = {
-		.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-		.pNext = nullptr,
-		.flags = 0,
-		.queueFamilyIndex = (uint32_t)mPhysicalDevice->GetQueueFamilyIndices().mTransfer,
-		.queueCount = 1,
-		.pQueuePriorities = &queuePriority
-	};
+	QueueFamilyIndices& indices = mPhysicalDevice->GetQueueFamilyIndices();
+	std::vector<int> families = { indices.mGraphics, indices.mPresent, indices.mTransfer, indices.mCompute };
+
+	// Create an array to pass to deviceCI. A queue family may only show up once.
+	std::vector<VkDeviceQueueCreateInfo> queueCIs;
+	for (size_t i = 0; i < families.size(); i++) {
+		bool duplicate = false;
+		for (size_t j = 0; j < i; j++) {
+			if (families.at(i) == families.at(j)) {
+				duplicate = true;
+				break;
+			}
+		}
+		if (duplicate) {
+			continue;
+		}
 
-	// Create an array to pass to deviceCI
-	std::vector<VkDeviceQueueCreateInfo> queueCIs = { graphicsQueueCI, transferQueueCI };
-	
-	// Check if the present queue is the same as the graphics queue
-	if (mPhysicalDevice->GetQueueFamilyIndices().mGraphics != mPhysicalDevice->GetQueueFamilyIndices().mPresent) {
-		queueCIs.push_back(presentQueueCI);
+		VkDeviceQueueCreateInfo queueCI = {
+			.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.queueFamilyIndex = (uint32_t)families.at(i),
+			.queueCount = 1,
+			.pQueuePriorities = &queuePriority
+		};
+		queueCIs.push_back(queueCI);
+	}
+
+	// Swapchain and friends only make sense with a surface
+	mExtensions = ENABLED_LOGICAL_DEVICE_EXTENSIONS;
+	if (!mPhysicalDevice->IsHeadless()) {
+		mExtensions.insert(mExtensions.end(), PRESENT_LOGICAL_DEVICE_EXTENSIONS.begin(), PRESENT_LOGICAL_DEVICE_EXTENSIONS.end());
 	}
 
 	// Check if the logical device supports all required extensions
 	if (!CheckDeviceExtensionSupport()) {
 		throw std::runtime_error("Failed to create a Logical Device that supports all required extensions!");
 	}
+	for (size_t i = 0; i < OPTIONAL_LOGICAL_DEVICE_EXTENSIONS.size(); i++) {
+		if (IsExtensionAvailable(OPTIONAL_LOGICAL_DEVICE_EXTENSIONS.at(i))) {
+			mExtensions.push_back(OPTIONAL_LOGICAL_DEVICE_EXTENSIONS.at(i));
+		}
+	}
 
 	// Describe the logical device to be created
 	VkDeviceCreateInfo deviceCI = { 
 		.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-		.pNext = nullptr,
+		.pNext = &ENABLED_VULKAN_12_FEATURES,
 		.flags = 0,
 		.queueCreateInfoCount = (uint32_t)queueCIs.size(),
 		.pQueueCreateInfos = queueCIs.data(),
 		.enabledLayerCount = 0,
 		.ppEnabledLayerNames = nullptr,
-		.enabledExtensionCount = (uint32_t)ENABLED_LOGICAL_DEVICE_EXTENSIONS.size(),
-		.ppEnabledExtensionNames = ENABLED_LOGICAL_DEVICE_EXTENSIONS.data(),
+		.enabledExtensionCount = (uint32_t)mExtensions.size(),
+		.ppEnabledExtensionNames = mExtensions.data(),
 		.pEnabledFeatures = &ENABLED_PHYSICAL_DEVICE_FEATURES
 	};
 
@@ -93,6 +144,26 @@ void LogicalDeviceWrapper::CreateLogicalDevice() {
 	vkGetDeviceQueue(mLogicalDevice, mPhysicalDevice->GetQueueFamilyIndices().mGraphics, 0, &mGraphicsQueue);
 	vkGetDeviceQueue(mLogicalDevice, mPhysicalDevice->GetQueueFamilyIndices().mPresent, 0, &mPresentQueue);
 	vkGetDeviceQueue(mLogicalDevice, mPhysicalDevice->GetQueueFamilyIndices().mTransfer, 0, &mTransferQueue);
+	vkGetDeviceQueue(mLogicalDevice, mPhysicalDevice->GetQueueFamilyIndices().mCompute, 0, &mComputeQueue);
+
+	CreateTimelines();
+
+	// Every buffer and image sub-allocates its memory from here
+	mMemoryAllocator = new MemoryAllocator(mPhysicalDevice, this);
+
+	mPipelineCache = new PipelineCacheWrapper(mPhysicalDevice, this, PIPELINE_CACHE_PATH);
+}
+
+void LogicalDeviceWrapper::CreateTimelines() {
+	mGraphicsTimeline = new TimelineSemaphoreWrapper(this, 0);
+	mTransferTimeline = (mTransferQueue == mGraphicsQueue) ? mGraphicsTimeline : new TimelineSemaphoreWrapper(this, 0);
+	if (mComputeQueue == mGraphicsQueue) {
+		mComputeTimeline = mGraphicsTimeline;
+	} else if (mComputeQueue == mTransferQueue) {
+		mComputeTimeline = mTransferTimeline;
+	} else {
+		mComputeTimeline = new TimelineSemaphoreWrapper(this, 0);
+	}
 }
 
 /*
@@ -107,10 +178,10 @@ bool LogicalDeviceWrapper::CheckDeviceExtensionSupport() {
 	std::vector<VkExtensionProperties> availableExtensions(extensionCount);
 	vkEnumerateDeviceExtensionProperties(mPhysicalDevice->GetPhysicalDevice(), nullptr, &extensionCount, availableExtensions.data());
 
-	for (size_t i = 0; i < ENABLED_LOGICAL_DEVICE_EXTENSIONS.size(); i++) {
+	for (size_t i = 0; i < mExtensions.size(); i++) {
 		bool found = false;
 		for (uint32_t j = 0; j < availableExtensions.size(); j++) {
-			if (strcmp(ENABLED_LOGICAL_DEVICE_EXTENSIONS.at(i), availableExtensions.at(j).extensionName) == 0) {
+			if (strcmp(mExtensions.at(i), availableExtensions.at(j).extensionName) == 0) {
 				found = true;
 				break;
 			}
@@ -122,3 +193,18 @@ bool LogicalDeviceWrapper::CheckDeviceExtensionSupport() {
 
 	return true;
 }
+
+bool LogicalDeviceWrapper::IsExtensionAvailable(const char* extension) {
+	uint32_t extensionCount;
+	vkEnumerateDeviceExtensionProperties(mPhysicalDevice->GetPhysicalDevice(), nullptr, &extensionCount, nullptr);
+
+	std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+	vkEnumerateDeviceExtensionProperties(mPhysicalDevice->GetPhysicalDevice(), nullptr, &extensionCount, availableExtensions.data());
+
+	for (uint32_t i = 0; i < availableExtensions.size(); i++) {
+		if (strcmp(extension, availableExtensions.at(i).extensionName) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
@@ -6,6 +6,9 @@
 #include <vector>
 
 class PhysicalDeviceWrapper;
+class MemoryAllocator;
+class TimelineSemaphoreWrapper;
+class PipelineCacheWrapper;
 
 /*
 
@@ -18,6 +21,12 @@ class PhysicalDeviceWrapper;
 		  both initialization and cleanup of the queues are done in the same place, it
 		  would make sense to keep them together. I also think that it would be easier 
 		  to keep track of.
+		- The MemoryAllocator lives here for the same reason. Every buffer and image already
+		  has a pointer to the logical device, so they can all reach the same allocator.
+		- Every queue gets one timeline semaphore. Queues that turn out to be the same VkQueue share
+		  theirs, since the values signalled on one queue have to increase in submission order.
+		- The PipelineCacheWrapper lives here too, every pipeline is created through it. It is saved to
+		  disk when the device is destroyed.
 
 */
 
@@ -30,15 +39,37 @@ public:
 	VkQueue GetGraphicsQueue();
 	VkQueue GetPresentQueue();
 	VkQueue GetTransferQueue();
+	VkQueue GetComputeQueue();
+
+	TimelineSemaphoreWrapper* GetGraphicsTimeline();
+	TimelineSemaphoreWrapper* GetTransferTimeline();
+	TimelineSemaphoreWrapper* GetComputeTimeline();
+
+	MemoryAllocator* GetMemoryAllocator();
+	PipelineCacheWrapper* GetPipelineCache();
+
+	bool IsExtensionEnabled(const char*);
 private:
 	void CreateLogicalDevice();
 
+	void CreateTimelines();
+
 	bool CheckDeviceExtensionSupport();
+	bool IsExtensionAvailable(const char*);
 
 	VkDevice mLogicalDevice;
+	std::vector<const char*> mExtensions;
 	VkQueue mGraphicsQueue;
 	VkQueue mPresentQueue;
 	VkQueue mTransferQueue;
+	VkQueue mComputeQueue;
+
+	TimelineSemaphoreWrapper* mGraphicsTimeline;
+	TimelineSemaphoreWrapper* mTransferTimeline;
+	TimelineSemaphoreWrapper* mComputeTimeline;
+
+	MemoryAllocator* mMemoryAllocator;
+	PipelineCacheWrapper* mPipelineCache;
 
 	PhysicalDeviceWrapper* mPhysicalDevice;
 };
@@ -0,0 +1,245 @@
+#include "MemoryAllocator.h"
+#include "globals.h"
+#include <algorithm>
+#include "PhysicalDeviceWrapper.h"
+#include "LogicalDeviceWrapper.h"
+
+MemoryAllocator::MemoryAllocator(PhysicalDeviceWrapper* pDevice, LogicalDeviceWrapper* lDevice) : mDeviceAllocationCalls(0), mPhysicalDevice(pDevice), mLogicalDevice(lDevice) {
+	VkPhysicalDeviceMemoryProperties memoryProperties = mPhysicalDevice->GetPhysicalDeviceMemoryProperties();
+
+	mBlocks.resize(memoryProperties.memoryTypeCount);
+	mBlockSizes.resize(memoryProperties.memoryTypeCount);
+
+	// Small heaps (integrated GPUs, the 256MB BAR window) get smaller blocks so one block can't eat the whole heap
+	for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+		VkDeviceSize heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[i].heapIndex].size;
+		mBlockSizes.at(i) = std::min(MEMORY_BLOCK_SIZE, heapSize / 8);
+	}
+}
+
+MemoryAllocator::~MemoryAllocator() {
+	for (size_t i = 0; i < mBlocks.size(); i++) {
+		for (size_t j = 0; j < mBlocks.at(i).size(); j++) {
+			if (mBlocks.at(i).at(j)->mAllocationCount != 0) {
+				std::cout << "Warning: Memory block destroyed with " << mBlocks.at(i).at(j)->mAllocationCount << " live allocation(s)." << std::endl;
+			}
+			DestroyBlock(mBlocks.at(i).at(j));
+		}
+		mBlocks.at(i).clear();
+	}
+	std::cout << "Success: Memory Allocator destroyed." << std::endl;
+}
+
+/*
+
+	Finds room for the given requirements in an existing block of the given memory type. If no
+	block has a free range large enough a new block is created. Anything larger than the preferred
+	block size gets a block that is exactly the size of the request.
+
+*/
+MemoryAllocation MemoryAllocator::Allocate(VkMemoryRequirements requirements, uint32_t memoryTypeIndex, bool linear) {
+	MemoryAllocation allocation = { };
+
+	if (memoryTypeIndex >= mBlocks.size()) {
+		throw std::runtime_error("Attempted to allocate memory from an invalid memory type!");
+	}
+
+	std::vector<MemoryBlock*>& blocks = mBlocks.at(memoryTypeIndex);
+	for (size_t i = 0; i < blocks.size(); i++) {
+		if (blocks.at(i)->mLinear != linear) {
+			continue;
+		}
+		if (SubAllocate(blocks.at(i), requirements, allocation)) {
+			return allocation;
+		}
+	}
+
+	MemoryBlock* block = CreateBlock(memoryTypeIndex, std::max(mBlockSizes.at(memoryTypeIndex), requirements.size), linear);
+	blocks.push_back(block);
+
+	if (!SubAllocate(block, requirements, allocation)) {
+		throw std::runtime_error("Failed to sub-allocate from a freshly created memory block!");
+	}
+
+	return allocation;
+}
+
+/*
+
+	Returns the range to its block and merges it with the free ranges on either side. Empty blocks
+	are released back to the driver, except for the last block of each kind so that a burst of
+	allocate / free (staging buffers) doesn't hit vkAllocateMemory every time.
+
+*/
+void MemoryAllocator::Free(MemoryAllocation& allocation) {
+	MemoryBlock* block = allocation.mBlock;
+	if (block == nullptr) {
+		return;
+	}
+
+	VkDeviceSize offset = allocation.mOffset;
+	VkDeviceSize size = allocation.mSize;
+
+	// Merge with the next free range
+	auto next = block->mFreeRanges.lower_bound(offset);
+	if (next != block->mFreeRanges.end() && next->first == offset + size) {
+		size += next->second;
+		next = block->mFreeRanges.erase(next);
+	}
+
+	// Merge with the previous free range
+	if (next != block->mFreeRanges.begin()) {
+		auto previous = std::prev(next);
+		if (previous->first + previous->second == offset) {
+			offset = previous->first;
+			size += previous->second;
+			block->mFreeRanges.erase(previous);
+		}
+	}
+
+	block->mFreeRanges[offset] = size;
+	block->mUsed -= allocation.mSize;
+	block->mAllocationCount--;
+
+	allocation = { };
+
+	if (block->mAllocationCount == 0) {
+		std::vector<MemoryBlock*>& blocks = mBlocks.at(block->mMemoryTypeIndex);
+
+		size_t sameKind = 0;
+		for (size_t i = 0; i < blocks.size(); i++) {
+			if (blocks.at(i)->mLinear == block->mLinear) {
+				sameKind++;
+			}
+		}
+
+		if (sameKind > 1 || block->mSize > mBlockSizes.at(block->mMemoryTypeIndex)) {
+			blocks.erase(std::find(blocks.begin(), blocks.end(), block));
+			DestroyBlock(block);
+		}
+	}
+}
+
+MemoryAllocatorStats MemoryAllocator::GetStats() {
+	MemoryAllocatorStats stats = { };
+	VkDeviceSize totalFree = 0;
+
+	for (size_t i = 0; i < mBlocks.size(); i++) {
+		for (MemoryBlock* block : mBlocks.at(i)) {
+			stats.mBlockCount++;
+			stats.mAllocationCount += block->mAllocationCount;
+			stats.mBytesAllocated += block->mSize;
+			stats.mBytesUsed += block->mUsed;
+
+			for (auto& range : block->mFreeRanges) {
+				totalFree += range.second;
+				stats.mLargestFreeRange = std::max(stats.mLargestFreeRange, range.second);
+			}
+		}
+	}
+
+	stats.mDeviceAllocationCalls = mDeviceAllocationCalls;
+	stats.mFragmentation = totalFree == 0 ? 0.0f : 1.0f - (float)stats.mLargestFreeRange / (float)totalFree;
+
+	return stats;
+}
+
+void MemoryAllocator::PrintStats() {
+	MemoryAllocatorStats stats = GetStats();
+
+	std::cout << "Memory Allocator Stats:" << std::endl;
+	std::cout << "\tDevice Memory Blocks: " << stats.mBlockCount << " (" << stats.mBytesAllocated / (1024 * 1024) << " MiB)" << std::endl;
+	std::cout << "\tSub-allocations: " << stats.mAllocationCount << std::endl;
+	std::cout << "\tBytes Used: " << stats.mBytesUsed << " / " << stats.mBytesAllocated << std::endl;
+	std::cout << "\tLargest Free Range: " << stats.mLargestFreeRange << std::endl;
+	std::cout << "\tFragmentation: " << stats.mFragmentation * 100.0f << "%" << std::endl;
+	std::cout << "\tvkAllocateMemory Calls: " << stats.mDeviceAllocationCalls << std::endl;
+}
+
+MemoryBlock* MemoryAllocator::CreateBlock(uint32_t memoryTypeIndex, VkDeviceSize size, bool linear) {
+	MemoryBlock* block = new MemoryBlock();
+	block->mSize = size;
+	block->mUsed = 0;
+	block->mMemoryTypeIndex = memoryTypeIndex;
+	block->mAllocationCount = 0;
+	block->mLinear = linear;
+	block->mMapped = nullptr;
+	block->mFreeRanges[0] = size;
+
+	VkMemoryAllocateInfo memoryAI = {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		.pNext = nullptr,
+		.allocationSize = size,
+		.memoryTypeIndex = memoryTypeIndex
+	};
+
+	VkResult result = vkAllocateMemory(mLogicalDevice->GetLogicalDevice(), &memoryAI, nullptr, &block->mMemory);
+	if (result == VK_SUCCESS) {
+		std::cout << "Success: Memory Block allocated. (" << size << " bytes, type " << memoryTypeIndex << ")" << std::endl;
+	} else {
+		delete block;
+		throw std::runtime_error("Failed to allocate Memory Block! Error Code: " + NT_CHECK_RESULT(result));
+	}
+	mDeviceAllocationCalls++;
+
+	// Host visible blocks stay mapped for their whole lifetime
+	VkMemoryPropertyFlags propertyFlags = mPhysicalDevice->GetPhysicalDeviceMemoryProperties().memoryTypes[memoryTypeIndex].propertyFlags;
+	if (propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+		result = vkMapMemory(mLogicalDevice->GetLogicalDevice(), block->mMemory, 0, VK_WHOLE_SIZE, 0, &block->mMapped);
+		if (result != VK_SUCCESS) {
+			throw std::runtime_error("Failed to map Memory Block! Error Code: " + NT_CHECK_RESULT(result));
+		}
+	}
+
+	return block;
+}
+
+void MemoryAllocator::DestroyBlock(MemoryBlock* block) {
+	if (block->mMapped != nullptr) {
+		vkUnmapMemory(mLogicalDevice->GetLogicalDevice(), block->mMemory);
+	}
+	vkFreeMemory(mLogicalDevice->GetLogicalDevice(), block->mMemory, nullptr); std::cout << "Success: Memory Block freed." << std::endl;
+	delete block;
+}
+
+/*
+
+	First fit search through the free ranges of a block. Alignment padding in front of the
+	allocation is put back into the free list so it isn't lost.
+
+*/
+bool MemoryAllocator::SubAllocate(MemoryBlock* block, VkMemoryRequirements requirements, MemoryAllocation& allocation) {
+	VkDeviceSize alignment = std::max(requirements.alignment, (VkDeviceSize)1);
+
+	for (auto range = block->mFreeRanges.begin(); range != block->mFreeRanges.end(); range++) {
+		VkDeviceSize rangeStart = range->first;
+		VkDeviceSize rangeEnd = range->first + range->second;
+		VkDeviceSize alignedOffset = (rangeStart + alignment - 1) / alignment * alignment;
+
+		if (alignedOffset + requirements.size > rangeEnd) {
+			continue;
+		}
+
+		block->mFreeRanges.erase(range);
+		if (alignedOffset > rangeStart) {
+			block->mFreeRanges[rangeStart] = alignedOffset - rangeStart;
+		}
+		if (alignedOffset + requirements.size < rangeEnd) {
+			block->mFreeRanges[alignedOffset + requirements.size] = rangeEnd - (alignedOffset + requirements.size);
+		}
+
+		block->mUsed += requirements.size;
+		block->mAllocationCount++;
+
+		allocation.mBlock = block;
+		allocation.mMemory = block->mMemory;
+		allocation.mOffset = alignedOffset;
+		allocation.mSize = requirements.size;
+		allocation.mMemoryTypeIndex = block->mMemoryTypeIndex;
+		allocation.mMapped = block->mMapped == nullptr ? nullptr : (char*)block->mMapped + alignedOffset;
+
+		return true;
+	}
+
+	return false;
+}
@@ -0,0 +1,80 @@
+#ifndef MEMORY_ALLOCATOR_H
+#define MEMORY_ALLOCATOR_H
+
+#include <vulkan/vulkan.h>
+#include <map>
+#include <vector>
+
+class PhysicalDeviceWrapper;
+class LogicalDeviceWrapper;
+
+/*
+
+	MemoryAllocator hands out sub-ranges of large VkDeviceMemory blocks instead of calling
+	vkAllocateMemory for every buffer and image. Blocks are kept per memory type and every block
+	tracks its free ranges in an offset ordered map, so neighbouring ranges can be merged on free.
+
+	Notes:
+		- Linear resources (buffers) and optimal tiled images never share a block. That way we
+		  never have to think about bufferImageGranularity.
+		- Host visible blocks are mapped once when they are created and stay mapped until they are
+		  destroyed. vkMapMemory can't be called twice on the same VkDeviceMemory, so anything that
+		  wants to write into a sub-allocation has to go through MemoryAllocation::mMapped.
+		- Requests bigger than the block size get a dedicated block of their own.
+
+*/
+
+struct MemoryBlock {
+	VkDeviceMemory mMemory;
+	VkDeviceSize mSize;
+	VkDeviceSize mUsed;
+	uint32_t mMemoryTypeIndex;
+	uint32_t mAllocationCount;
+	bool mLinear;
+	void* mMapped;
+	std::map<VkDeviceSize, VkDeviceSize> mFreeRanges;		// offset -> size
+};
+
+struct MemoryAllocation {
+	MemoryBlock* mBlock = nullptr;
+	VkDeviceMemory mMemory = VK_NULL_HANDLE;
+	VkDeviceSize mOffset = 0;
+	VkDeviceSize mSize = 0;
+	uint32_t mMemoryTypeIndex = UINT32_MAX;
+	void* mMapped = nullptr;
+};
+
+struct MemoryAllocatorStats {
+	uint32_t mBlockCount = 0;
+	uint32_t mAllocationCount = 0;
+	uint64_t mDeviceAllocationCalls = 0;
+	VkDeviceSize mBytesAllocated = 0;						// Sum of all block sizes
+	VkDeviceSize mBytesUsed = 0;							// Sum of all live sub-allocations
+	VkDeviceSize mLargestFreeRange = 0;
+	float mFragmentation = 0.0f;							// 1 - (largest free range / total free bytes)
+};
+
+class MemoryAllocator {
+public:
+	MemoryAllocator(PhysicalDeviceWrapper*, LogicalDeviceWrapper*);
+	~MemoryAllocator();
+
+	MemoryAllocation Allocate(VkMemoryRequirements, uint32_t, bool);
+	void Free(MemoryAllocation&);
+
+	MemoryAllocatorStats GetStats();
+	void PrintStats();
+private:
+	MemoryBlock* CreateBlock(uint32_t, VkDeviceSize, bool);
+	void DestroyBlock(MemoryBlock*);
+	bool SubAllocate(MemoryBlock*, VkMemoryRequirements, MemoryAllocation&);
+
+	std::vector<std::vector<MemoryBlock*>> mBlocks;			// Indexed by memory type index
+	std::vector<VkDeviceSize> mBlockSizes;					// Preferred block size per memory type index
+	uint64_t mDeviceAllocationCalls;
+
+	PhysicalDeviceWrapper* mPhysicalDevice;
+	LogicalDeviceWrapper* mLogicalDevice;
+};
+
+#endif
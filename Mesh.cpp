@@ -2,19 +2,42 @@
 #include "globals.h"
 #include "PhysicalDeviceWrapper.h"
 #include "LogicalDeviceWrapper.h"
-#include "CommandPoolWrapper.h"
+#include "UploadContext.h"
 #include "BufferWrapper.h"
 
-Mesh::Mesh(PhysicalDeviceWrapper* pDevice, LogicalDeviceWrapper* lDevice, CommandPoolWrapper* tPool, std::vector<Vertex>* vertices, std::vector<uint32_t>* indices) : mPhysicalDevice(pDevice), mLogicalDevice(lDevice), mTransferCommandPool(tPool) {
-	CreateVertexBuffer(vertices);
-	CreateIndexBuffer(indices);
+Mesh::Mesh(PhysicalDeviceWrapper* pDevice, LogicalDeviceWrapper* lDevice, UploadContext* upload, std::vector<Vertex>* vertices, std::vector<uint32_t>* indices) : mTexID(-1), mPhysicalDevice(pDevice), mLogicalDevice(lDevice), mUploadContext(upload) {
+	CreateVertexBuffer(vertices->data(), (uint32_t)vertices->size());
+	CreateIndexBuffer(indices->data(), (uint32_t)indices->size());
+	CreateSingleSubmesh(vertices, -1);
 	mModel = glm::mat4(1.0f);
+	mVisible = true;
+	SetPipelineState(DefaultPipelineState());
 }
 
-Mesh::Mesh(PhysicalDeviceWrapper* pDevice, LogicalDeviceWrapper* lDevice, CommandPoolWrapper* tPool, std::vector<Vertex>* vertices, std::vector<uint32_t>* indices, int texID) : mPhysicalDevice(pDevice), mLogicalDevice(lDevice), mTransferCommandPool(tPool), mTexID(texID) {
-	CreateVertexBuffer(vertices);
-	CreateIndexBuffer(indices);
+Mesh::Mesh(PhysicalDeviceWrapper* pDevice, LogicalDeviceWrapper* lDevice, UploadContext* upload, std::vector<Vertex>* vertices, std::vector<uint32_t>* indices, int texID) : mTexID(texID), mPhysicalDevice(pDevice), mLogicalDevice(lDevice), mUploadContext(upload) {
+	CreateVertexBuffer(vertices->data(), (uint32_t)vertices->size());
+	CreateIndexBuffer(indices->data(), (uint32_t)indices->size());
+	CreateSingleSubmesh(vertices, texID);
 	mModel = glm::mat4(1.0f);
+	mVisible = true;
+	SetPipelineState(DefaultPipelineState());
+}
+
+/*
+
+	A mesh made of the given submeshes, all of them drawn out of one vertex and one index buffer.
+
+*/
+Mesh::Mesh(PhysicalDeviceWrapper* pDevice, LogicalDeviceWrapper* lDevice, UploadContext* upload, const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, std::vector<Submesh> submeshes) : mSubmeshes(submeshes), mPhysicalDevice(pDevice), mLogicalDevice(lDevice), mUploadContext(upload) {
+	if (mSubmeshes.empty()) {
+		throw std::runtime_error("Failed to create Mesh! It has no submeshes.");
+	}
+	mTexID = mSubmeshes.at(0).mTexID;
+	CreateVertexBuffer(vertices, vertexCount);
+	CreateIndexBuffer(indices, indexCount);
+	mModel = glm::mat4(1.0f);
+	mVisible = true;
+	SetPipelineState(DefaultPipelineState());
 }
 
 Mesh::~Mesh() {
@@ -30,6 +53,41 @@ void Mesh::SetModel(glm::mat4 model) {
 	mModel = model;
 }
 
+bool Mesh::IsVisible() {
+	return mVisible;
+}
+
+void Mesh::SetVisible(bool visible) {
+	mVisible = visible;
+}
+
+// The state as it was set, compare against this
+PipelineStateDescription Mesh::GetPipelineState() {
+	return mPipelineState;
+}
+
+/*
+
+	The state the mesh is drawn with. USE_TEXTURE always follows the mesh's texture, a material can't turn
+	sampling on for a mesh that has nothing bound to sample from. Derived here instead of stored, so
+	GetPipelineState() still compares equal to whatever was passed to SetPipelineState().
+
+*/
+PipelineStateDescription Mesh::GetDrawPipelineState() {
+	bool textured = true;
+	for (size_t i = 0; i < mSubmeshes.size(); i++) {
+		textured = textured && mSubmeshes.at(i).mTexID >= 0;
+	}
+
+	PipelineStateDescription state = mPipelineState;
+	state.mSpecialization[SPEC_USE_TEXTURE] = textured ? VK_TRUE : VK_FALSE;
+	return state;
+}
+
+void Mesh::SetPipelineState(PipelineStateDescription state) {
+	mPipelineState = state;
+}
+
 int Mesh::GetTexID() {
 	return mTexID;
 }
@@ -42,6 +100,10 @@ int Mesh::GetIndexCount() {
 	return mIndexCount;
 }
 
+const std::vector<Submesh>& Mesh::GetSubmeshes() {
+	return mSubmeshes;
+}
+
 BufferWrapper* Mesh::GetVertexBuffer() {
 	return mVertexBuffer;
 }
@@ -50,34 +112,64 @@ BufferWrapper* Mesh::GetIndexBuffer() {
 	return mIndexBuffer;
 }
 
-void Mesh::CreateVertexBuffer(std::vector<Vertex>* vertices) {
-	mVertexCount = (int)vertices->size();
-
-	VkDeviceSize bufferSize = sizeof(Vertex) * vertices->size();
+void Mesh::CreateVertexBuffer(const Vertex* vertices, uint32_t vertexCount) {
+	mVertexCount = (int)vertexCount;
 
-	BufferWrapper* stagingBuffer = new BufferWrapper(mPhysicalDevice, mLogicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	VkDeviceSize bufferSize = sizeof(Vertex) * vertexCount;
 
-	stagingBuffer->MapBufferMemory(vertices->data(), bufferSize);
+	// ReBAR / UMA: the vertex buffer itself is host visible, so write into it directly
+	if (mPhysicalDevice->HasDeviceLocalHostVisibleMemory()) {
+		mVertexBuffer = new BufferWrapper(mPhysicalDevice, mLogicalDevice, bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		mVertexBuffer->MapBufferMemory(vertices, bufferSize);
+		return;
+	}
 
 	mVertexBuffer = new BufferWrapper(mPhysicalDevice, mLogicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-	CopyBuffer(mLogicalDevice, mTransferCommandPool, stagingBuffer, mVertexBuffer, bufferSize);
-
-	delete stagingBuffer;
+	// Recorded into the current upload batch, the copy happens once the batch is submitted
+	mUploadContext->UploadBuffer(mVertexBuffer, vertices, bufferSize, 0);
 }
 
-void Mesh::CreateIndexBuffer(std::vector<uint32_t>* indices) {
-	mIndexCount = (int)indices->size();
+void Mesh::CreateIndexBuffer(const uint32_t* indices, uint32_t indexCount) {
+	mIndexCount = (int)indexCount;
 
-	VkDeviceSize bufferSize = sizeof(uint32_t) * indices->size();
+	VkDeviceSize bufferSize = sizeof(uint32_t) * indexCount;
 
-	BufferWrapper* stagingBuffer = new BufferWrapper(mPhysicalDevice, mLogicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-	stagingBuffer->MapBufferMemory(indices->data(), bufferSize);
+	// ReBAR / UMA: the index buffer itself is host visible, so write into it directly
+	if (mPhysicalDevice->HasDeviceLocalHostVisibleMemory()) {
+		mIndexBuffer = new BufferWrapper(mPhysicalDevice, mLogicalDevice, bufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		mIndexBuffer->MapBufferMemory(indices, bufferSize);
+		return;
+	}
 
 	mIndexBuffer = new BufferWrapper(mPhysicalDevice, mLogicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-	CopyBuffer(mLogicalDevice, mTransferCommandPool, stagingBuffer, mIndexBuffer, bufferSize);
+	// Recorded into the current upload batch, the copy happens once the batch is submitted
+	mUploadContext->UploadBuffer(mIndexBuffer, indices, bufferSize, 0);
+}
 
-	delete stagingBuffer;
-}
\ No newline at end of file
+/*
+
+	Used by the vector constructors, one draw over the whole buffers. Must run after both buffers
+	are created.
+
+*/
+void Mesh::CreateSingleSubmesh(std::vector<Vertex>* vertices, int texID) {
+	glm::vec3 boundsMin = vertices->empty() ? glm::vec3(0.0f) : vertices->at(0).mPosition;
+	glm::vec3 boundsMax = boundsMin;
+	for (size_t i = 0; i < vertices->size(); i++) {
+		boundsMin = glm::min(boundsMin, vertices->at(i).mPosition);
+		boundsMax = glm::max(boundsMax, vertices->at(i).mPosition);
+	}
+
+	mSubmeshes.push_back({
+		.mFirstIndex = 0,
+		.mIndexCount = (uint32_t)mIndexCount,
+		.mVertexOffset = 0,
+		.mVertexCount = (uint32_t)mVertexCount,
+		.mBoundsMin = boundsMin,
+		.mBoundsMax = boundsMax,
+		.mMaterialIndex = -1,
+		.mTexID = texID
+	});
+}
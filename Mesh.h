@@ -2,12 +2,14 @@
 #define MESH_H
 
 #include <vector>
+#include <cstddef>
 #include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
+#include "PipelineWrapper.h"
 
 class PhysicalDeviceWrapper;
 class LogicalDeviceWrapper;
-class CommandPoolWrapper;
+class UploadContext;
 class BufferWrapper;
 
 
@@ -17,27 +19,68 @@ struct Vertex {
 	glm::vec2 mUV;
 };
 
+// Where the vertex shader input at each location lives in Vertex. Which ones a shader reads, and as what, comes from reflection.
+const uint32_t VERTEX_ATTRIBUTE_OFFSETS[] = { offsetof(Vertex, mPosition), offsetof(Vertex, mColor), offsetof(Vertex, mUV) };
+
+// One draw out of a mesh's shared buffers. Indices are relative to mVertexOffset.
+struct Submesh {
+	uint32_t mFirstIndex;
+	uint32_t mIndexCount;
+	int32_t mVertexOffset;
+	uint32_t mVertexCount;
+	glm::vec3 mBoundsMin;								// Model space
+	glm::vec3 mBoundsMax;
+	int mMaterialIndex;									// Into the imported model's materials, -1 for none
+	int mTexID;											// Bindless slot, -1 for untextured
+};
+
+/*
+
+	Notes:
+		- A mesh is one vertex and one index buffer plus the submeshes drawn out of them. Meshes built from
+		  plain vectors have a single submesh covering everything, imported models one per Assimp mesh
+		  instance. Either way it's two buffer allocations and two copies in the current upload batch.
+		- The geometry is copied out during construction, so the source (a vector, a mapped cooked model
+		  file) can go away as soon as the constructor returns.
+		- All submeshes share the mesh's model matrix and pipeline state. USE_TEXTURE is only on when
+		  every submesh has a texture, otherwise the whole mesh draws with its vertex colors.
+
+*/
+
 class Mesh {
 public:
-	Mesh(PhysicalDeviceWrapper*, LogicalDeviceWrapper*, CommandPoolWrapper*, std::vector<Vertex>*, std::vector<uint32_t>*);
-	Mesh(PhysicalDeviceWrapper*, LogicalDeviceWrapper*, CommandPoolWrapper*, std::vector<Vertex>*, std::vector<uint32_t>*, int);
+	Mesh(PhysicalDeviceWrapper*, LogicalDeviceWrapper*, UploadContext*, std::vector<Vertex>*, std::vector<uint32_t>*);
+	Mesh(PhysicalDeviceWrapper*, LogicalDeviceWrapper*, UploadContext*, std::vector<Vertex>*, std::vector<uint32_t>*, int);
+	Mesh(PhysicalDeviceWrapper*, LogicalDeviceWrapper*, UploadContext*, const Vertex*, uint32_t, const uint32_t*, uint32_t, std::vector<Submesh>);
 	~Mesh();
 
 	glm::mat4 GetModel();
 	void SetModel(glm::mat4);
 
+	bool IsVisible();
+	void SetVisible(bool);
+
+	PipelineStateDescription GetPipelineState();
+	PipelineStateDescription GetDrawPipelineState();
+	void SetPipelineState(PipelineStateDescription);
+
 	int GetTexID();
 	int GetVertexCount();
 	int GetIndexCount();
+	const std::vector<Submesh>& GetSubmeshes();
 	BufferWrapper* GetVertexBuffer();
 	BufferWrapper* GetIndexBuffer();
 private:
-	void CreateVertexBuffer(std::vector<Vertex>*);
-	void CreateIndexBuffer(std::vector<uint32_t>*);
+	void CreateVertexBuffer(const Vertex*, uint32_t);
+	void CreateIndexBuffer(const uint32_t*, uint32_t);
+	void CreateSingleSubmesh(std::vector<Vertex>*, int);
 
 	glm::mat4 mModel;
+	bool mVisible;
+	PipelineStateDescription mPipelineState;
 
-	int mTexID;
+	int mTexID;											// Texture of the first submesh
+	std::vector<Submesh> mSubmeshes;
 	int mVertexCount;
 	int mIndexCount;
 	BufferWrapper* mVertexBuffer;
@@ -45,7 +88,7 @@ private:
 
 	PhysicalDeviceWrapper* mPhysicalDevice;
 	LogicalDeviceWrapper* mLogicalDevice;
-	CommandPoolWrapper* mTransferCommandPool;
+	UploadContext* mUploadContext;
 };
 
 #endif
@@ -0,0 +1,148 @@
+#include "ModelImporter.h"
+#include "globals.h"
+#include <filesystem>
+#include <cfloat>
+#include <glm/gtc/type_ptr.hpp>
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+static glm::mat4 ToGlm(const aiMatrix4x4& matrix) {
+	// Assimp is row major
+	return glm::transpose(glm::make_mat4(&matrix.a1));
+}
+
+// Triangulate marks every mesh it built from quads or polygons with the NGON encoding flag, those are still triangles
+static bool IsTriangleMesh(const aiMesh* mesh) {
+	return (mesh->mPrimitiveTypes & ~aiPrimitiveType_NGONEncodingFlag) == aiPrimitiveType_TRIANGLE;
+}
+
+static void CountNode(const aiScene* scene, const aiNode* node, size_t* vertexCount, size_t* indexCount, size_t* submeshCount, size_t* skippedCount) {
+	for (unsigned int i = 0; i < node->mNumMeshes; i++) {
+		const aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+		if (!IsTriangleMesh(mesh)) {
+			(*skippedCount)++;
+			continue;
+		}
+		*vertexCount += mesh->mNumVertices;
+		*indexCount += mesh->mNumFaces * 3;
+		(*submeshCount)++;
+	}
+	for (unsigned int i = 0; i < node->mNumChildren; i++) {
+		CountNode(scene, node->mChildren[i], vertexCount, indexCount, submeshCount, skippedCount);
+	}
+}
+
+static void AppendMesh(const aiMesh* mesh, glm::mat4 transform, ModelData* model) {
+	Submesh submesh = {
+		.mFirstIndex = (uint32_t)model->mIndices.size(),
+		.mIndexCount = mesh->mNumFaces * 3,
+		.mVertexOffset = (int32_t)model->mVertices.size(),
+		.mVertexCount = mesh->mNumVertices,
+		.mBoundsMin = glm::vec3(FLT_MAX),
+		.mBoundsMax = glm::vec3(-FLT_MAX),
+		.mMaterialIndex = (int)mesh->mMaterialIndex,
+		.mTexID = -1
+	};
+
+	glm::vec3 materialColor = model->mMaterials.at(mesh->mMaterialIndex).mDiffuseColor;
+	for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
+		const aiVector3D& position = mesh->mVertices[i];
+		Vertex vertex;
+		vertex.mPosition = glm::vec3(transform * glm::vec4(position.x, position.y, position.z, 1.0f));
+		vertex.mColor = mesh->HasVertexColors(0) ? glm::vec3(mesh->mColors[0][i].r, mesh->mColors[0][i].g, mesh->mColors[0][i].b) : materialColor;
+		vertex.mUV = mesh->HasTextureCoords(0) ? glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y) : glm::vec2(0.0f);
+		model->mVertices.push_back(vertex);
+
+		submesh.mBoundsMin = glm::min(submesh.mBoundsMin, vertex.mPosition);
+		submesh.mBoundsMax = glm::max(submesh.mBoundsMax, vertex.mPosition);
+	}
+
+	// Triangulated, so every face has three indices
+	for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
+		model->mIndices.push_back(mesh->mFaces[i].mIndices[0]);
+		model->mIndices.push_back(mesh->mFaces[i].mIndices[1]);
+		model->mIndices.push_back(mesh->mFaces[i].mIndices[2]);
+	}
+
+	model->mBoundsMin = glm::min(model->mBoundsMin, submesh.mBoundsMin);
+	model->mBoundsMax = glm::max(model->mBoundsMax, submesh.mBoundsMax);
+	model->mSubmeshes.push_back(submesh);
+}
+
+static void AppendNode(const aiScene* scene, const aiNode* node, glm::mat4 parentTransform, ModelData* model) {
+	glm::mat4 transform = parentTransform * ToGlm(node->mTransformation);
+
+	for (unsigned int i = 0; i < node->mNumMeshes; i++) {
+		const aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+		if (IsTriangleMesh(mesh)) {
+			AppendMesh(mesh, transform, model);
+		}
+	}
+	for (unsigned int i = 0; i < node->mNumChildren; i++) {
+		AppendNode(scene, node->mChildren[i], transform, model);
+	}
+}
+
+static ModelMaterial ReadMaterial(const aiMaterial* material, const std::filesystem::path& directory) {
+	ModelMaterial result = {
+		.mName = material->GetName().C_Str(),
+		.mDiffuseColor = glm::vec3(1.0f),
+		.mDiffuseTexture = ""
+	};
+
+	aiColor3D diffuse;
+	if (material->Get(AI_MATKEY_COLOR_DIFFUSE, diffuse) == AI_SUCCESS) {
+		result.mDiffuseColor = glm::vec3(diffuse.r, diffuse.g, diffuse.b);
+	}
+
+	aiString texture;
+	if (material->GetTexture(aiTextureType_DIFFUSE, 0, &texture) == AI_SUCCESS && texture.length > 0 && texture.C_Str()[0] != '*') {
+		result.mDiffuseTexture = (directory / texture.C_Str()).lexically_normal().string();
+	}
+
+	return result;
+}
+
+/*
+
+	Imports the model at filename. See the notes in the header for what ends up where.
+
+*/
+ModelData ImportModel(const std::string& filename) {
+	Assimp::Importer importer;
+	const aiScene* scene = importer.ReadFile(filename, aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SortByPType | aiProcess_FlipUVs);
+	if (scene == nullptr || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || scene->mRootNode == nullptr) {
+		throw std::runtime_error("Failed to import model " + filename + "! " + importer.GetErrorString());
+	}
+
+	ModelData model;
+	model.mBoundsMin = glm::vec3(FLT_MAX);
+	model.mBoundsMax = glm::vec3(-FLT_MAX);
+
+	std::filesystem::path directory = std::filesystem::path(filename).parent_path();
+	for (unsigned int i = 0; i < scene->mNumMaterials; i++) {
+		model.mMaterials.push_back(ReadMaterial(scene->mMaterials[i], directory));
+	}
+
+	size_t vertexCount = 0;
+	size_t indexCount = 0;
+	size_t submeshCount = 0;
+	size_t skippedCount = 0;
+	CountNode(scene, scene->mRootNode, &vertexCount, &indexCount, &submeshCount, &skippedCount);
+	if (submeshCount == 0) {
+		throw std::runtime_error("Failed to import model " + filename + "! It has no triangle meshes.");
+	}
+	// Only point and line meshes should end up here, anything else means geometry is going missing
+	if (skippedCount > 0) {
+		std::cout << "Warning: Model " << filename << " has " << skippedCount << " point or line mesh instance(s), they are skipped." << std::endl;
+	}
+
+	model.mVertices.reserve(vertexCount);
+	model.mIndices.reserve(indexCount);
+	model.mSubmeshes.reserve(submeshCount);
+	AppendNode(scene, scene->mRootNode, glm::mat4(1.0f), &model);
+
+	std::cout << "Success: Model " << filename << " imported (" << model.mSubmeshes.size() << " submeshes, " << model.mVertices.size() << " vertices, " << model.mIndices.size() << " indices)." << std::endl;
+	return model;
+}
@@ -0,0 +1,46 @@
+#ifndef MODEL_IMPORTER_H
+#define MODEL_IMPORTER_H
+
+#include <vector>
+#include <string>
+#include <glm/glm.hpp>
+#include "Mesh.h"
+
+struct ModelMaterial {
+	std::string mName;
+	glm::vec3 mDiffuseColor;
+	std::string mDiffuseTexture;						// Path relative to the working directory, empty for none
+};
+
+// Everything a model file turns into: all geometry back to back, ready to become one Mesh
+struct ModelData {
+	std::vector<Vertex> mVertices;
+	std::vector<uint32_t> mIndices;
+	std::vector<Submesh> mSubmeshes;					// mTexID is left at -1, textures are the renderer's business
+	std::vector<ModelMaterial> mMaterials;
+	glm::vec3 mBoundsMin;
+	glm::vec3 mBoundsMax;
+};
+
+/*
+
+	ImportModel reads any format Assimp knows and flattens the scene into one vertex and one index array.
+	Every mesh a node references becomes a submesh, with the node's transform baked into its positions,
+	so a mesh used by several nodes shows up once per instance.
+
+	Notes:
+		- The scene is walked twice: once to count, then the arrays are sized and filled. Importing doesn't
+		  reallocate no matter how many submeshes there are.
+		- Faces are triangulated, quads and polygons included. Point and line meshes are skipped with a
+		  warning. Resources/Models/TexturedCube.obj is all quads, --cook imports it and fails if that
+		  ever stops producing submeshes.
+		- Vertex colors come from the first color set, or from the material's diffuse color when there is
+		  none, so untextured models still draw with their material colors.
+		- UVs are flipped to Vulkan's top left origin. Texture paths are resolved relative to the model
+		  file. Embedded textures ("*0" and so on) aren't supported and leave the material untextured.
+		- Throws with Assimp's error string when the file can't be read.
+
+*/
+
+ModelData ImportModel(const std::string&);
+#endif
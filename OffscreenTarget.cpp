@@ -0,0 +1,102 @@
+#include "OffscreenTarget.h"
+#include "globals.h"
+#include "PhysicalDeviceWrapper.h"
+#include "LogicalDeviceWrapper.h"
+#include "ImageWrapper.h"
+#include "ImageViewWrapper.h"
+#include "BufferWrapper.h"
+
+OffscreenTarget::OffscreenTarget(PhysicalDeviceWrapper* pDevice, LogicalDeviceWrapper* lDevice, uint32_t width, uint32_t height, VkFormat format, uint32_t imageCount) : mPhysicalDevice(pDevice), mLogicalDevice(lDevice) {
+	// Readback buffers, ImageWriter and the frame sinks all take the pixels as 4 byte RGBA
+	if (format != VK_FORMAT_R8G8B8A8_UNORM && format != VK_FORMAT_R8G8B8A8_SRGB) {
+		throw std::runtime_error("Failed to create offscreen target! Only RGBA8 formats can be read back.");
+	}
+
+	mExtent = { width, height };
+	mFormat = format;
+	mReadbackSize = (VkDeviceSize)width * height * 4;
+
+	CreateImages(imageCount);
+	std::cout << "Success: Offscreen Target created. (" << width << "x" << height << ", " << imageCount << " images)" << std::endl;
+}
+
+OffscreenTarget::~OffscreenTarget() {
+	for (size_t i = 0; i < mImages.size(); i++) {
+		delete mImages.at(i).mReadbackBuffer;
+		delete mImages.at(i).mImageView;
+		delete mImages.at(i).mImage;
+	}
+}
+
+VkExtent2D OffscreenTarget::GetExtent() {
+	return mExtent;
+}
+
+VkFormat OffscreenTarget::GetFormat() {
+	return mFormat;
+}
+
+uint32_t OffscreenTarget::GetImageCount() {
+	return (uint32_t)mImages.size();
+}
+
+ImageViewWrapper* OffscreenTarget::GetImageView(uint32_t index) {
+	return mImages.at(index).mImageView;
+}
+
+/*
+
+	Copies the image into its readback buffer. Has to be recorded after the render pass, which leaves
+	the image in TRANSFER_SRC_OPTIMAL. The trailing barrier makes the copy visible to the host once the
+	submission's timeline value is reached.
+
+*/
+void OffscreenTarget::RecordReadback(VkCommandBuffer commandBuffer, uint32_t index) {
+	VkBufferImageCopy region = {
+		.bufferOffset = 0,
+		.bufferRowLength = 0,
+		.bufferImageHeight = 0,
+		.imageSubresource = {
+			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+			.mipLevel = 0,
+			.baseArrayLayer = 0,
+			.layerCount = 1
+		},
+		.imageOffset = { 0, 0, 0 },
+		.imageExtent = { mExtent.width, mExtent.height, 1 }
+	};
+	vkCmdCopyImageToBuffer(commandBuffer, mImages.at(index).mImage->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, mImages.at(index).mReadbackBuffer->GetBuffer(), 1, &region);
+
+	VkMemoryBarrier memoryBarrier = {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		.pNext = nullptr,
+		.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+		.dstAccessMask = VK_ACCESS_HOST_READ_BIT
+	};
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+}
+
+const void* OffscreenTarget::GetReadbackData(uint32_t index) {
+	return mImages.at(index).mReadbackBuffer->GetMappedData();
+}
+
+VkDeviceSize OffscreenTarget::GetReadbackSize() {
+	return mReadbackSize;
+}
+
+void OffscreenTarget::CreateImages(uint32_t imageCount) {
+	// Cached memory makes reading back on the CPU a lot faster where it's available
+	MemoryTypeRequest readbackRequest = {
+		.mRequired = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		.mPreferred = VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+		.mForbidden = 0
+	};
+
+	for (uint32_t i = 0; i < imageCount; i++) {
+		OffscreenImage image;
+		image.mImage = new ImageWrapper(mPhysicalDevice, mLogicalDevice, mExtent.width, mExtent.height, mFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		image.mImageView = new ImageViewWrapper(mLogicalDevice, image.mImage->GetImage(), mFormat, VK_IMAGE_ASPECT_COLOR_BIT);
+		image.mReadbackBuffer = new BufferWrapper(mPhysicalDevice, mLogicalDevice, mReadbackSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, readbackRequest);
+		mImages.push_back(image);
+	}
+}
@@ -0,0 +1,60 @@
+#ifndef OFFSCREEN_TARGET_H
+#define OFFSCREEN_TARGET_H
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+class PhysicalDeviceWrapper;
+class LogicalDeviceWrapper;
+class ImageWrapper;
+class ImageViewWrapper;
+class BufferWrapper;
+
+/*
+
+	OffscreenTarget stands in for the swapchain when there is no surface. It owns a set of color images
+	the Renderer draws into and, for every image, a host visible buffer the image is copied to at the end
+	of the frame. Once the frame's timeline value is reached the pixels can be read straight from the
+	mapped buffer.
+
+	Notes:
+		- There is one image per possible frame in flight and frame slot i always renders into image i,
+		  so waiting on the slot is enough to know its image and readback buffer are free. No acquire,
+		  no semaphores.
+		- Readback buffers are tightly packed rows of the image's format, which has to be RGBA8 (UNORM or
+		  SRGB). The constructor throws for anything else, since everything reading the pixels assumes it.
+
+*/
+
+struct OffscreenImage {
+	ImageWrapper* mImage;
+	ImageViewWrapper* mImageView;
+	BufferWrapper* mReadbackBuffer;
+};
+
+class OffscreenTarget {
+public:
+	OffscreenTarget(PhysicalDeviceWrapper*, LogicalDeviceWrapper*, uint32_t, uint32_t, VkFormat, uint32_t);
+	~OffscreenTarget();
+
+	VkExtent2D GetExtent();
+	VkFormat GetFormat();
+	uint32_t GetImageCount();
+	ImageViewWrapper* GetImageView(uint32_t);
+
+	void RecordReadback(VkCommandBuffer, uint32_t);
+	const void* GetReadbackData(uint32_t);
+	VkDeviceSize GetReadbackSize();
+private:
+	void CreateImages(uint32_t);
+
+	std::vector<OffscreenImage> mImages;
+	VkExtent2D mExtent;
+	VkFormat mFormat;
+	VkDeviceSize mReadbackSize;
+
+	PhysicalDeviceWrapper* mPhysicalDevice;
+	LogicalDeviceWrapper* mLogicalDevice;
+};
+#endif
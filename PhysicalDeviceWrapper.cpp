@@ -1,5 +1,6 @@
 #include "PhysicalDeviceWrapper.h"
 #include "globals.h"
+#include <cstddef>
 #include "InstanceWrapper.h"
 #include "SurfaceWrapper.h"
 
@@ -31,6 +32,22 @@ QueueFamilyIndices& PhysicalDeviceWrapper::GetQueueFamilyIndices() {
 	return mQueueFamilyIndices;
 }
 
+uint32_t PhysicalDeviceWrapper::FindMemoryTypeIndex(uint32_t allowedTypes, MemoryTypeRequest request) {
+	uint32_t index = RankMemoryTypes(mPhysicalDeviceMemoryProperties, allowedTypes, request);
+	if (index == UINT32_MAX) {
+		throw std::runtime_error("Failed to find a suitable memory type! Required: " + NT_MEMORY_PROPERTY_STRING(request.mRequired) + " Forbidden: " + NT_MEMORY_PROPERTY_STRING(request.mForbidden));
+	}
+	return index;
+}
+
+bool PhysicalDeviceWrapper::HasDeviceLocalHostVisibleMemory() {
+	return mDeviceLocalHostVisible;
+}
+
+bool PhysicalDeviceWrapper::IsHeadless() {
+	return mSurface == nullptr;
+}
+
 void PhysicalDeviceWrapper::RetrievePhysicalDevice() {
 	// Get the number of physical devices
 	uint32_t deviceCount = 0;
@@ -52,6 +69,9 @@ void PhysicalDeviceWrapper::RetrievePhysicalDevice() {
 		if (!CheckDeviceExtensionSupport(devices.at(i))) {
 			continue;
 		}
+		if (!CheckDeviceFeatureSupport(devices.at(i))) {
+			continue;
+		}
 		mPhysicalDevice = devices.at(i);
 		break;
 	}
@@ -65,6 +85,8 @@ void PhysicalDeviceWrapper::RetrievePhysicalDevice() {
 
 	AssignQueueFamilyIndices();
 	ValidateQueueFamilyIndices();
+
+	DetectDeviceLocalHostVisibleMemory();
 }
 
 void PhysicalDeviceWrapper::OutputPhysicalDeviceExtensions() {
@@ -148,6 +170,38 @@ bool PhysicalDeviceWrapper::CheckDeviceExtensionSupport(VkPhysicalDevice pDevice
 	return true;
 }
 
+/*
+
+	Checks that the device implements VULKAN_API_VERSION and every feature in ENABLED_VULKAN_12_FEATURES.
+	The feature struct is nothing but VkBool32s after sType and pNext, so they are compared one by one.
+
+*/
+bool PhysicalDeviceWrapper::CheckDeviceFeatureSupport(VkPhysicalDevice pDevice) {
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(pDevice, &properties);
+	if (properties.apiVersion < VULKAN_API_VERSION) {
+		return false;
+	}
+
+	VkPhysicalDeviceVulkan12Features vulkan12Features = { };
+	vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	VkPhysicalDeviceFeatures2 features = { };
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &vulkan12Features;
+	vkGetPhysicalDeviceFeatures2(pDevice, &features);
+
+	const VkBool32* enabled = &ENABLED_VULKAN_12_FEATURES.samplerMirrorClampToEdge;
+	const VkBool32* supported = &vulkan12Features.samplerMirrorClampToEdge;
+	size_t featureCount = (sizeof(VkPhysicalDeviceVulkan12Features) - offsetof(VkPhysicalDeviceVulkan12Features, samplerMirrorClampToEdge)) / sizeof(VkBool32);
+	for (size_t i = 0; i < featureCount; i++) {
+		if (enabled[i] && !supported[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 /*
 
 	This function assigns the queue family indices of the physical device.
@@ -178,12 +232,19 @@ void PhysicalDeviceWrapper::AssignQueueFamilyIndices() {
 		}
 
 		// This code checks to see if the queue family supports presentation. But we set a preference for the graphics queue.
+		if (mSurface == nullptr) {
+			continue;
+		}
 		VkBool32 presentSupport = false;
 		vkGetPhysicalDeviceSurfaceSupportKHR(mPhysicalDevice, i, mSurface->GetSurface(), &presentSupport);
 		if (presentSupport && mQueueFamilyIndices.mPresent == -1) {
 			mQueueFamilyIndices.mPresent = i;
 		}
 	}
+
+	if (mSurface == nullptr) {
+		mQueueFamilyIndices.mPresent = mQueueFamilyIndices.mGraphics;
+	}
 }
 
 
@@ -205,7 +266,34 @@ void PhysicalDeviceWrapper::ValidateQueueFamilyIndices() {
 	if (mQueueFamilyIndices.mTransfer == -1) {
 		throw std::runtime_error("Failed to find a suitable queue family for transfer operations!");
 	}
-	if (mQueueFamilyIndices.mSparseBinding == -1) {
-		throw std::runtime_error("Failed to find a suitable queue family for sparse binding operations!");
+	// Sparse binding is never used and software drivers like lavapipe don't have it, so it's not required
+}
+
+/*
+
+	Looks for a memory type that is device local, host visible and host coherent. Integrated GPUs
+	(UMA) qualify as is. On discrete GPUs the type only counts if its heap is bigger than the legacy
+	256MB BAR window, which means resizable BAR is enabled and the whole of VRAM is mappable.
+
+*/
+void PhysicalDeviceWrapper::DetectDeviceLocalHostVisibleMemory() {
+	const VkMemoryPropertyFlags directFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	const VkDeviceSize legacyBarSize = 256 * 1024 * 1024;
+
+	mDeviceLocalHostVisible = false;
+	for (uint32_t i = 0; i < mPhysicalDeviceMemoryProperties.memoryTypeCount; i++) {
+		if ((mPhysicalDeviceMemoryProperties.memoryTypes[i].propertyFlags & directFlags) != directFlags) {
+			continue;
+		}
+
+		VkDeviceSize heapSize = mPhysicalDeviceMemoryProperties.memoryHeaps[mPhysicalDeviceMemoryProperties.memoryTypes[i].heapIndex].size;
+		if (mPhysicalDeviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU || heapSize > legacyBarSize) {
+			mDeviceLocalHostVisible = true;
+			break;
+		}
+	}
+
+	if (mDeviceLocalHostVisible) {
+		std::cout << "Success: Device local host visible memory found (ReBAR / UMA). Staging uploads will be skipped." << std::endl;
 	}
 }
@@ -13,8 +13,17 @@ class SurfaceWrapper;
 	TODO: Find better criteria for suitable devices.
 	TODO: Add Surface Support Queue Family Index Check
 
+	Notes:
+		- FindMemoryTypeIndex() ranks the memory types with RankMemoryTypes() from globals.h.
+		- Without a SurfaceWrapper (headless) there is nothing to present to. The present queue family
+		  is then simply the graphics family.
+		- HasDeviceLocalHostVisibleMemory() is true on UMA devices and on discrete GPUs with
+		  resizable BAR. On those we can write straight into device local memory and skip staging.
+
 */
 
+struct MemoryTypeRequest;
+
 struct QueueFamilyIndices {
 	int mGraphics = -1;
 	int mPresent = -1;					// Need to implement
@@ -35,6 +44,10 @@ public:
 	VkPhysicalDeviceMemoryProperties GetPhysicalDeviceMemoryProperties();
 
 	QueueFamilyIndices& GetQueueFamilyIndices();
+
+	uint32_t FindMemoryTypeIndex(uint32_t, MemoryTypeRequest);
+	bool HasDeviceLocalHostVisibleMemory();
+	bool IsHeadless();
 private:
 	void RetrievePhysicalDevice();
 
@@ -42,15 +55,19 @@ private:
 
 	bool CheckDeviceSuitable(VkPhysicalDevice);
 	bool CheckDeviceExtensionSupport(VkPhysicalDevice);
+	bool CheckDeviceFeatureSupport(VkPhysicalDevice);
 	
 	void AssignQueueFamilyIndices();
 	void ValidateQueueFamilyIndices();
 
+	void DetectDeviceLocalHostVisibleMemory();
+
 	VkPhysicalDevice mPhysicalDevice;
 	VkPhysicalDeviceProperties mPhysicalDeviceProperties;
 	VkPhysicalDeviceFeatures mPhysicalDeviceFeatures;
 	VkPhysicalDeviceMemoryProperties mPhysicalDeviceMemoryProperties;
 	QueueFamilyIndices mQueueFamilyIndices;
+	bool mDeviceLocalHostVisible;
 
 	InstanceWrapper* mInstance;
 	SurfaceWrapper* mSurface;
@@ -0,0 +1,208 @@
+#include "PipelineCacheWrapper.h"
+#include "globals.h"
+#include <chrono>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include "PhysicalDeviceWrapper.h"
+#include "LogicalDeviceWrapper.h"
+
+PipelineCacheWrapper::PipelineCacheWrapper(PhysicalDeviceWrapper* pDevice, LogicalDeviceWrapper* lDevice, std::string path) : mPath(path), mPhysicalDevice(pDevice), mLogicalDevice(lDevice) {
+	mStats = { };
+	CreatePipelineCache();
+}
+
+PipelineCacheWrapper::~PipelineCacheWrapper() {
+	// Losing the cache only costs startup time next run, not worth taking the shutdown down for
+	try {
+		Save();
+	} catch (const std::runtime_error& e) {
+		std::cout << "Nocturne Error: " << e.what() << std::endl;
+	}
+	vkDestroyPipelineCache(mLogicalDevice->GetLogicalDevice(), mPipelineCache, nullptr); std::cout << "Success: Pipeline Cache destroyed." << std::endl;
+}
+
+VkPipelineCache PipelineCacheWrapper::GetPipelineCache() {
+	return mPipelineCache;
+}
+
+/*
+
+	vkCreateGraphicsPipelines() through the cache, with creation feedback and timing recorded in the stats.
+	Returns the VkResult so callers keep their own error messages.
+
+*/
+VkResult PipelineCacheWrapper::CreateGraphicsPipeline(VkGraphicsPipelineCreateInfo pipelineCI, VkPipeline* pipeline) {
+	VkPipelineCreationFeedbackEXT pipelineFeedback = { };
+	std::vector<VkPipelineCreationFeedbackEXT> stageFeedbacks(pipelineCI.stageCount);
+	VkPipelineCreationFeedbackCreateInfoEXT feedbackCI = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT,
+		.pNext = pipelineCI.pNext,
+		.pPipelineCreationFeedback = &pipelineFeedback,
+		.pipelineStageCreationFeedbackCount = pipelineCI.stageCount,
+		.pPipelineStageCreationFeedbacks = stageFeedbacks.data()
+	};
+	bool feedback = mLogicalDevice->IsExtensionEnabled(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+	if (feedback) {
+		pipelineCI.pNext = &feedbackCI;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	VkResult result = vkCreateGraphicsPipelines(mLogicalDevice->GetLogicalDevice(), mPipelineCache, 1, &pipelineCI, nullptr, pipeline);
+	double elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	RecordCreation(result, elapsed, feedback, pipelineFeedback);
+	return result;
+}
+
+/*
+
+	Same for compute pipelines, which only ever have the one stage.
+
+*/
+VkResult PipelineCacheWrapper::CreateComputePipeline(VkComputePipelineCreateInfo pipelineCI, VkPipeline* pipeline) {
+	VkPipelineCreationFeedbackEXT pipelineFeedback = { };
+	VkPipelineCreationFeedbackEXT stageFeedback = { };
+	VkPipelineCreationFeedbackCreateInfoEXT feedbackCI = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT,
+		.pNext = pipelineCI.pNext,
+		.pPipelineCreationFeedback = &pipelineFeedback,
+		.pipelineStageCreationFeedbackCount = 1,
+		.pPipelineStageCreationFeedbacks = &stageFeedback
+	};
+	bool feedback = mLogicalDevice->IsExtensionEnabled(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+	if (feedback) {
+		pipelineCI.pNext = &feedbackCI;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	VkResult result = vkCreateComputePipelines(mLogicalDevice->GetLogicalDevice(), mPipelineCache, 1, &pipelineCI, nullptr, pipeline);
+	double elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	RecordCreation(result, elapsed, feedback, pipelineFeedback);
+	return result;
+}
+
+/*
+
+	Writes the cache data next to the target file first and then renames it into place.
+
+*/
+void PipelineCacheWrapper::Save() {
+	size_t dataSize = 0;
+	VkResult result = vkGetPipelineCacheData(mLogicalDevice->GetLogicalDevice(), mPipelineCache, &dataSize, nullptr);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to get pipeline cache size! Error Code: " + NT_CHECK_RESULT(result));
+	}
+
+	std::vector<char> data(dataSize);
+	result = vkGetPipelineCacheData(mLogicalDevice->GetLogicalDevice(), mPipelineCache, &dataSize, data.data());
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to get pipeline cache data! Error Code: " + NT_CHECK_RESULT(result));
+	}
+
+	std::string tempPath = mPath + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			throw std::runtime_error("Failed to open " + tempPath + " for writing!");
+		}
+		file.write(data.data(), (std::streamsize)dataSize);
+		if (!file) {
+			throw std::runtime_error("Failed to write " + tempPath + "!");
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempPath, mPath, error);
+	if (error) {
+		std::filesystem::remove(tempPath, error);
+		throw std::runtime_error("Failed to replace " + mPath + "!");
+	}
+	std::cout << "Success: Pipeline Cache saved. (" << dataSize << " bytes)" << std::endl;
+}
+
+PipelineCacheStats PipelineCacheWrapper::GetStats() {
+	std::lock_guard<std::mutex> lock(mStatsMutex);
+	return mStats;
+}
+
+void PipelineCacheWrapper::PrintStats() {
+	PipelineCacheStats stats = GetStats();
+	std::cout << "Pipeline Cache: " << (stats.mLoadedSize > 0 ? "warm" : "cold") << " start, " << stats.mPipelinesCreated << " pipelines created in " << stats.mCreationTime << " ms";
+	if (mLogicalDevice->IsExtensionEnabled(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME)) {
+		std::cout << ", " << stats.mHits << " hits, " << stats.mMisses << " misses";
+	} else {
+		std::cout << ", hits/misses unknown (no creation feedback)";
+	}
+	std::cout << std::endl;
+}
+
+void PipelineCacheWrapper::CreatePipelineCache() {
+	std::vector<char> data;
+
+	std::ifstream file(mPath, std::ios::binary | std::ios::ate);
+	if (file.is_open()) {
+		data.resize((size_t)file.tellg());
+		file.seekg(0);
+		file.read(data.data(), (std::streamsize)data.size());
+		if (!file || !ValidateCacheHeader(data)) {
+			std::cout << "Pipeline Cache: " << mPath << " doesn't match this device or driver, starting cold." << std::endl;
+			data.clear();
+		}
+	}
+	mStats.mLoadedSize = data.size();
+
+	VkPipelineCacheCreateInfo pipelineCacheCI = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+		.pNext = nullptr,
+		.flags = 0,
+		.initialDataSize = data.size(),
+		.pInitialData = data.empty() ? nullptr : data.data()
+	};
+
+	VkResult result = vkCreatePipelineCache(mLogicalDevice->GetLogicalDevice(), &pipelineCacheCI, nullptr, &mPipelineCache);
+	if (result == VK_SUCCESS) {
+		std::cout << "Success: Pipeline Cache created. (" << data.size() << " bytes loaded)" << std::endl;
+	} else {
+		throw std::runtime_error("Failed to create pipeline cache! Error Code: " + NT_CHECK_RESULT(result));
+	}
+}
+
+/*
+
+	Drivers are supposed to reject foreign data themselves, but some crash or hand back garbage instead.
+	Checking the header ourselves is cheap.
+
+*/
+bool PipelineCacheWrapper::ValidateCacheHeader(const std::vector<char>& data) {
+	VkPipelineCacheHeaderVersionOne header;
+	if (data.size() < sizeof(header)) {
+		return false;
+	}
+	memcpy(&header, data.data(), sizeof(header));
+
+	VkPhysicalDeviceProperties properties = mPhysicalDevice->GetPhysicalDeviceProperties();
+	return header.headerSize >= sizeof(header) &&
+		header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+		header.vendorID == properties.vendorID &&
+		header.deviceID == properties.deviceID &&
+		memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void PipelineCacheWrapper::RecordCreation(VkResult result, double elapsed, bool feedback, VkPipelineCreationFeedbackEXT pipelineFeedback) {
+	if (result != VK_SUCCESS) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(mStatsMutex);
+	mStats.mPipelinesCreated++;
+	mStats.mCreationTime += elapsed;
+	if (feedback && (pipelineFeedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT)) {
+		if (pipelineFeedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT) {
+			mStats.mHits++;
+		} else {
+			mStats.mMisses++;
+		}
+	}
+}
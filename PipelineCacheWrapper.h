@@ -0,0 +1,68 @@
+#ifndef PIPELINE_CACHE_WRAPPER_H
+#define PIPELINE_CACHE_WRAPPER_H
+
+#include <vulkan/vulkan.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <mutex>
+
+class PhysicalDeviceWrapper;
+class LogicalDeviceWrapper;
+
+// Counts since startup. Hits and misses are only known with VK_EXT_pipeline_creation_feedback.
+struct PipelineCacheStats {
+	uint32_t mPipelinesCreated;
+	uint32_t mHits;
+	uint32_t mMisses;
+	double mCreationTime;								// Total time spent in vkCreate*Pipelines, in milliseconds
+	size_t mLoadedSize;									// Bytes of cache data loaded from disk, 0 on a cold start
+};
+
+/*
+
+	PipelineCacheWrapper owns the VkPipelineCache every pipeline is created through and persists it
+	between runs.
+
+	Notes:
+		- The file on disk is only used if its header matches this device: header version, vendor ID,
+		  device ID and pipelineCacheUUID. A driver update changes the UUID, the stale file is ignored
+		  and overwritten at shutdown.
+		- Save() writes to a temporary file and renames it over the old one, so a crash mid write never
+		  leaves a truncated cache behind.
+		- CreateGraphicsPipeline() / CreateComputePipeline() chain VkPipelineCreationFeedbackCreateInfoEXT
+		  when the extension is enabled so the stats can tell cache hits from misses.
+		- The LogicalDeviceWrapper owns the cache and saves it on destruction.
+		- Both may be called from several threads at once, the driver synchronizes the
+		  VkPipelineCache and the stats have their own mutex.
+
+*/
+
+class PipelineCacheWrapper {
+public:
+	PipelineCacheWrapper(PhysicalDeviceWrapper*, LogicalDeviceWrapper*, std::string);
+	~PipelineCacheWrapper();
+
+	VkPipelineCache GetPipelineCache();
+
+	VkResult CreateGraphicsPipeline(VkGraphicsPipelineCreateInfo, VkPipeline*);
+	VkResult CreateComputePipeline(VkComputePipelineCreateInfo, VkPipeline*);
+
+	void Save();
+
+	PipelineCacheStats GetStats();
+	void PrintStats();
+private:
+	void CreatePipelineCache();
+	bool ValidateCacheHeader(const std::vector<char>&);
+	void RecordCreation(VkResult, double, bool, VkPipelineCreationFeedbackEXT);
+
+	VkPipelineCache mPipelineCache;
+	std::string mPath;
+	PipelineCacheStats mStats;
+	std::mutex mStatsMutex;
+
+	PhysicalDeviceWrapper* mPhysicalDevice;
+	LogicalDeviceWrapper* mLogicalDevice;
+};
+#endif
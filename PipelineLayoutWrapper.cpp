@@ -0,0 +1,53 @@
+#include "PipelineLayoutWrapper.h"
+#include "globals.h"
+#include "LogicalDeviceWrapper.h"
+#include "DescriptorSetWrapper.h"
+
+PipelineLayoutWrapper::PipelineLayoutWrapper(LogicalDeviceWrapper* lDevice, std::vector<DescriptorSetLayoutWrapper*> layouts, std::vector<VkPushConstantRange> pushConstantRanges) : mLogicalDevice(lDevice), mDescriptorSetLayouts(layouts), mPushConstantRanges(pushConstantRanges) {
+	CreatePipelineLayout();
+}
+
+PipelineLayoutWrapper::~PipelineLayoutWrapper() {
+	vkDestroyPipelineLayout(mLogicalDevice->GetLogicalDevice(), mPipelineLayout, nullptr);	std::cout << "Success: Pipeline Layout destroyed" << std::endl;
+}
+
+VkPipelineLayout PipelineLayoutWrapper::GetPipelineLayout() {
+	return mPipelineLayout;
+}
+
+DescriptorSetLayoutWrapper* PipelineLayoutWrapper::GetDescriptorSetLayout(uint32_t set) {
+	return mDescriptorSetLayouts.at(set);
+}
+
+uint32_t PipelineLayoutWrapper::GetDescriptorSetLayoutCount() {
+	return (uint32_t)mDescriptorSetLayouts.size();
+}
+
+std::vector<VkPushConstantRange> PipelineLayoutWrapper::GetPushConstantRanges() {
+	return mPushConstantRanges;
+}
+
+void PipelineLayoutWrapper::CreatePipelineLayout() {
+	std::vector<VkDescriptorSetLayout> layouts;
+
+	for (auto& layout : mDescriptorSetLayouts) {
+		layouts.push_back(layout->GetDescriptorSetLayout());
+	}
+
+	VkPipelineLayoutCreateInfo pipelineLayoutCI = {
+		VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,						// sType
+		nullptr,															// pNext
+		0,																	// flags
+		(uint32_t)layouts.size(),											// setLayoutCount
+		layouts.data(),														// pSetLayouts
+		(uint32_t)mPushConstantRanges.size(),								// pushConstantRangeCount
+		mPushConstantRanges.data()											// pPushConstantRanges
+	};
+
+	VkResult result = vkCreatePipelineLayout(mLogicalDevice->GetLogicalDevice(), &pipelineLayoutCI, nullptr, &mPipelineLayout);
+	if (result == VK_SUCCESS) {
+		std::cout << "Success: Pipeline layout created." << std::endl;
+	} else {
+		throw std::runtime_error("Failed to create a pipeline layout! Error Code: " + NT_CHECK_RESULT(result));
+	}
+}
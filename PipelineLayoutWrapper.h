@@ -0,0 +1,38 @@
+#ifndef PIPELINE_LAYOUT_WRAPPER_H
+#define PIPELINE_LAYOUT_WRAPPER_H
+
+#include <vector>
+#include <vulkan/vulkan.h>
+
+class LogicalDeviceWrapper;
+class DescriptorSetLayoutWrapper;
+
+/*
+
+	Notes:
+		- Split out of PipelineWrapper so any number of pipelines can share one layout. Pipelines
+		  with the same layout keep their descriptor set bindings when switching between them.
+		- Built from shader reflection by the DescriptorLayoutCache, which hands out the same layout
+		  for every shader combination with the same set layouts and push constants.
+
+*/
+
+class PipelineLayoutWrapper {
+public:
+	PipelineLayoutWrapper(LogicalDeviceWrapper*, std::vector<DescriptorSetLayoutWrapper*>, std::vector<VkPushConstantRange>);
+	~PipelineLayoutWrapper();
+
+	VkPipelineLayout GetPipelineLayout();
+	DescriptorSetLayoutWrapper* GetDescriptorSetLayout(uint32_t);
+	uint32_t GetDescriptorSetLayoutCount();
+	std::vector<VkPushConstantRange> GetPushConstantRanges();
+private:
+	void CreatePipelineLayout();
+
+	VkPipelineLayout mPipelineLayout;
+
+	LogicalDeviceWrapper* mLogicalDevice;
+	std::vector<DescriptorSetLayoutWrapper*> mDescriptorSetLayouts;
+	std::vector<VkPushConstantRange> mPushConstantRanges;
+};
+#endif
@@ -0,0 +1,320 @@
+#include "PipelineRegistry.h"
+#include "globals.h"
+#include <chrono>
+#include <filesystem>
+#include "LogicalDeviceWrapper.h"
+#include "RenderPassWrapper.h"
+#include "PipelineLayoutWrapper.h"
+#include "ShaderWrapper.h"
+#include "ThreadPool.h"
+#include "DescriptorLayoutCache.h"
+
+bool PipelineKey::operator==(const PipelineKey& other) const {
+	return mLayout == other.mLayout && mRenderPass == other.mRenderPass && mState == other.mState;
+}
+
+size_t PipelineKeyHash::operator()(const PipelineKey& key) const {
+	size_t hash = key.mState.Hash();
+	hash = (hash ^ (size_t)key.mLayout) * 1099511628211ull;
+	hash = (hash ^ (size_t)key.mRenderPass) * 1099511628211ull;
+	return hash;
+}
+
+PipelineRegistry::PipelineRegistry(LogicalDeviceWrapper* lDevice, uint32_t compileThreadCount) : mReadyGeneration(0), mLogicalDevice(lDevice) {
+	mStats = { };
+	mCompilePool = new ThreadPool(compileThreadCount);
+	mLayoutCache = new DescriptorLayoutCache(lDevice);
+	std::cout << "Success: Pipeline Registry created." << std::endl;
+}
+
+PipelineRegistry::~PipelineRegistry() {
+	// Builds still in flight reference the layouts and render passes, let them finish first
+	WaitIdle();
+	delete mCompilePool;
+
+	for (auto& entry : mPipelines) {
+		delete entry.second->mPipeline.load();
+		delete entry.second;
+	}
+	for (auto& pipeline : mComputePipelines) {
+		delete pipeline.second;
+	}
+	for (auto& shader : mShaders) {
+		delete shader.second;
+	}
+	for (size_t i = 0; i < mRetiredPipelines.size(); i++) {
+		delete mRetiredPipelines.at(i);
+	}
+	for (size_t i = 0; i < mRetiredShaders.size(); i++) {
+		delete mRetiredShaders.at(i);
+	}
+	delete mLayoutCache;
+	std::cout << "Success: Pipeline Registry destroyed." << std::endl;
+}
+
+/*
+
+	Returns the handle for the given combination. The first request for a combination queues its build
+	on the compile threads, the handle's pipeline stays nullptr until that's done.
+
+*/
+PipelineHandle PipelineRegistry::RequestPipeline(const PipelineStateDescription& state, PipelineLayoutWrapper* layout, RenderPassWrapper* renderPass) {
+	auto start = std::chrono::high_resolution_clock::now();
+	PipelineKey key = { state, layout->GetPipelineLayout(), renderPass->GetRenderPass() };
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	mStats.mLookups++;
+
+	auto found = mPipelines.find(key);
+	if (found != mPipelines.end()) {
+		mStats.mHits++;
+		mStats.mLookupTime += std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+		return found->second;
+	}
+
+	PipelineHandle handle = new PipelineEntry();
+	handle->mPipeline = nullptr;
+	handle->mFailed = false;
+	handle->mState = state;
+	handle->mLayout = layout;
+	handle->mRenderPass = renderPass;
+	handle->mRevision = 0;
+	mPipelines.emplace(key, handle);
+	mStats.mPipelinesPending++;
+
+	mCompilePool->Submit([this, handle]() {
+		BuildPipeline(handle, 0);
+	});
+	return handle;
+}
+
+/*
+
+	Blocking version of RequestPipeline(). Throws if the pipeline can't be built.
+
+*/
+PipelineWrapper* PipelineRegistry::GetPipeline(const PipelineStateDescription& state, PipelineLayoutWrapper* layout, RenderPassWrapper* renderPass) {
+	PipelineHandle handle = RequestPipeline(state, layout, renderPass);
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	mPipelineFinished.wait(lock, [handle] { return handle->mPipeline.load() != nullptr || handle->mFailed.load(); });
+	if (handle->mFailed.load()) {
+		throw std::runtime_error("Failed to build pipeline for " + state.mVertexShader + " / " + state.mFragmentShader + "!");
+	}
+	return handle->mPipeline.load();
+}
+
+/*
+
+	Returns the layout the state's shaders declare. Loads the shaders if nothing asked for them yet.
+
+*/
+PipelineLayoutWrapper* PipelineRegistry::GetPipelineLayout(const PipelineStateDescription& state) {
+	std::vector<ShaderWrapper*> shaders = { GetShader(state.mVertexShader), GetShader(state.mFragmentShader) };
+	return mLayoutCache->GetPipelineLayout(shaders);
+}
+
+/*
+
+	Returns the compute pipeline for the given .comp shader, building it (and its layout) the first time.
+
+*/
+PipelineWrapper* PipelineRegistry::GetComputePipeline(const std::string& path) {
+	std::lock_guard<std::mutex> lock(mComputeMutex);
+
+	auto found = mComputePipelines.find(path);
+	if (found != mComputePipelines.end()) {
+		return found->second;
+	}
+
+	ShaderWrapper* shader = GetShader(path);
+	PipelineWrapper* pipeline = new PipelineWrapper(mLogicalDevice, mLayoutCache->GetPipelineLayout({ shader }), shader);
+	mComputePipelines.emplace(path, pipeline);
+	{
+		std::lock_guard<std::mutex> statsLock(mMutex);
+		mStats.mPipelinesCreated++;
+	}
+	return pipeline;
+}
+
+/*
+
+	Blocks until every queued build has finished.
+
+*/
+void PipelineRegistry::WaitIdle() {
+	mCompilePool->Wait();
+}
+
+/*
+
+	Loads the shader at the given (.spv) path again and queues a rebuild of every pipeline that uses it.
+	Returns how many were queued. Throws, leaving everything as it was, if the new module can't be
+	created. Shaders no pipeline has asked for yet are left alone, they're read fresh when needed.
+
+*/
+uint32_t PipelineRegistry::ReloadShader(const std::string& path) {
+	std::filesystem::path normalPath = std::filesystem::path(path).lexically_normal();
+	std::vector<std::string> reloaded;
+
+	{
+		std::lock_guard<std::mutex> lock(mShaderMutex);
+		for (auto& shader : mShaders) {
+			if (std::filesystem::path(shader.first).lexically_normal() != normalPath) {
+				continue;
+			}
+
+			ShaderWrapper* newShader = new ShaderWrapper(mLogicalDevice, shader.first);
+			mRetiredShaders.push_back(shader.second);
+			shader.second = newShader;
+			reloaded.push_back(shader.first);
+		}
+		if (!reloaded.empty()) {
+			std::lock_guard<std::mutex> statsLock(mMutex);
+			mStats.mShaderModulesCreated += (uint32_t)reloaded.size();
+		}
+	}
+	if (reloaded.empty()) {
+		return 0;
+	}
+
+	uint32_t rebuilt = 0;
+	std::lock_guard<std::mutex> lock(mMutex);
+	for (auto& entry : mPipelines) {
+		PipelineHandle handle = entry.second;
+		bool uses = false;
+		for (size_t i = 0; i < reloaded.size(); i++) {
+			uses = uses || handle->mState.mVertexShader == reloaded.at(i) || handle->mState.mFragmentShader == reloaded.at(i);
+		}
+		if (!uses) {
+			continue;
+		}
+
+		uint64_t revision = ++handle->mRevision;
+		handle->mFailed = false;
+		mStats.mPipelinesPending++;
+		mCompilePool->Submit([this, handle, revision]() {
+			BuildPipeline(handle, revision);
+		});
+		rebuilt++;
+	}
+	return rebuilt;
+}
+
+/*
+
+	Hands over the pipelines that rebuilds replaced. They were swapped out before the ready generation
+	went up, so anything recorded after the caller noticed the new generation no longer uses them.
+
+*/
+std::vector<PipelineWrapper*> PipelineRegistry::TakeRetiredPipelines() {
+	std::vector<PipelineWrapper*> retired;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		retired.swap(mRetiredPipelines);
+	}
+	DeleteRetiredShaders();
+	return retired;
+}
+
+uint64_t PipelineRegistry::GetReadyGeneration() {
+	return mReadyGeneration.load();
+}
+
+PipelineRegistryStats PipelineRegistry::GetStats() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mStats;
+}
+
+void PipelineRegistry::PrintStats() {
+	PipelineRegistryStats stats = GetStats();
+	double averageLookup = stats.mHits == 0 ? 0.0 : stats.mLookupTime / (double)stats.mHits;
+	std::cout << "Pipeline Registry: " << stats.mPipelinesCreated << " pipelines (" << stats.mCreationTime << " ms), " << stats.mPipelinesPending << " pending, " << stats.mPipelinesFailed << " failed, " << stats.mShaderModulesCreated << " shader modules, " << stats.mLookups << " lookups, " << stats.mHits << " hits, " << averageLookup << " us per hit" << std::endl;
+	mLayoutCache->PrintStats();
+}
+
+/*
+
+	Runs on a compile thread. Failures are caught here, a pipeline that doesn't build shouldn't take
+	the frame loop down with it.
+
+*/
+void PipelineRegistry::BuildPipeline(PipelineHandle handle, uint64_t revision) {
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// The description, layout and render pass never change after RequestPipeline(), only the revision does
+	const PipelineStateDescription& state = handle->mState;
+	PipelineWrapper* pipeline = nullptr;
+	try {
+		std::vector<ShaderWrapper*> shaders = { GetShader(state.mVertexShader), GetShader(state.mFragmentShader) };
+		pipeline = new PipelineWrapper(mLogicalDevice, handle->mRenderPass, handle->mLayout, state, shaders);
+	} catch (const std::runtime_error& e) {
+		std::cout << "Nocturne Error: " << e.what() << std::endl;
+	}
+	double elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStats.mPipelinesPending--;
+		if (revision != handle->mRevision) {
+			// A newer rebuild is queued, this one was never handed out
+			delete pipeline;
+		} else if (pipeline != nullptr) {
+			mStats.mPipelinesCreated++;
+			mStats.mCreationTime += elapsed;
+			PipelineWrapper* oldPipeline = handle->mPipeline.exchange(pipeline);
+			if (oldPipeline != nullptr) {
+				mRetiredPipelines.push_back(oldPipeline);
+			}
+			mReadyGeneration++;
+		} else {
+			mStats.mPipelinesFailed++;
+			// A failed rebuild keeps the pipeline that was there
+			if (handle->mPipeline.load() == nullptr) {
+				handle->mFailed.store(true);
+			}
+		}
+	}
+	mPipelineFinished.notify_all();
+}
+
+ShaderWrapper* PipelineRegistry::GetShader(const std::string& path) {
+	std::lock_guard<std::mutex> lock(mShaderMutex);
+
+	auto found = mShaders.find(path);
+	if (found != mShaders.end()) {
+		return found->second;
+	}
+
+	ShaderWrapper* shader = new ShaderWrapper(mLogicalDevice, path);
+	mShaders.emplace(path, shader);
+	{
+		std::lock_guard<std::mutex> statsLock(mMutex);
+		mStats.mShaderModulesCreated++;
+	}
+	return shader;
+}
+
+/*
+
+	Replaced shader modules can go once no build is running anymore, any build that picked one up
+	before the reload was already counted as pending.
+
+*/
+void PipelineRegistry::DeleteRetiredShaders() {
+	std::lock_guard<std::mutex> lock(mShaderMutex);
+	if (mRetiredShaders.empty()) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> statsLock(mMutex);
+		if (mStats.mPipelinesPending != 0) {
+			return;
+		}
+	}
+	for (size_t i = 0; i < mRetiredShaders.size(); i++) {
+		delete mRetiredShaders.at(i);
+	}
+	mRetiredShaders.clear();
+}
@@ -0,0 +1,128 @@
+#ifndef PIPELINE_REGISTRY_H
+#define PIPELINE_REGISTRY_H
+
+#include <vulkan/vulkan.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "PipelineWrapper.h"
+
+class LogicalDeviceWrapper;
+class RenderPassWrapper;
+class PipelineLayoutWrapper;
+class ShaderWrapper;
+class ThreadPool;
+class DescriptorLayoutCache;
+
+// Everything a VkPipeline depends on. Pipelines are looked up by this.
+struct PipelineKey {
+	PipelineStateDescription mState;
+	VkPipelineLayout mLayout;
+	VkRenderPass mRenderPass;
+
+	bool operator==(const PipelineKey&) const;
+};
+
+struct PipelineKeyHash {
+	size_t operator()(const PipelineKey&) const;
+};
+
+// One registry slot. mPipeline stays nullptr until a compile thread has built it.
+struct PipelineEntry {
+	std::atomic<PipelineWrapper*> mPipeline;
+	std::atomic<bool> mFailed;
+
+	// What the slot was built from, so it can be built again when one of its shaders changes
+	PipelineStateDescription mState;
+	PipelineLayoutWrapper* mLayout;
+	RenderPassWrapper* mRenderPass;
+	uint64_t mRevision;									// Bumped per rebuild, a build that finishes after a newer one was queued is dropped
+};
+typedef PipelineEntry* PipelineHandle;
+
+struct PipelineRegistryStats {
+	uint64_t mLookups;
+	uint64_t mHits;
+	uint32_t mPipelinesCreated;
+	uint32_t mPipelinesPending;
+	uint32_t mPipelinesFailed;
+	uint32_t mShaderModulesCreated;
+	double mLookupTime;									// Total time spent in RequestPipeline() on hits, in microseconds
+	double mCreationTime;								// Total time compile threads spent building pipelines, in milliseconds
+};
+
+/*
+
+	PipelineRegistry builds pipelines the first time a state/layout/render pass combination is asked
+	for and hands out the same PipelineWrapper afterwards. Materials that only differ in things that
+	aren't part of the pipeline share one.
+
+	Notes:
+		- RequestPipeline() never blocks on a build. New combinations are queued on the registry's own
+		  compile threads and the returned handle's mPipeline becomes non null once the pipeline is
+		  ready. GetPipeline() is the blocking version, for things that can't do without (the fallback).
+		- Every compile thread creates through the device's one PipelineCacheWrapper. Vulkan synchronizes
+		  access to a VkPipelineCache internally, so they share what the others have compiled.
+		- GetReadyGeneration() goes up by one every time a pipeline finishes building. Anything that
+		  recorded a fallback in place of a pending pipeline compares it to know when to record again.
+		- A failed build is reported once and its handle stays without a pipeline for good.
+		- Shader modules are cached by path as well, so two pipelines using the same shader load and
+		  create its module once.
+		- ReloadShader() reloads a module from disk and rebuilds only the pipelines using it, in the
+		  background. Until a rebuild is done its handle keeps the old pipeline, and if it fails the old
+		  one stays for good. Replaced pipelines may still be in flight, so they're not deleted but handed
+		  out by TakeRetiredPipelines() for the caller to delete once the GPU is done with them.
+		- GetPipelineLayout() derives the layout a state's shaders need from their reflection. Layouts
+		  live in the registry's DescriptorLayoutCache, so every state with the same interface shares
+		  one. A reload that changes a shader's interface needs a restart, rebuilds keep their layout.
+		- GetComputePipeline() builds compute pipelines on the calling thread, there are only ever a few.
+		  They're cached by shader path and aren't rebuilt by ReloadShader().
+		- The registry owns every pipeline, shader and layout it creates. Render passes are not owned
+		  and must outlive any pending build.
+
+*/
+
+class PipelineRegistry {
+public:
+	PipelineRegistry(LogicalDeviceWrapper*, uint32_t);
+	~PipelineRegistry();
+
+	PipelineHandle RequestPipeline(const PipelineStateDescription&, PipelineLayoutWrapper*, RenderPassWrapper*);
+	PipelineWrapper* GetPipeline(const PipelineStateDescription&, PipelineLayoutWrapper*, RenderPassWrapper*);
+	PipelineLayoutWrapper* GetPipelineLayout(const PipelineStateDescription&);
+	PipelineWrapper* GetComputePipeline(const std::string&);
+	void WaitIdle();
+
+	uint32_t ReloadShader(const std::string&);
+	std::vector<PipelineWrapper*> TakeRetiredPipelines();
+
+	uint64_t GetReadyGeneration();
+
+	PipelineRegistryStats GetStats();
+	void PrintStats();
+private:
+	void BuildPipeline(PipelineHandle, uint64_t);
+	void DeleteRetiredShaders();
+	ShaderWrapper* GetShader(const std::string&);
+
+	std::unordered_map<PipelineKey, PipelineHandle, PipelineKeyHash> mPipelines;
+	std::unordered_map<std::string, ShaderWrapper*> mShaders;
+	std::unordered_map<std::string, PipelineWrapper*> mComputePipelines;
+	std::mutex mComputeMutex;
+	std::vector<PipelineWrapper*> mRetiredPipelines;
+	std::vector<ShaderWrapper*> mRetiredShaders;		// Replaced modules, builds that started before the reload may still use them
+	std::mutex mMutex;
+	std::mutex mShaderMutex;
+	std::condition_variable mPipelineFinished;
+	std::atomic<uint64_t> mReadyGeneration;
+	PipelineRegistryStats mStats;
+
+	ThreadPool* mCompilePool;
+	DescriptorLayoutCache* mLayoutCache;
+
+	LogicalDeviceWrapper* mLogicalDevice;
+};
+#endif
@@ -2,257 +2,172 @@
 #include "globals.h"
 #include "LogicalDeviceWrapper.h"
 #include "ShaderWrapper.h"
+#include "ShaderReflection.h"
 #include "RenderPassWrapper.h"
 #include "Mesh.h"
 #include "DescriptorSetWrapper.h"
-
-PipelineWrapper::PipelineWrapper(LogicalDeviceWrapper* lDevice, RenderPassWrapper* renderpass, std::vector<DescriptorSetLayoutWrapper*> layouts) : mLogicalDevice(lDevice), mRenderPass(renderpass), mDescriptorSetLayouts(layouts) {
-	CreateDepthGraphicsPipeline();
-}
-
-PipelineWrapper::~PipelineWrapper() {
-	vkDestroyPipelineLayout(mLogicalDevice->GetLogicalDevice(), mPipelineLayout, nullptr);	std::cout << "Success: Pipeline Layout destroyed" << std::endl;
-	vkDestroyPipeline(mLogicalDevice->GetLogicalDevice(), mPipeline, nullptr);	std::cout << "Success: Pipeline destroyed" << std::endl;
-}
-
-VkPipeline PipelineWrapper::GetPipeline() {
-	return mPipeline;
+#include "PipelineCacheWrapper.h"
+#include "PipelineLayoutWrapper.h"
+
+static size_t HashBytes(size_t hash, const void* data, size_t size) {
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
 }
 
-VkPipelineLayout PipelineWrapper::GetPipelineLayout() {
-	return mPipelineLayout;
+template <typename T>
+static size_t HashField(size_t hash, const T& field) {
+	return HashBytes(hash, &field, sizeof(T));
 }
 
-void PipelineWrapper::CreateComputePipeline() {
+bool PipelineStateDescription::operator==(const PipelineStateDescription& other) const {
+	return mVertexShader == other.mVertexShader &&
+		mFragmentShader == other.mFragmentShader &&
+		mTopology == other.mTopology &&
+		mPolygonMode == other.mPolygonMode &&
+		mCullMode == other.mCullMode &&
+		mFrontFace == other.mFrontFace &&
+		mDepthTestEnable == other.mDepthTestEnable &&
+		mDepthWriteEnable == other.mDepthWriteEnable &&
+		mDepthCompareOp == other.mDepthCompareOp &&
+		mBlendEnable == other.mBlendEnable &&
+		mSrcColorBlendFactor == other.mSrcColorBlendFactor &&
+		mDstColorBlendFactor == other.mDstColorBlendFactor &&
+		mColorBlendOp == other.mColorBlendOp &&
+		mSrcAlphaBlendFactor == other.mSrcAlphaBlendFactor &&
+		mDstAlphaBlendFactor == other.mDstAlphaBlendFactor &&
+		mAlphaBlendOp == other.mAlphaBlendOp &&
+		mSpecialization == other.mSpecialization;
 }
 
-void PipelineWrapper::CreateGenericGraphicsPipeline() {
-	// Grab the shader file locations
-	std::vector<std::string> shaderFileNames = {
-		".\\Resources\\Shaders\\simple.vert.spv",
-		".\\Resources\\Shaders\\simple.frag.spv"
-	};
-
-	// Initialize ShaderWrapper classes
-	std::vector<ShaderWrapper*> mShaders(shaderFileNames.size());
-	for (size_t i = 0; i < shaderFileNames.size(); i++) {
-		mShaders.at(i) = new ShaderWrapper(mLogicalDevice, shaderFileNames[i]);
-	}
-
-	// Create the shader stage create info structs
-	std::vector<VkPipelineShaderStageCreateInfo> shaderStageCIs(mShaders.size());
-	for (size_t i = 0; i < mShaders.size(); i++) {
-		shaderStageCIs.at(i) = mShaders.at(i)->GetShaderCI();
+size_t PipelineStateDescription::Hash() const {
+	size_t hash = 14695981039346656037ull;
+	hash = HashBytes(hash, mVertexShader.data(), mVertexShader.size());
+	hash = HashField(hash, mVertexShader.size());
+	hash = HashBytes(hash, mFragmentShader.data(), mFragmentShader.size());
+	hash = HashField(hash, mFragmentShader.size());
+	hash = HashField(hash, mTopology);
+	hash = HashField(hash, mPolygonMode);
+	hash = HashField(hash, mCullMode);
+	hash = HashField(hash, mFrontFace);
+	hash = HashField(hash, mDepthTestEnable);
+	hash = HashField(hash, mDepthWriteEnable);
+	hash = HashField(hash, mDepthCompareOp);
+	hash = HashField(hash, mBlendEnable);
+	hash = HashField(hash, mSrcColorBlendFactor);
+	hash = HashField(hash, mDstColorBlendFactor);
+	hash = HashField(hash, mColorBlendOp);
+	hash = HashField(hash, mSrcAlphaBlendFactor);
+	hash = HashField(hash, mDstAlphaBlendFactor);
+	hash = HashField(hash, mAlphaBlendOp);
+	for (auto& constant : mSpecialization) {
+		hash = HashField(hash, constant.first);
+		hash = HashField(hash, constant.second);
 	}
+	return hash;
+}
 
-	// Describe the data for a single vertex as a whole
-	VkVertexInputBindingDescription vertexInputBindingDescription = {
-		0,																	// binding
-		sizeof(Vertex),														// stride
-		VK_VERTEX_INPUT_RATE_VERTEX											// inputRate
-	};
-
-	// Create a vector to hold all the attributes contained for a single vertex
-	std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
-
-	// Describe the position attribute
-	attributeDescriptions.push_back(
-		{
-			0,																// location
-			vertexInputBindingDescription.binding,							// binding
-			VK_FORMAT_R32G32B32_SFLOAT,										// format
-			offsetof(Vertex, mPosition)										// offset
-		}
-	);
-
-	// Describe the color attribute
-	attributeDescriptions.push_back(
-		{
-			1,																// location
-			vertexInputBindingDescription.binding,							// binding
-			VK_FORMAT_R32G32B32_SFLOAT,										// format
-			offsetof(Vertex, mColor)										// offset
-		}
-	);
-
-	// Create the vertex input state create info struct
-	VkPipelineVertexInputStateCreateInfo vertexInputCI = {
-		VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,			// sType
-		nullptr,															// pNext
-		0,																	// flags
-		1,																	// vertexBindingDescriptionCount
-		&vertexInputBindingDescription,										// pVertexBindingDescriptions
-		(uint32_t)attributeDescriptions.size(),								// vertexAttributeDescriptionCount
-		attributeDescriptions.data()										// pVertexAttributeDescriptions
-	};
-
-	// Create the input assembly state create info struct
-	VkPipelineInputAssemblyStateCreateInfo inputAssemblyCI = {
-		VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,		// sType
-		nullptr,															// pNext
-		0,																	// flags
-		VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,								// topology
-		VK_FALSE															// primitiveRestartEnable
-	};
-
-	// Create the viewport state create info struct
-	VkViewport viewport = {
-		0.0f,																// x
-		0.0f,																// y
-		(float)WINDOW_WIDTH,												// width
-		(float)WINDOW_HEIGHT,												// height
-		0.0f,																// minDepth
-		1.0f																// maxDepth
-	};
-	VkRect2D scissor {
-		{0, 0 },
-		{ WINDOW_WIDTH, WINDOW_HEIGHT }
-	};
-	VkPipelineViewportStateCreateInfo viewportCI = {
-		VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,				// sType
-		nullptr,															// pNext
-		0,																	// flags
-		1,																	// viewportCount
-		&viewport,															// pViewports
-		1,																	// scissorCount
-		&scissor															// pScissors
-	};
-
-	// Create the rasterization state create info struct
-	VkPipelineRasterizationStateCreateInfo rasterizerCI = {
-		VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,			// sType
-		nullptr,															// pNext
-		0,																	// flags
-		VK_FALSE,															// depthClampEnable
-		VK_FALSE,															// rasterizerDiscardEnable
-		VK_POLYGON_MODE_FILL,												// polygonMode
-		VK_CULL_MODE_NONE,													// cullMode
-		VK_FRONT_FACE_COUNTER_CLOCKWISE,									// frontFace
-		VK_FALSE,															// depthBiasEnable
-		0.0f,																// depthBiasConstantFactor
-		0.0f,																// depthBiasClamp
-		0.0f,																// depthBiasSlopeFactor
-		1.0f																// lineWidth
+PipelineStateDescription DefaultPipelineState() {
+	return {
+		.mVertexShader = "./Resources/Shaders/simple.vert.spv",
+		.mFragmentShader = "./Resources/Shaders/simple.frag.spv",
+		.mTopology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+		.mPolygonMode = VK_POLYGON_MODE_FILL,
+		.mCullMode = VK_CULL_MODE_NONE,
+		.mFrontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+		.mDepthTestEnable = VK_TRUE,
+		.mDepthWriteEnable = VK_TRUE,
+		.mDepthCompareOp = VK_COMPARE_OP_LESS,
+		.mBlendEnable = VK_TRUE,
+		.mSrcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
+		.mDstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+		.mColorBlendOp = VK_BLEND_OP_ADD,
+		.mSrcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+		.mDstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
+		.mAlphaBlendOp = VK_BLEND_OP_ADD,
+		.mSpecialization = { { SPEC_USE_TEXTURE, VK_FALSE } }
 	};
+}
 
-	// Create the multisample state create info struct
-	VkPipelineMultisampleStateCreateInfo multiSamplingCI = {
-		VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,			// sType
-		nullptr,															// pNext
-		0,																	// flags
-		VK_SAMPLE_COUNT_1_BIT,												// rasterizationSamples
-		VK_FALSE,															// sampleShadingEnable
-		1.0f,																// minSampleShading
-		nullptr,															// pSampleMask
-		VK_FALSE,															// alphaToCoverageEnable
-		VK_FALSE															// alphaToOneEnable
-	};
+PipelineWrapper::PipelineWrapper(LogicalDeviceWrapper* lDevice, RenderPassWrapper* renderpass, PipelineLayoutWrapper* layout, PipelineStateDescription description, std::vector<ShaderWrapper*> shaders) : mDescription(description), mLogicalDevice(lDevice), mRenderPass(renderpass), mPipelineLayout(layout) {
+	mBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	CreateGraphicsPipeline(shaders);
+}
 
-	// Create the depth stencil state create info struct
-	// TODO: Implement later
+PipelineWrapper::PipelineWrapper(LogicalDeviceWrapper* lDevice, PipelineLayoutWrapper* layout, ShaderWrapper* shader) : mDescription(), mLogicalDevice(lDevice), mRenderPass(nullptr), mPipelineLayout(layout) {
+	mBindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
+	CreateComputePipeline(shader);
+}
 
-	// Create the color blend attachment state struct
-	VkPipelineColorBlendAttachmentState colorBlendAttachment = {
-		VK_TRUE,															// blendEnable
-		VK_BLEND_FACTOR_SRC_ALPHA,											// srcColorBlendFactor
-		VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,								// dstColorBlendFactor
-		VK_BLEND_OP_ADD,													// colorBlendOp
-		VK_BLEND_FACTOR_ONE,												// srcAlphaBlendFactor
-		VK_BLEND_FACTOR_ZERO,												// dstAlphaBlendFactor
-		VK_BLEND_OP_ADD,													// alphaBlendOp
-		VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |				// colorWriteMask
-		VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
-	};
-	VkPipelineColorBlendStateCreateInfo colorBlendCI = {
-		VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,			// sType
-		nullptr,															// pNext
-		0,																	// flags
-		VK_FALSE,															// logicOpEnable
-		VK_LOGIC_OP_COPY,													// logicOp
-		1,																	// attachmentCount
-		&colorBlendAttachment,												// pAttachments
-		{ 0.0f, 0.0f, 0.0f, 0.0f }											// blendConstants
-	};
+PipelineWrapper::~PipelineWrapper() {
+	vkDestroyPipeline(mLogicalDevice->GetLogicalDevice(), mPipeline, nullptr);	std::cout << "Success: Pipeline destroyed" << std::endl;
+}
 
-	// Create the pipeline layout create info struct
+VkPipeline PipelineWrapper::GetPipeline() {
+	return mPipeline;
+}
 
-	std::vector<VkDescriptorSetLayout> layouts;
+VkPipelineLayout PipelineWrapper::GetPipelineLayout() {
+	return mPipelineLayout->GetPipelineLayout();
+}
 
-	for (auto& layout : mDescriptorSetLayouts) {
-		layouts.push_back(layout->GetDescriptorSetLayout());
-	}
+VkPipelineBindPoint PipelineWrapper::GetBindPoint() {
+	return mBindPoint;
+}
 
-	VkPipelineLayoutCreateInfo pipelineLayoutCI = {
-		VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,						// sType
-		nullptr,															// pNext
-		0,																	// flags
-		(uint32_t)layouts.size(),											// setLayoutCount
-		layouts.data(),														// pSetLayouts
-		0,																	// pushConstantRangeCount
-		nullptr																// pPushConstantRanges
-	};
+PipelineStateDescription PipelineWrapper::GetDescription() {
+	return mDescription;
+}
 
-	// Create the pipeline layout
-	VkResult result = vkCreatePipelineLayout(mLogicalDevice->GetLogicalDevice(), &pipelineLayoutCI, nullptr, &mPipelineLayout);
-	if (result == VK_SUCCESS) {
-		std::cout << "Success: Pipeline layout created." << std::endl;
-	} else {
-		throw std::runtime_error("Failed to create a pipeline layout! Error Code: " + NT_CHECK_RESULT(result));
+void PipelineWrapper::CreateComputePipeline(ShaderWrapper* shader) {
+	if (shader->GetReflection()->GetStage() != VK_SHADER_STAGE_COMPUTE_BIT) {
+		throw std::runtime_error("Failed to create compute pipeline! Shader is not a compute shader.");
 	}
 
-	// Create the graphics pipeline create info struct
-	VkGraphicsPipelineCreateInfo graphicsPipelineCI = {
-		VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,					// sType
-		nullptr,															// pNext
-		0,																	// flags
-		(uint32_t)shaderStageCIs.size(),									// stageCount
-		shaderStageCIs.data(),												// pStages
-		&vertexInputCI,														// pVertexInputState
-		&inputAssemblyCI,													// pInputAssemblyState
-		nullptr,															// pTessellationState
-		&viewportCI,														// pViewportState
-		&rasterizerCI,														// pRasterizationState
-		&multiSamplingCI,													// pMultisampleState
-		nullptr,															// pDepthStencilState
-		&colorBlendCI,														// pColorBlendState
-		nullptr,															// pDynamicState
-		mPipelineLayout,													// layout
-		mRenderPass->GetRenderPass(),										// renderPass
-		0,																	// subpass						TODO: Figure out how to calculate instead of hard-code
-		VK_NULL_HANDLE,														// basePipelineHandle
-		-1																	// basePipelineIndex
+	VkComputePipelineCreateInfo computePipelineCI = {
+		.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+		.pNext = nullptr,
+		.flags = 0,
+		.stage = shader->GetShaderCI(nullptr),
+		.layout = mPipelineLayout->GetPipelineLayout(),
+		.basePipelineHandle = VK_NULL_HANDLE,
+		.basePipelineIndex = -1
 	};
 
-	result = vkCreateGraphicsPipelines(mLogicalDevice->GetLogicalDevice(), VK_NULL_HANDLE, 1, &graphicsPipelineCI, nullptr, &mPipeline);
+	VkResult result = mLogicalDevice->GetPipelineCache()->CreateComputePipeline(computePipelineCI, &mPipeline);
 	if (result == VK_SUCCESS) {
-		std::cout << "Success: Graphics pipeline created." << std::endl;
+		std::cout << "Success: Compute pipeline created." << std::endl;
 	} else {
-		throw std::runtime_error("Failed to create graphics pipeline! Error Code: " + NT_CHECK_RESULT(result));
-	}
-
-	// Destroy Shader Modules, since graphics pipeline has been created
-	for (size_t i = 0; i < mShaders.size(); i++) {
-		vkDestroyShaderModule(mLogicalDevice->GetLogicalDevice(), mShaders.at(i)->GetShaderModule(), nullptr);	std::cout << "Success: Shader module destroyed." << std::endl;
+		throw std::runtime_error("Failed to create compute pipeline! Error Code: " + NT_CHECK_RESULT(result));
 	}
 }
 
-void PipelineWrapper::CreateDepthGraphicsPipeline() {
-	// Grab the shader file locations
-	std::vector<std::string> shaderFileNames = {
-		".\\Resources\\Shaders\\simple.vert.spv",
-		".\\Resources\\Shaders\\simple.frag.spv"
-	};
-
-	// Initialize ShaderWrapper classes
-	std::vector<ShaderWrapper*> mShaders(shaderFileNames.size());
-	for (size_t i = 0; i < shaderFileNames.size(); i++) {
-		mShaders.at(i) = new ShaderWrapper(mLogicalDevice, shaderFileNames[i]);
+void PipelineWrapper::CreateGraphicsPipeline(std::vector<ShaderWrapper*> shaders) {
+	// One specialization info for all stages, entries for constants a stage doesn't declare are ignored
+	std::vector<VkSpecializationMapEntry> specializationEntries;
+	std::vector<uint32_t> specializationData;
+	for (auto& constant : mDescription.mSpecialization) {
+		specializationEntries.push_back({
+			.constantID = constant.first,
+			.offset = (uint32_t)(specializationData.size() * sizeof(uint32_t)),
+			.size = sizeof(uint32_t)
+		});
+		specializationData.push_back(constant.second);
 	}
+	VkSpecializationInfo specializationInfo = {
+		.mapEntryCount = (uint32_t)specializationEntries.size(),
+		.pMapEntries = specializationEntries.data(),
+		.dataSize = specializationData.size() * sizeof(uint32_t),
+		.pData = specializationData.data()
+	};
 
 	// Create the shader stage create info structs
-	std::vector<VkPipelineShaderStageCreateInfo> shaderStageCIs(mShaders.size());
-	for (size_t i = 0; i < mShaders.size(); i++) {
-		shaderStageCIs.at(i) = mShaders.at(i)->GetShaderCI();
+	std::vector<VkPipelineShaderStageCreateInfo> shaderStageCIs(shaders.size());
+	for (size_t i = 0; i < shaders.size(); i++) {
+		shaderStageCIs.at(i) = shaders.at(i)->GetShaderCI(specializationEntries.empty() ? nullptr : &specializationInfo);
 	}
 
 	// Describe the data for a single vertex as a whole
@@ -262,38 +177,27 @@ void PipelineWrapper::CreateDepthGraphicsPipeline() {
 		VK_VERTEX_INPUT_RATE_VERTEX											// inputRate
 	};
 
-	// Create a vector to hold all the attributes contained for a single vertex
+	// One attribute per input the vertex shader actually reads, in the format it declares
 	std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
-
-	// Describe the position attribute
-	attributeDescriptions.push_back(
-		{
-			.location = 0,
-			.binding = vertexInputBindingDescription.binding,
-			.format = VK_FORMAT_R32G32B32A32_SFLOAT,
-			.offset = offsetof(Vertex, mPosition)
-		}
-	);
-
-	// Describe the color attribute
-	attributeDescriptions.push_back(
-		{
-			.location = 1,
-			.binding = vertexInputBindingDescription.binding,
-			.format = VK_FORMAT_R32G32B32A32_SFLOAT,
-			.offset = offsetof(Vertex, mColor)
+	for (size_t i = 0; i < shaders.size(); i++) {
+		ShaderReflection* reflection = shaders.at(i)->GetReflection();
+		if (reflection->GetStage() != VK_SHADER_STAGE_VERTEX_BIT) {
+			continue;
 		}
-	);
 
-	// Describe the UV attributs
-	attributeDescriptions.push_back(
-		{
-			.location = 2,
-			.binding = vertexInputBindingDescription.binding,
-			.format = VK_FORMAT_R32G32_SFLOAT,
-			.offset = offsetof(Vertex, mUV)
+		std::vector<ReflectedInput> inputs = reflection->GetInputs();
+		for (size_t j = 0; j < inputs.size(); j++) {
+			if (inputs.at(j).mLocation >= sizeof(VERTEX_ATTRIBUTE_OFFSETS) / sizeof(VERTEX_ATTRIBUTE_OFFSETS[0])) {
+				throw std::runtime_error("Failed to create graphics pipeline! Vertex has no attribute at location " + std::to_string(inputs.at(j).mLocation) + ".");
+			}
+			attributeDescriptions.push_back({
+				.location = inputs.at(j).mLocation,
+				.binding = vertexInputBindingDescription.binding,
+				.format = inputs.at(j).mFormat,
+				.offset = VERTEX_ATTRIBUTE_OFFSETS[inputs.at(j).mLocation]
+			});
 		}
-	);
+	}
 
 	// Create the vertex input state create info struct
 	VkPipelineVertexInputStateCreateInfo vertexInputCI = {
@@ -311,31 +215,27 @@ void PipelineWrapper::CreateDepthGraphicsPipeline() {
 		VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,		// sType
 		nullptr,															// pNext
 		0,																	// flags
-		VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,								// topology
+		mDescription.mTopology,												// topology
 		VK_FALSE															// primitiveRestartEnable
 	};
 
-	// Create the viewport state create info struct
-	VkViewport viewport = {
-		0.0f,																// x
-		0.0f,																// y
-		(float)WINDOW_WIDTH,												// width
-		(float)WINDOW_HEIGHT,												// height
-		0.0f,																// minDepth
-		1.0f																// maxDepth
-	};
-	VkRect2D scissor{
-		{0, 0 },
-		{ WINDOW_WIDTH, WINDOW_HEIGHT }
-	};
+	// Viewport and scissor are dynamic so the pipeline survives swapchain resizes. Only the counts matter here.
 	VkPipelineViewportStateCreateInfo viewportCI = {
 		VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,				// sType
 		nullptr,															// pNext
 		0,																	// flags
 		1,																	// viewportCount
-		&viewport,															// pViewports
+		nullptr,															// pViewports
 		1,																	// scissorCount
-		&scissor															// pScissors
+		nullptr																// pScissors
+	};
+	std::vector<VkDynamicState> dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+	VkPipelineDynamicStateCreateInfo dynamicStateCI = {
+		VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,				// sType
+		nullptr,															// pNext
+		0,																	// flags
+		(uint32_t)dynamicStates.size(),										// dynamicStateCount
+		dynamicStates.data()												// pDynamicStates
 	};
 
 	// Create the rasterization state create info struct
@@ -345,9 +245,9 @@ void PipelineWrapper::CreateDepthGraphicsPipeline() {
 		0,																	// flags
 		VK_FALSE,															// depthClampEnable
 		VK_FALSE,															// rasterizerDiscardEnable
-		VK_POLYGON_MODE_FILL,												// polygonMode
-		VK_CULL_MODE_NONE, //VK_CULL_MODE_BACK_BIT,							// cullMode
-		VK_FRONT_FACE_COUNTER_CLOCKWISE,									// frontFace
+		mDescription.mPolygonMode,											// polygonMode
+		mDescription.mCullMode,												// cullMode
+		mDescription.mFrontFace,											// frontFace
 		VK_FALSE,															// depthBiasEnable
 		0.0f,																// depthBiasConstantFactor
 		0.0f,																// depthBiasClamp
@@ -382,9 +282,9 @@ void PipelineWrapper::CreateDepthGraphicsPipeline() {
 		VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,			// sType
 		nullptr,															// pNext
 		0,																	// flags
-		VK_TRUE,															// depthTestEnable
-		VK_TRUE,															// depthWriteEnable
-		VK_COMPARE_OP_LESS,													// depthCompareOp
+		mDescription.mDepthTestEnable,										// depthTestEnable
+		mDescription.mDepthWriteEnable,										// depthWriteEnable
+		mDescription.mDepthCompareOp,										// depthCompareOp
 		VK_FALSE,															// depthBoundsTestEnable
 		VK_FALSE,															// stencilTestEnable
 		defaultStencilOpState,												// front
@@ -395,13 +295,13 @@ void PipelineWrapper::CreateDepthGraphicsPipeline() {
 
 	// Create the color blend attachment state struct
 	VkPipelineColorBlendAttachmentState colorBlendAttachment = {
-		VK_TRUE,															// blendEnable
-		VK_BLEND_FACTOR_SRC_ALPHA,											// srcColorBlendFactor
-		VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,								// dstColorBlendFactor
-		VK_BLEND_OP_ADD,													// colorBlendOp
-		VK_BLEND_FACTOR_ONE,												// srcAlphaBlendFactor
-		VK_BLEND_FACTOR_ZERO,												// dstAlphaBlendFactor
-		VK_BLEND_OP_ADD,													// alphaBlendOp
+		mDescription.mBlendEnable,											// blendEnable
+		mDescription.mSrcColorBlendFactor,									// srcColorBlendFactor
+		mDescription.mDstColorBlendFactor,									// dstColorBlendFactor
+		mDescription.mColorBlendOp,											// colorBlendOp
+		mDescription.mSrcAlphaBlendFactor,									// srcAlphaBlendFactor
+		mDescription.mDstAlphaBlendFactor,									// dstAlphaBlendFactor
+		mDescription.mAlphaBlendOp,											// alphaBlendOp
 		VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |				// colorWriteMask
 		VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
 	};
@@ -416,32 +316,6 @@ void PipelineWrapper::CreateDepthGraphicsPipeline() {
 		{ 0.0f, 0.0f, 0.0f, 0.0f }											// blendConstants
 	};
 
-	// Create the pipeline layout create info struct
-
-	std::vector<VkDescriptorSetLayout> layouts;
-
-	for (auto& layout : mDescriptorSetLayouts) {
-		layouts.push_back(layout->GetDescriptorSetLayout());
-	}
-
-	VkPipelineLayoutCreateInfo pipelineLayoutCI = {
-		VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,						// sType
-		nullptr,															// pNext
-		0,																	// flags
-		(uint32_t)layouts.size(),											// setLayoutCount
-		layouts.data(),														// pSetLayouts
-		0,																	// pushConstantRangeCount
-		nullptr																// pPushConstantRanges
-	};
-
-	// Create the pipeline layout
-	VkResult result = vkCreatePipelineLayout(mLogicalDevice->GetLogicalDevice(), &pipelineLayoutCI, nullptr, &mPipelineLayout);
-	if (result == VK_SUCCESS) {
-		std::cout << "Success: Pipeline layout created." << std::endl;
-	} else {
-		throw std::runtime_error("Failed to create a pipeline layout! Error Code: " + NT_CHECK_RESULT(result));
-	}
-
 	// Create the graphics pipeline create info struct
 	VkGraphicsPipelineCreateInfo graphicsPipelineCI = {
 		VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,					// sType
@@ -457,23 +331,18 @@ void PipelineWrapper::CreateDepthGraphicsPipeline() {
 		&multiSamplingCI,													// pMultisampleState
 		&depthStencilCI,													// pDepthStencilState
 		&colorBlendCI,														// pColorBlendState
-		nullptr,															// pDynamicState
-		mPipelineLayout,													// layout
+		&dynamicStateCI,													// pDynamicState
+		mPipelineLayout->GetPipelineLayout(),								// layout
 		mRenderPass->GetRenderPass(),										// renderPass
 		0,																	// subpass						TODO: Figure out how to calculate instead of hard-code
 		VK_NULL_HANDLE,														// basePipelineHandle
 		-1																	// basePipelineIndex
 	};
 
-	result = vkCreateGraphicsPipelines(mLogicalDevice->GetLogicalDevice(), VK_NULL_HANDLE, 1, &graphicsPipelineCI, nullptr, &mPipeline);
+	VkResult result = mLogicalDevice->GetPipelineCache()->CreateGraphicsPipeline(graphicsPipelineCI, &mPipeline);
 	if (result == VK_SUCCESS) {
 		std::cout << "Success: Graphics pipeline created." << std::endl;
 	} else {
 		throw std::runtime_error("Failed to create graphics pipeline! Error Code: " + NT_CHECK_RESULT(result));
 	}
-
-	// Destroy Shader Modules, since graphics pipeline has been created
-	for (size_t i = 0; i < mShaders.size(); i++) {
-		vkDestroyShaderModule(mLogicalDevice->GetLogicalDevice(), mShaders.at(i)->GetShaderModule(), nullptr);	std::cout << "Success: Shader module destroyed." << std::endl;
-	}
 }
\ No newline at end of file
@@ -3,37 +3,90 @@
 
 #include <string>
 #include <vector>
+#include <map>
 #include <vulkan/vulkan.h>
 
 class LogicalDeviceWrapper;
 class ShaderWrapper;
 class RenderPassWrapper;
-class DescriptorSetLayoutWrapper;
+class PipelineLayoutWrapper;
+
+// constant_id values the shaders declare their specialization constants with
+enum SPECIALIZATION_CONSTANT {
+	SPEC_USE_TEXTURE = 0								// simple.frag: sample the texture instead of using the vertex color
+};
+
+/*
+
+	Everything about a graphics pipeline that can differ between materials. Viewport and scissor are
+	dynamic and the vertex layout is always Vertex, so neither is part of it.
+
+	Notes:
+		- Hash() is FNV-1a over every field. Fields are hashed one by one so padding never leaks in.
+		- DefaultPipelineState() is what every mesh starts out with: simple.vert / simple.frag, no
+		  culling, depth test and write, alpha blending, untextured.
+		- mSpecialization maps constant_id to a 32 bit value (VkBool32, int or float bits) and is handed
+		  to every stage. Feature toggles in a shader compile to separate branch free pipelines from one
+		  source, and since the values are part of the state they're part of the registry key too.
+
+*/
+struct PipelineStateDescription {
+	std::string mVertexShader;
+	std::string mFragmentShader;
+	VkPrimitiveTopology mTopology;
+	VkPolygonMode mPolygonMode;
+	VkCullModeFlags mCullMode;
+	VkFrontFace mFrontFace;
+	VkBool32 mDepthTestEnable;
+	VkBool32 mDepthWriteEnable;
+	VkCompareOp mDepthCompareOp;
+	VkBool32 mBlendEnable;
+	VkBlendFactor mSrcColorBlendFactor;
+	VkBlendFactor mDstColorBlendFactor;
+	VkBlendOp mColorBlendOp;
+	VkBlendFactor mSrcAlphaBlendFactor;
+	VkBlendFactor mDstAlphaBlendFactor;
+	VkBlendOp mAlphaBlendOp;
+	std::map<uint32_t, uint32_t> mSpecialization;
+
+	bool operator==(const PipelineStateDescription&) const;
+	size_t Hash() const;
+};
+
+PipelineStateDescription DefaultPipelineState();
 
 /*
 
-	TODO: Implement CreateComputePipeline() function
+	Notes:
+		- A PipelineWrapper is one immutable VkPipeline built from a PipelineStateDescription. It owns
+		  neither the layout nor the shader modules, the PipelineRegistry does. Don't create these
+		  directly, ask the registry.
+		- The constructor without a render pass builds a compute pipeline from a single .comp shader.
+		  Its description is left empty, GetBindPoint() tells the two kinds apart.
 
 */
 
 class PipelineWrapper {
 public:
-	PipelineWrapper(LogicalDeviceWrapper*, RenderPassWrapper*, std::vector<DescriptorSetLayoutWrapper*>);
+	PipelineWrapper(LogicalDeviceWrapper*, RenderPassWrapper*, PipelineLayoutWrapper*, PipelineStateDescription, std::vector<ShaderWrapper*>);
+	PipelineWrapper(LogicalDeviceWrapper*, PipelineLayoutWrapper*, ShaderWrapper*);
 	~PipelineWrapper();
 
 	VkPipeline GetPipeline();
 	VkPipelineLayout GetPipelineLayout();
+	VkPipelineBindPoint GetBindPoint();
+	PipelineStateDescription GetDescription();
 private:
-	void CreateComputePipeline();
-	void CreateGenericGraphicsPipeline();
-	void CreateDepthGraphicsPipeline();
+	void CreateComputePipeline(ShaderWrapper*);
+	void CreateGraphicsPipeline(std::vector<ShaderWrapper*>);
 
 	VkPipeline mPipeline;
-	VkPipelineLayout mPipelineLayout;
+	VkPipelineBindPoint mBindPoint;
+	PipelineStateDescription mDescription;
 
 	LogicalDeviceWrapper* mLogicalDevice;
 	RenderPassWrapper* mRenderPass;
-	std::vector<DescriptorSetLayoutWrapper*> mDescriptorSetLayouts;
+	PipelineLayoutWrapper* mPipelineLayout;
 };
 
 #endif
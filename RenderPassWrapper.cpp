@@ -3,7 +3,13 @@
 #include "SurfaceWrapper.h"
 #include "LogicalDeviceWrapper.h"
 
-RenderPassWrapper::RenderPassWrapper(LogicalDeviceWrapper* lDevice, SurfaceWrapper* surface) : mLogicalDevice(lDevice), mSurface(surface) {
+RenderPassWrapper::RenderPassWrapper(LogicalDeviceWrapper* lDevice, SurfaceWrapper* surface) : mLogicalDevice(lDevice) {
+	mColorFormat = surface->GetBestSurfaceFormat().format;
+	mFinalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	CreateDepthRenderPass();
+}
+
+RenderPassWrapper::RenderPassWrapper(LogicalDeviceWrapper* lDevice, VkFormat colorFormat, VkImageLayout finalLayout) : mColorFormat(colorFormat), mFinalLayout(finalLayout), mLogicalDevice(lDevice) {
 	CreateDepthRenderPass();
 }
 
@@ -20,14 +26,14 @@ void RenderPassWrapper::CreateGenericRenderPass() {
 	// - Color Attachment
 	VkAttachmentDescription colorAttachment {
 		0,																			// flags
-		mSurface->GetBestSurfaceFormat().format,									// format
+		mColorFormat,																// format
 		VK_SAMPLE_COUNT_1_BIT,														// samples
 		VK_ATTACHMENT_LOAD_OP_CLEAR,												// loadOp
 		VK_ATTACHMENT_STORE_OP_STORE,												// storeOp
 		VK_ATTACHMENT_LOAD_OP_DONT_CARE,											// stencilLoadOp
 		VK_ATTACHMENT_STORE_OP_DONT_CARE,											// stencilStoreOp
 		VK_IMAGE_LAYOUT_UNDEFINED,													// initialLayout
-		VK_IMAGE_LAYOUT_PRESENT_SRC_KHR												// finalLayout
+		mFinalLayout																// finalLayout
 	};
 
 	// Put Attachments together in a vector
@@ -109,14 +115,14 @@ void RenderPassWrapper::CreateDepthRenderPass() {
 	// - Color Attachment
 	VkAttachmentDescription colorAttachment {
 		0,																			// flags
-		mSurface->GetBestSurfaceFormat().format,									// format
+		mColorFormat,																// format
 		VK_SAMPLE_COUNT_1_BIT,														// samples
 		VK_ATTACHMENT_LOAD_OP_CLEAR,												// loadOp
 		VK_ATTACHMENT_STORE_OP_STORE,												// storeOp
 		VK_ATTACHMENT_LOAD_OP_DONT_CARE,											// stencilLoadOp
 		VK_ATTACHMENT_STORE_OP_DONT_CARE,											// stencilStoreOp
 		VK_IMAGE_LAYOUT_UNDEFINED,													// initialLayout
-		VK_IMAGE_LAYOUT_PRESENT_SRC_KHR												// finalLayout
+		mFinalLayout																// finalLayout
 	};
 
 	VkAttachmentDescription depthAttachment{
@@ -185,6 +191,12 @@ void RenderPassWrapper::CreateDepthRenderPass() {
 		0																			// dependencyFlags
 	};
 
+	// A pass that ends in TRANSFER_SRC is followed by a copy out of the color attachment
+	if (mFinalLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
+		secondSubpassDependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		secondSubpassDependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	}
+
 	// Put Subpass Dependencies in a vector
 	std::vector<VkSubpassDependency> subpassDependencies = { firstSubpassDependency, secondSubpassDependency };
 
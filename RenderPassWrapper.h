@@ -8,13 +8,17 @@ class LogicalDeviceWrapper;
 
 /*
 
-	
+	Notes:
+		- The color attachment's format and final layout are fixed at creation. With a surface they
+		  come from the swapchain (PRESENT_SRC), headless it's HEADLESS_COLOR_FORMAT ending in
+		  TRANSFER_SRC so the image can be read back right after the pass.
 
 */
 
 class RenderPassWrapper {
 public:
 	RenderPassWrapper(LogicalDeviceWrapper*, SurfaceWrapper*);
+	RenderPassWrapper(LogicalDeviceWrapper*, VkFormat, VkImageLayout);
 	~RenderPassWrapper();
 
 	VkRenderPass GetRenderPass();
@@ -23,9 +27,10 @@ private:
 	void CreateDepthRenderPass();
 
 	VkRenderPass mRenderPass;
+	VkFormat mColorFormat;
+	VkImageLayout mFinalLayout;
 
 	LogicalDeviceWrapper* mLogicalDevice;
-	SurfaceWrapper* mSurface;
 
 };
 
@@ -1,63 +1,164 @@
 #include "Renderer.h"
 #include "globals.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
 #include "WindowWrapper.h"
 #include "InstanceWrapper.h"
 #include "SurfaceWrapper.h"
 #include "PhysicalDeviceWrapper.h"
 #include "LogicalDeviceWrapper.h"
 #include "SwapchainWrapper.h"
+#include "OffscreenTarget.h"
+#include "ImageWriter.h"
+#include "FrameStreamer.h"
 #include "ShaderWrapper.h"
 #include "RenderPassWrapper.h"
 #include "PipelineWrapper.h"
+#include "PipelineLayoutWrapper.h"
+#include "PipelineRegistry.h"
 #include "FramebufferWrapper.h"
 #include "CommandPoolWrapper.h"
 #include "CommandBufferWrapper.h"
 #include "SynchronizationWrapper.h"
 #include "BufferWrapper.h"
 #include "Mesh.h"
+#include "ModelImporter.h"
+#include "CookedModel.h"
 #include "DescriptorSetWrapper.h"
+#include "DescriptorAllocator.h"
+#include "DescriptorSetCache.h"
 #include "ImageWrapper.h"
 #include "ImageViewWrapper.h"
 #include "SamplerWrapper.h"
+#include "MemoryAllocator.h"
+#include "UniformRingBuffer.h"
+#include "BindlessTextureTable.h"
+#include "UploadContext.h"
+#include "ComputeContext.h"
+#include "ThreadPool.h"
+#include "FrameContext.h"
+#include "PipelineCacheWrapper.h"
+#include "ShaderCompiler.h"
+#include "ShaderWatcher.h"
 
-Renderer::Renderer(WindowWrapper* window) : mWindow(window) {
+Renderer::Renderer(WindowWrapper* window) : mWindow(window), mOffscreenTarget(nullptr) {
 	mInstance = new InstanceWrapper();
 	mSurface = new SurfaceWrapper(mWindow, mInstance);
 	mPhysicalDevice = new PhysicalDeviceWrapper(mInstance, mSurface);
 	mLogicalDevice = new LogicalDeviceWrapper(mPhysicalDevice);
 	mSwapchain = new SwapchainWrapper(mPhysicalDevice, mLogicalDevice, mSurface);
 	mRenderPass = new RenderPassWrapper(mLogicalDevice, mSurface);
-	mDescriptorSetLayout = new DescriptorSetLayoutWrapper(mLogicalDevice, DYNAMIC);
-	mTSDescriptorSetLayout = new DescriptorSetLayoutWrapper(mLogicalDevice, TEXTURE);
-	std::vector<DescriptorSetLayoutWrapper*> layouts = { mDescriptorSetLayout, mTSDescriptorSetLayout };
-	mPipeline = new PipelineWrapper(mLogicalDevice, mRenderPass, layouts);
-	mGraphicsCommandPool = new CommandPoolWrapper(mLogicalDevice, mPhysicalDevice->GetQueueFamilyIndices().mGraphics);
-	mTransferCommandPool = new CommandPoolWrapper(mLogicalDevice, mPhysicalDevice->GetQueueFamilyIndices().mTransfer);
-	mDescriptorPool = new DescriptorPoolWrapper(mLogicalDevice, DYNAMIC);
-	mTDescriptorPool = new DescriptorPoolWrapper(mLogicalDevice, TEXTURE);
-	mDepthImage = new ImageWrapper(mPhysicalDevice, mLogicalDevice, mGraphicsCommandPool, WINDOW_WIDTH, WINDOW_HEIGHT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-	mDepthImageView = new ImageViewWrapper(mLogicalDevice, mDepthImage->GetImage(), VK_FORMAT_D32_SFLOAT_S8_UINT, VK_IMAGE_ASPECT_DEPTH_BIT);
-	mTextureImage = new ImageWrapper(mPhysicalDevice, mLogicalDevice, mGraphicsCommandPool, ".\\Resources\\Textures\\container2.png");
-	mTextureImageView = new ImageViewWrapper(mLogicalDevice, mTextureImage->GetImage(), VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT);
-	allocateDynamicBufferTransferSpace();	// Figure out the spacing necessary for aligned memory access of dynamic buffers
-	for (size_t i = 0; i < mSwapchain->GetSwapchainImages().size(); i++) {
-		mFramebuffers.push_back(new FramebufferWrapper(mLogicalDevice, mSwapchain, mRenderPass, (int)i, mDepthImageView));
-		mCommandBuffers.push_back(new CommandBufferWrapper(mLogicalDevice, mGraphicsCommandPool));
-		mUniformBuffers.push_back(new BufferWrapper(mPhysicalDevice, mLogicalDevice, (VkDeviceSize)sizeof(mVP), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
-		mDynamicUniformBuffers.push_back(new BufferWrapper(mPhysicalDevice, mLogicalDevice, (VkDeviceSize)(mModelUniformAlignment * MAX_OBJECTS), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
-		mDescriptorSets.push_back(new DescriptorSetWrapper(mLogicalDevice, mDescriptorSetLayout, mDescriptorPool, DYNAMIC));
-		mDescriptorSets.at(i)->WriteDynamicDescriptorSet(mUniformBuffers.at(i), mDynamicUniformBuffers.at(i));
+	Initialize();
+}
+
+/*
+
+	Headless renderer, draws into an OffscreenTarget of the given size instead of a window. The render
+	pass leaves the color image in TRANSFER_SRC so the readback copy can follow it directly.
+
+*/
+Renderer::Renderer(uint32_t width, uint32_t height) : mWindow(nullptr), mSurface(nullptr), mSwapchain(nullptr) {
+	mInstance = new InstanceWrapper(true);
+	mPhysicalDevice = new PhysicalDeviceWrapper(mInstance, nullptr);
+	mLogicalDevice = new LogicalDeviceWrapper(mPhysicalDevice);
+	mOffscreenTarget = new OffscreenTarget(mPhysicalDevice, mLogicalDevice, width, height, HEADLESS_COLOR_FORMAT, MAX_FRAMES_IN_FLIGHT);
+	mRenderPass = new RenderPassWrapper(mLogicalDevice, HEADLESS_COLOR_FORMAT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+	Initialize();
+}
+
+Renderer::~Renderer() {
+	// Stop reloading before anything goes away
+	delete mShaderWatcher;
+	delete mShaderCompiler;
+	vkDeviceWaitIdle(mLogicalDevice->GetLogicalDevice());
+
+	// Batches still recording reference meshes, textures and user buffers, submit them while those exist
+	mUploadContext->Flush();
+	mComputeContext->Flush();
+
+	// The last few frames are still sitting in their readback buffers
+	if (mFrameStreamer != nullptr) {
+		try {
+			FlushFrameSink();
+		} catch (const std::runtime_error& e) {
+			std::cout << "Nocturne Error: " << e.what() << std::endl;
+		}
+		delete mFrameStreamer;
 	}
 
-	for (size_t i = 0; i < MAX_FRAMES_DRAW; i++) {
-		mImageAvailableSemaphores.push_back(new SemaphoreWrapper(mLogicalDevice));
-		mRenderFinishedSemaphores.push_back(new SemaphoreWrapper(mLogicalDevice));
-		mDrawFences.push_back(new FenceWrapper(mLogicalDevice, VK_FENCE_CREATE_SIGNALED_BIT));
+	// Don't forget to insert in reverse order
+	for (size_t i = 0; i < mMeshList.size(); i++) {
+		delete mMeshList.at(i);
 	}
-	mSampler = new SamplerWrapper(mLogicalDevice);
+	DeleteRetiredMeshes(true);
+	delete mBindlessTable;
+	delete mSampler;
+	DestroyFrameContexts();
+	delete mUniformRing;
+	delete mThreadPool;
+	for (size_t i = 0; i < mTextureImages.size(); i++) {
+		delete mTextureImageViews.at(i);
+		delete mTextureImages.at(i);
+	}
+	delete mDescriptorSetCache;
+	delete mDescriptorAllocator;
+	delete mUploadContext;
+	delete mComputeContext;
+	DestroySwapchainResources();
+	DeleteRetiredPipelines(true);
+	delete mPipelineRegistry;
+	delete mRenderPass;
+	delete mOffscreenTarget;
+	delete mSwapchain;
+	delete mLogicalDevice;
+	delete mPhysicalDevice;
+	delete mSurface;
+	delete mInstance;
+}
 
-	mTextureDescriptorSet = new DescriptorSetWrapper(mLogicalDevice, mTSDescriptorSetLayout, mTDescriptorPool, TEXTURE);
-	mTextureDescriptorSet->WriteTextureDescriptorSet(mTextureImageView, mSampler);
+/*
+
+	Everything past the instance, device and render pass is the same with or without a window.
+
+*/
+void Renderer::Initialize() {
+	// Half the cores for compiling, the other half are busy recording
+	mPipelineRegistry = new PipelineRegistry(mLogicalDevice, std::max(1u, std::thread::hardware_concurrency() / 2));
+	// Set 0 is the per-frame uniforms, set 1 the bindless texture table, as declared by simple.vert / simple.frag
+	mPipelineLayout = mPipelineRegistry->GetPipelineLayout(DefaultPipelineState());
+	mDescriptorSetLayout = mPipelineLayout->GetDescriptorSetLayout(0);
+	mFallbackPipeline = mPipelineRegistry->GetPipeline(DefaultPipelineState(), mPipelineLayout, mRenderPass);
+	mPipelineGeneration = mPipelineRegistry->GetReadyGeneration();
+	mShaderCompiler = nullptr;
+	mShaderWatcher = nullptr;
+	if (ENABLE_SHADER_HOT_RELOAD) {
+		mShaderCompiler = new ShaderCompiler(1);
+		mShaderWatcher = new ShaderWatcher(SHADER_DIRECTORY);
+	}
+	mUploadContext = new UploadContext(mPhysicalDevice, mLogicalDevice);
+	mComputeContext = new ComputeContext(mPhysicalDevice, mLogicalDevice);
+	mComputeWaitValue = 0;
+	mComputeWaitStages = 0;
+	mDescriptorAllocator = new DescriptorAllocator(mLogicalDevice, mDescriptorSetLayout->GetPoolSizes(1), MAX_FRAMES_IN_FLIGHT, false);
+	mDescriptorSetCache = new DescriptorSetCache(mLogicalDevice, mDescriptorAllocator);
+	mBindlessTable = new BindlessTextureTable(mLogicalDevice, mPipelineLayout->GetDescriptorSetLayout(1), 0, 1);
+	// One sampler for every texture, its LOD range covers any mip chain
+	mSampler = new SamplerWrapper(mLogicalDevice, 32);
+	mDefaultSamplerIndex = mBindlessTable->AddSampler(mSampler);
+	int containerTexture = AddTexture("./Resources/Textures/container2.png");
+	CreateSwapchainResources();
+	mSwapchainDirty = false;
+
+	mThreadPool = new ThreadPool(std::thread::hardware_concurrency());
+
+	// One region of the ring per possible frame in flight, each big enough for the view projection and MAX_OBJECTS models
+	VkDeviceSize uniformAlignment = mPhysicalDevice->GetPhysicalDeviceProperties().limits.minUniformBufferOffsetAlignment;
+	VkDeviceSize viewProjectionSize = (sizeof(UboViewProjection) + uniformAlignment - 1) & ~(uniformAlignment - 1);
+	VkDeviceSize modelSize = (sizeof(glm::mat4) + uniformAlignment - 1) & ~(uniformAlignment - 1);
+	mUniformRing = new UniformRingBuffer(mPhysicalDevice, mLogicalDevice, viewProjectionSize + modelSize * MAX_OBJECTS, MAX_FRAMES_IN_FLIGHT);
+
+	CreateFrameContexts(DEFAULT_FRAMES_IN_FLIGHT);
 
 	std::vector<Vertex> cubeVertices = {
 		{ {  1.0f, -1.0f,  1.0f }, { 1.0f, 0.0f, 0.0f } },
@@ -96,108 +197,156 @@ Renderer::Renderer(WindowWrapper* window) : mWindow(window) {
 		2, 3, 0
 	};
 
-	mMeshList.push_back(new Mesh(mPhysicalDevice, mLogicalDevice, mTransferCommandPool, &cubeVertices, &cubeIndices));
-	mMeshList.push_back(new Mesh(mPhysicalDevice, mLogicalDevice, mTransferCommandPool, &cubeVertices, &cubeIndices));
-	mMeshList.push_back(new Mesh(mPhysicalDevice, mLogicalDevice, mTransferCommandPool, &texturedMeshVertices, &texturedMeshIndices));
+	mSceneVersion = 0;
+	mFrameNumber = 0;
+	mPacingStats = { };
+	mLastImageIndex = 0;
+	mLastSubmittedValue = 0;
+	mFrameStreamer = nullptr;
+	mPendingReadbacks.resize(MAX_FRAMES_IN_FLIGHT, { false, 0 });
+	mStreamedFrameCount = 0;
 
-	RecordCommands();
+	AddMesh(&cubeVertices, &cubeIndices);
+	AddMesh(&cubeVertices, &cubeIndices);
+	AddMesh(&texturedMeshVertices, &texturedMeshIndices, containerTexture);
+	LoadModel(MODEL_DIRECTORY + "/TexturedCube.obj");
 
-	mVP.mProjection = glm::perspective(glm::radians(45.0f), (float)mSwapchain->GetSwapchainExtent().width / (float)mSwapchain->GetSwapchainExtent().height, 0.1f, 1000.0f);
-	mVP.mView = glm::lookAt(glm::vec3(0.0f, 0.0f, -5.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	// Texture and geometry all go out in one batch. No need to wait on it, the batch ends with a barrier
+	// that covers every later submission to the graphics queue.
+	mUploadContext->Submit();
 
-	mVP.mProjection[1][1] *= -1;
+	mLogicalDevice->GetMemoryAllocator()->PrintStats();
+	mLogicalDevice->GetPipelineCache()->PrintStats();
+	mPipelineRegistry->PrintStats();
+	mDescriptorAllocator->PrintStats();
+	mDescriptorSetCache->PrintStats();
 
-	mCurrentFrame = 0;
+	mVP.mView = glm::lookAt(glm::vec3(0.0f, 0.0f, -5.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
 }
 
-Renderer::~Renderer() {
-	vkDeviceWaitIdle(mLogicalDevice->GetLogicalDevice());
+void Renderer::Draw() {
+	// Nothing can be presented to a minimized window, skip frames until it comes back
+	if (!IsHeadless()) {
+		if (mWindow->IsMinimized()) {
+			return;
+		}
+		if (mSwapchainDirty || mWindow->GetFramebufferResized()) {
+			RecreateSwapchain();
+		}
+	}
 
-	_aligned_free(mModelTransferSpace);
+	FrameContext* frame = mFrames.at(mCurrentFrame);
+	frame->Begin();
 
-	// Don't forget to insert in reverse order
-	for (size_t i = 0; i < mMeshList.size(); i++) {
-		delete mMeshList.at(i);
-	}
-	delete mSampler;
-	for (size_t i = 0; i < MAX_FRAMES_DRAW; i++) {
-		delete mDrawFences.at(i);
-		delete mRenderFinishedSemaphores.at(i);
-		delete mImageAvailableSemaphores.at(i);
-	}
-	for (size_t i = 0; i < mCommandBuffers.size(); i++) {
-		delete mDescriptorSets.at(i);
-		delete mDynamicUniformBuffers.at(i);
-		delete mUniformBuffers.at(i);
-		delete mCommandBuffers.at(i);
-	}
-	delete mTextureImageView;
-	delete mTextureImage;
-	delete mDepthImageView;
-	delete mDepthImage;
-	delete mTDescriptorPool;
-	delete mDescriptorPool;
-	delete mTransferCommandPool;
-	delete mGraphicsCommandPool;
-	for (size_t i = 0; i < mFramebuffers.size(); i++) {
-		delete mFramebuffers.at(i);
-	}
-	delete mPipeline;
-	delete mTSDescriptorSetLayout;
-	delete mDescriptorSetLayout;
-	delete mRenderPass;
-	delete mSwapchain;
-	delete mLogicalDevice;
-	delete mPhysicalDevice;
-	delete mSurface;
-	delete mInstance;
-}
+	mPacingStats.mLastStall = frame->GetStallTime();
+	mPacingStats.mAverageStall = (mPacingStats.mFrameCount == 0) ? mPacingStats.mLastStall : mPacingStats.mAverageStall * 0.95 + mPacingStats.mLastStall * 0.05;
+	mPacingStats.mMaxStall = std::max(mPacingStats.mMaxStall, mPacingStats.mLastStall);
+	mPacingStats.mFrameCount++;
 
-void Renderer::Draw() {
-	VkFence drawFence = mDrawFences.at(mCurrentFrame)->GetFence();
-	vkWaitForFences(mLogicalDevice->GetLogicalDevice(), 1, &drawFence, VK_TRUE, UINT64_MAX);
-	vkResetFences(mLogicalDevice->GetLogicalDevice(), 1, &drawFence);
+	// Everything this frame slot used last time around is done, so old meshes may be gone now
+	DeleteRetiredMeshes(false);
 
-	/// Grab next available image
-	uint32_t imageIndex;
-	vkAcquireNextImageKHR(mLogicalDevice->GetLogicalDevice(), mSwapchain->GetSwapchain(), UINT64_MAX, mImageAvailableSemaphores.at(mCurrentFrame)->GetSemaphore(), VK_NULL_HANDLE, &imageIndex);
+	// Frame boundary, nothing is being recorded. Swapped in pipelines are picked up by RecordFrameCommands().
+	ReloadChangedShaders();
+	DeleteRetiredPipelines(false);
 
-	// Update Uniform Buffers and Dynamic Uniform Buffers
-	mUniformBuffers.at(imageIndex)->MapBufferMemory(&mVP, sizeof(mVP));
+	/// Grab next available image. Headless, the frame slot owns its offscreen image and Begin() already waited on it.
+	uint32_t imageIndex;
+	VkResult result;
+	if (IsHeadless()) {
+		imageIndex = frame->GetIndex();
 
-	// Update mModelTransferSpace with all of the fresh model information
-	for (size_t i = 0; i < mMeshList.size(); i++) {
-		glm::mat4* thisModel = (glm::mat4*)((uint64_t)mModelTransferSpace + (mModelUniformAlignment * i));
-		*thisModel = mMeshList.at(i)->GetModel();
+		// The copy this slot recorded last time around is finished, pass it on before it gets overwritten
+		StreamReadback(imageIndex);
+	} else {
+		result = vkAcquireNextImageKHR(mLogicalDevice->GetLogicalDevice(), mSwapchain->GetSwapchain(), UINT64_MAX, frame->GetImageAvailableSemaphore()->GetSemaphore(), VK_NULL_HANDLE, &imageIndex);
+		if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+			// The semaphore wasn't signalled and nothing was submitted, so the frame can simply be retried
+			mSwapchainDirty = true;
+			return;
+		} else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+			throw std::runtime_error("Failed to acquire swapchain image! Error Code: " + NT_CHECK_RESULT(result));
+		}
 	}
 
-	// Push newly updated model info to graphics card
-	mDynamicUniformBuffers.at(imageIndex)->MapBufferMemory(mModelTransferSpace, mModelUniformAlignment * mMeshList.size());
+	// Meshes added since the last frame still have their copies sitting in the upload context
+	mUploadContext->Submit();
+	// Same for dispatches, the frame acquires what they released
+	mComputeContext->Submit();
+
+	RecordFrameCommands(frame, imageIndex);
 
-	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+	// Headless there is nothing to acquire, so no image available semaphore to wait on
+	std::vector<VkSemaphore> waitSemaphores;
+	std::vector<VkPipelineStageFlags> waitStages;
+	std::vector<uint64_t> waitValues;
+	if (!IsHeadless()) {
+		waitSemaphores.push_back(frame->GetImageAvailableSemaphore()->GetSemaphore());
+		waitStages.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+		waitValues.push_back(0);
+	}
+	if (mComputeWaitValue != 0) {
+		waitSemaphores.push_back(mLogicalDevice->GetComputeTimeline()->GetSemaphore());
+		waitStages.push_back(mComputeWaitStages);
+		waitValues.push_back(mComputeWaitValue);
+	}
+
+	VkCommandBuffer commandBuffer = frame->GetCommandBuffer()->GetCommandBuffer();
+	VkSemaphore signalSemaphore = frame->GetRenderFinishedSemaphore()->GetSemaphore();
 
-	VkSemaphore waitSemaphore = mImageAvailableSemaphores.at(mCurrentFrame)->GetSemaphore();
-	VkCommandBuffer commandBuffer = mCommandBuffers.at(imageIndex)->GetCommandBuffer();
-	VkSemaphore signalSemaphore = mRenderFinishedSemaphores.at(mCurrentFrame)->GetSemaphore();
+	// The binary semaphore is for present, the timeline value is what the frame slot waits on next time around.
+	// Headless there is nothing to acquire or present, only the timeline is used.
+	TimelineSemaphoreWrapper* timeline = mLogicalDevice->GetGraphicsTimeline();
+	uint64_t frameValue = timeline->NextValue();
+	std::vector<VkSemaphore> signalSemaphores = { signalSemaphore, timeline->GetSemaphore() };
+	std::vector<uint64_t> signalValues = { 0, frameValue };
+	if (IsHeadless()) {
+		signalSemaphores.erase(signalSemaphores.begin());
+		signalValues.erase(signalValues.begin());
+	}
 
+	VkTimelineSemaphoreSubmitInfo timelineSI = {
+		.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+		.pNext = nullptr,
+		.waitSemaphoreValueCount = (uint32_t)waitValues.size(),
+		.pWaitSemaphoreValues = waitValues.data(),
+		.signalSemaphoreValueCount = (uint32_t)signalValues.size(),
+		.pSignalSemaphoreValues = signalValues.data()
+	};
 	VkSubmitInfo queueSI = {
 		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-		.pNext = nullptr,
-		.waitSemaphoreCount = 1,
-		.pWaitSemaphores = &waitSemaphore,
-		.pWaitDstStageMask = waitStages,
+		.pNext = &timelineSI,
+		.waitSemaphoreCount = (uint32_t)waitSemaphores.size(),
+		.pWaitSemaphores = waitSemaphores.data(),
+		.pWaitDstStageMask = waitStages.data(),
 		.commandBufferCount = 1,
 		.pCommandBuffers = &commandBuffer,
-		.signalSemaphoreCount = 1,
-		.pSignalSemaphores = &signalSemaphore
+		.signalSemaphoreCount = (uint32_t)signalSemaphores.size(),
+		.pSignalSemaphores = signalSemaphores.data()
 	};
 
-	VkResult result = vkQueueSubmit(mLogicalDevice->GetGraphicsQueue(), 1, &queueSI, mDrawFences.at(mCurrentFrame)->GetFence());
+	result = vkQueueSubmit(mLogicalDevice->GetGraphicsQueue(), 1, &queueSI, VK_NULL_HANDLE);
 	if (result != VK_SUCCESS) {
 		throw std::runtime_error("Failed to submit draw command buffer to queue! Error Code: " + NT_CHECK_RESULT(result));
 	}
+	frame->SetSubmittedValue(frameValue);
+	mLastImageIndex = imageIndex;
+	mLastSubmittedValue = frameValue;
+	if (mFrameStreamer != nullptr) {
+		mPendingReadbacks.at(imageIndex) = { true, mStreamedFrameCount++ };
+	}
+
+	if (!IsHeadless()) {
+		Present(frame, imageIndex);
+	}
 
-	VkSwapchainKHR swapchain= mSwapchain->GetSwapchain();
+	mCurrentFrame = (mCurrentFrame + 1) % (uint32_t)mFrames.size();
+	mFrameNumber++;
+}
+
+void Renderer::Present(FrameContext* frame, uint32_t imageIndex) {
+	VkSemaphore signalSemaphore = frame->GetRenderFinishedSemaphore()->GetSemaphore();
+	VkSwapchainKHR swapchain = mSwapchain->GetSwapchain();
 	VkPresentInfoKHR presentInfo = {
 		.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
 		.pNext = nullptr,
@@ -208,16 +357,17 @@ void Renderer::Draw() {
 		.pImageIndices = &imageIndex
 	};
 
-	result = vkQueuePresentKHR(mLogicalDevice->GetPresentQueue(), &presentInfo);
-	if (result != VK_SUCCESS) {
+	// A suboptimal swapchain still presents, it gets recreated at the start of the next frame
+	VkResult result = vkQueuePresentKHR(mLogicalDevice->GetPresentQueue(), &presentInfo);
+	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+		mSwapchainDirty = true;
+	} else if (result != VK_SUCCESS) {
 		throw std::runtime_error("Failed to present Image! Error Code: " + NT_CHECK_RESULT(result));
 	}
-
-	mCurrentFrame = (mCurrentFrame + 1) % MAX_FRAMES_DRAW;
 }
 
 void Renderer::UpdateModel(int modelID, glm::mat4 model) {
-	if (modelID < 0 || modelID > mMeshList.size())
+	if (modelID < 0 || modelID >= mMeshList.size() || mMeshList.at(modelID) == nullptr)
 		throw std::runtime_error("Attempt to access model index out of range!");
 	mMeshList.at(modelID)->SetModel(model);
 }
@@ -226,11 +376,505 @@ void Renderer::UpdateCamera(glm::mat4 view) {
 	mVP.mView = view;
 }
 
-void Renderer::RecordCommands() {
+/*
+
+	Loads a texture and registers it in the bindless table. Returns its slot, which is the texID meshes
+	take. The upload goes out with the next Draw() at the latest, like mesh geometry.
+
+*/
+int Renderer::AddTexture(std::string filename) {
+	ImageWrapper* image = new ImageWrapper(mPhysicalDevice, mLogicalDevice, mUploadContext, filename);
+	ImageViewWrapper* imageView = new ImageViewWrapper(mLogicalDevice, image->GetImage(), VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, image->GetMipLevels());
+	mTextureImages.push_back(image);
+	mTextureImageViews.push_back(imageView);
+
+	return (int)mBindlessTable->AddTexture(imageView);
+}
+
+/*
+
+	Creates a mesh and returns its ID. The geometry upload is recorded into the upload context and goes
+	out with the next Draw() at the latest.
+
+*/
+int Renderer::AddMesh(std::vector<Vertex>* vertices, std::vector<uint32_t>* indices) {
+	return AddMesh(vertices, indices, -1);
+}
+
+/*
+
+	Same, for a mesh sampling the given texture. -1 means untextured and draws with the vertex colors.
+
+*/
+int Renderer::AddMesh(std::vector<Vertex>* vertices, std::vector<uint32_t>* indices, int texID) {
+	return InsertMesh(new Mesh(mPhysicalDevice, mLogicalDevice, mUploadContext, vertices, indices, texID));
+}
+
+/*
+
+	Loads a model file and returns its mesh ID. When filename's cooked file exists and was cooked
+	from the current source, its geometry is copied into staging memory straight from the mapped
+	file. Otherwise the model is imported with Assimp (anything it reads works).
+
+*/
+int Renderer::LoadModel(std::string filename) {
+	{
+		CookedModel cooked(GetCookedModelPath(filename));
+		if (cooked.IsValid() && cooked.GetSourceHash() == HashModelSource(filename)) {
+			std::cout << "Success: Model " << filename << " loaded from its cooked file." << std::endl;
+			return CreateModelMesh(cooked.GetVertices(), cooked.GetVertexCount(), cooked.GetIndices(), cooked.GetIndexCount(), cooked.GetSubmeshes(), cooked.GetMaterials());
+		}
+		if (cooked.IsValid()) {
+			std::cout << "Warning: Cooked model for " << filename << " is stale, importing the source. Run with --cook to update it." << std::endl;
+		}
+	}
+
+	ModelData model = ImportModel(filename);
+	return CreateModelMesh(model.mVertices.data(), (uint32_t)model.mVertices.size(), model.mIndices.data(), (uint32_t)model.mIndices.size(), model.mSubmeshes, model.mMaterials);
+}
+
+/*
+
+	One mesh for a whole model, all submeshes sharing one vertex and one index buffer. Each distinct
+	diffuse texture is loaded once and recorded into the upload batch along with the geometry.
+
+*/
+int Renderer::CreateModelMesh(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, std::vector<Submesh> submeshes, const std::vector<ModelMaterial>& materials) {
+	std::unordered_map<std::string, int> textures;
+	for (size_t i = 0; i < submeshes.size(); i++) {
+		Submesh& submesh = submeshes.at(i);
+		if (submesh.mMaterialIndex < 0) {
+			continue;
+		}
+
+		std::string texture = materials.at(submesh.mMaterialIndex).mDiffuseTexture;
+		if (texture.empty()) {
+			continue;
+		}
+		if (textures.find(texture) == textures.end()) {
+			textures[texture] = AddTexture(texture);
+		}
+		submesh.mTexID = textures.at(texture);
+	}
+
+	return InsertMesh(new Mesh(mPhysicalDevice, mLogicalDevice, mUploadContext, vertices, vertexCount, indices, indexCount, submeshes));
+}
+
+/*
+
+	Puts a new mesh into the first free slot of mMeshList and returns its ID. Takes ownership of the mesh.
+
+*/
+int Renderer::InsertMesh(Mesh* mesh) {
+	mSceneVersion++;
+
+	for (size_t i = 0; i < mMeshList.size(); i++) {
+		if (mMeshList.at(i) == nullptr) {
+			mMeshList.at(i) = mesh;
+			return (int)i;
+		}
+	}
+
+	if (mMeshList.size() >= MAX_OBJECTS) {
+		delete mesh;
+		throw std::runtime_error("Attempt to add more than MAX_OBJECTS meshes!");
+	}
+
+	mMeshList.push_back(mesh);
+	return (int)mMeshList.size() - 1;
+}
+
+void Renderer::RemoveMesh(int modelID) {
+	if (modelID < 0 || modelID >= mMeshList.size() || mMeshList.at(modelID) == nullptr)
+		throw std::runtime_error("Attempt to remove model index out of range!");
+
+	mPendingMeshDeletes.push_back({ mMeshList.at(modelID), mFrameNumber });
+	mMeshList.at(modelID) = nullptr;
+	mSceneVersion++;
+}
+
+void Renderer::SetMeshVisible(int modelID, bool visible) {
+	if (modelID < 0 || modelID >= mMeshList.size() || mMeshList.at(modelID) == nullptr)
+		throw std::runtime_error("Attempt to access model index out of range!");
+
+	if (mMeshList.at(modelID)->IsVisible() != visible) {
+		mMeshList.at(modelID)->SetVisible(visible);
+		mSceneVersion++;
+	}
+}
+
+/*
+
+	Gives the mesh a different pipeline state. If no other mesh uses the same state its pipeline is
+	queued for building the next time the mesh gets recorded, the fallback stands in until then.
+
+*/
+void Renderer::SetMeshPipelineState(int modelID, PipelineStateDescription state) {
+	if (modelID < 0 || modelID >= mMeshList.size() || mMeshList.at(modelID) == nullptr)
+		throw std::runtime_error("Attempt to access model index out of range!");
+
+	CheckPipelineLayout(state);
+
+	if (!(mMeshList.at(modelID)->GetPipelineState() == state)) {
+		mMeshList.at(modelID)->SetPipelineState(state);
+		mSceneVersion++;
+	}
+}
+
+/*
+
+	Queues builds for pipeline states that are about to be used, so they are (more likely) ready by
+	the time a mesh asks for them. Doesn't wait for the builds, but loads shaders nothing used yet.
+
+*/
+void Renderer::PrewarmPipelines(std::vector<PipelineStateDescription> states) {
+	for (size_t i = 0; i < states.size(); i++) {
+		CheckPipelineLayout(states.at(i));
+	}
+	for (size_t i = 0; i < states.size(); i++) {
+		mPipelineRegistry->RequestPipeline(states.at(i), mPipelineLayout, mRenderPass);
+	}
+}
+
+/*
+
+	Every draw binds and pushes through mPipelineLayout, so a state whose shaders declare anything
+	else can't be drawn with it.
+
+*/
+void Renderer::CheckPipelineLayout(const PipelineStateDescription& state) {
+	if (mPipelineRegistry->GetPipelineLayout(state) != mPipelineLayout)
+		throw std::runtime_error("Pipeline state's shaders don't match the renderer's pipeline layout!");
+}
+
+/*
+
+	Changes how many frames the CPU may record ahead of the GPU. Waits for the device to go idle and
+	rebuilds the frame contexts, so this is not something to call every frame.
+
+*/
+void Renderer::SetFramesInFlight(uint32_t count) {
+	if (count < 1 || count > MAX_FRAMES_IN_FLIGHT)
+		throw std::runtime_error("Frames in flight must be between 1 and MAX_FRAMES_IN_FLIGHT!");
+	if (count == mFrames.size())
+		return;
+
+	vkDeviceWaitIdle(mLogicalDevice->GetLogicalDevice());
+	DeleteRetiredMeshes(true);
+
+	// Slots are about to be renumbered, get whatever they still hold out first
+	FlushFrameSink();
+
+	DestroyFrameContexts();
+	CreateFrameContexts(count);
+
+	std::cout << "Frames in flight: " << count << std::endl;
+}
+
+uint32_t Renderer::GetFramesInFlight() {
+	return (uint32_t)mFrames.size();
+}
+
+FramePacingStats Renderer::GetFramePacingStats() {
+	return mPacingStats;
+}
+
+PipelineRegistryStats Renderer::GetPipelineStats() {
+	return mPipelineRegistry->GetStats();
+}
+
+/*
+
+	The persistent allocator and every frame's transient allocator added together.
+
+*/
+DescriptorAllocatorStats Renderer::GetDescriptorStats() {
+	DescriptorAllocatorStats stats = mDescriptorAllocator->GetStats();
+	for (size_t i = 0; i < mFrames.size(); i++) {
+		DescriptorAllocatorStats frameStats = mFrames.at(i)->GetTransientDescriptorAllocator()->GetStats();
+		stats.mSetsAllocated += frameStats.mSetsAllocated;
+		stats.mSetsFreed += frameStats.mSetsFreed;
+		stats.mResets += frameStats.mResets;
+		stats.mPoolsCreated += frameStats.mPoolsCreated;
+		stats.mLiveSets += frameStats.mLiveSets;
+		stats.mSetCapacity += frameStats.mSetCapacity;
+	}
+	return stats;
+}
+
+DescriptorSetCacheStats Renderer::GetDescriptorSetCacheStats() {
+	return mDescriptorSetCache->GetStats();
+}
+
+PhysicalDeviceWrapper* Renderer::GetPhysicalDevice() {
+	return mPhysicalDevice;
+}
+
+LogicalDeviceWrapper* Renderer::GetLogicalDevice() {
+	return mLogicalDevice;
+}
+
+ComputeContext* Renderer::GetComputeContext() {
+	return mComputeContext;
+}
+
+DescriptorSetCache* Renderer::GetDescriptorSetCache() {
+	return mDescriptorSetCache;
+}
+
+/*
+
+	Compute pipelines are built on the calling thread the first time and owned by the registry. The path
+	is the compiled .spv, same as the shaders of a PipelineStateDescription.
+
+*/
+PipelineWrapper* Renderer::GetComputePipeline(std::string shader) {
+	return mPipelineRegistry->GetComputePipeline(shader);
+}
+
+bool Renderer::IsHeadless() {
+	return mOffscreenTarget != nullptr;
+}
+
+/*
+
+	Waits for the most recently submitted frame and copies its pixels out of the readback buffer.
+	Tightly packed RGBA8 rows, top to bottom. Only available headless.
+
+*/
+std::vector<uint8_t> Renderer::ReadbackLastFrame() {
+	if (!IsHeadless())
+		throw std::runtime_error("Frame readback is only available on a headless renderer!");
+	if (mLastSubmittedValue == 0)
+		throw std::runtime_error("Attempt to read back a frame before any frame was drawn!");
+
+	mLogicalDevice->GetGraphicsTimeline()->Wait(mLastSubmittedValue);
+
+	const uint8_t* data = (const uint8_t*)mOffscreenTarget->GetReadbackData(mLastImageIndex);
+	return std::vector<uint8_t>(data, data + mOffscreenTarget->GetReadbackSize());
+}
+
+void Renderer::SaveLastFrame(std::string path) {
+	std::vector<uint8_t> pixels = ReadbackLastFrame();
+	VkExtent2D extent = mOffscreenTarget->GetExtent();
+	WriteImage(path, pixels.data(), extent.width, extent.height);
+	std::cout << "Success: Frame saved to " << path << std::endl;
+}
+
+/*
+
+	Streams every frame drawn from now on into the sink, or stops streaming with nullptr. Frames still
+	pending for the previous sink are written out first. The sink is not owned and has to outlive the
+	Renderer or the next SetFrameSink() call.
+
+*/
+void Renderer::SetFrameSink(FrameSink* sink) {
+	if (!IsHeadless())
+		throw std::runtime_error("Frame sinks are only available on a headless renderer!");
+
+	if (mFrameStreamer != nullptr) {
+		FlushFrameSink();
+		delete mFrameStreamer;
+		mFrameStreamer = nullptr;
+	}
+
+	if (sink != nullptr) {
+		VkExtent2D extent = mOffscreenTarget->GetExtent();
+		mFrameStreamer = new FrameStreamer(sink, extent.width, extent.height, FRAME_STREAM_QUEUE_DEPTH);
+		mStreamedFrameCount = 0;
+	}
+}
+
+/*
+
+	Waits for every frame in flight and blocks until the sink has written all of them.
+
+*/
+void Renderer::FlushFrameSink() {
+	if (mFrameStreamer == nullptr)
+		return;
+
+	mLogicalDevice->GetGraphicsTimeline()->Wait(mLastSubmittedValue);
+
+	// Oldest first, the sink expects frames in order
+	std::vector<uint32_t> pending;
+	for (uint32_t i = 0; i < mPendingReadbacks.size(); i++) {
+		if (mPendingReadbacks.at(i).mPending) {
+			pending.push_back(i);
+		}
+	}
+	std::sort(pending.begin(), pending.end(), [this](uint32_t a, uint32_t b) { return mPendingReadbacks.at(a).mFrameNumber < mPendingReadbacks.at(b).mFrameNumber; });
+	for (size_t i = 0; i < pending.size(); i++) {
+		StreamReadback(pending.at(i));
+	}
+
+	mFrameStreamer->Flush();
+}
+
+/*
+
+	Rebuilds the swapchain and everything sized to it. Pipelines, descriptor sets and meshes are left
+	alone, the pipelines take their viewport and scissor as dynamic state.
+
+*/
+void Renderer::RecreateSwapchain() {
+	if (IsHeadless())
+		return;
+
+	vkDeviceWaitIdle(mLogicalDevice->GetLogicalDevice());
+
+	DestroySwapchainResources();
+	mSwapchain->Recreate();
+	CreateSwapchainResources();
+
+	mWindow->SetFramebufferResized(false);
+	mSwapchainDirty = false;
+
+	// Cached secondaries have the old viewport and scissor baked in
+	mSceneVersion++;
+}
+
+void Renderer::CreateSwapchainResources() {
+	VkExtent2D extent = GetRenderExtent();
+
+	mDepthImage = new ImageWrapper(mPhysicalDevice, mLogicalDevice, extent.width, extent.height, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	mDepthImageView = new ImageViewWrapper(mLogicalDevice, mDepthImage->GetImage(), VK_FORMAT_D32_SFLOAT_S8_UINT, VK_IMAGE_ASPECT_DEPTH_BIT);
+	if (IsHeadless()) {
+		for (uint32_t i = 0; i < mOffscreenTarget->GetImageCount(); i++) {
+			mFramebuffers.push_back(new FramebufferWrapper(mLogicalDevice, mRenderPass, mOffscreenTarget->GetImageView(i), mDepthImageView, extent));
+		}
+	} else {
+		for (size_t i = 0; i < mSwapchain->GetSwapchainImages().size(); i++) {
+			mFramebuffers.push_back(new FramebufferWrapper(mLogicalDevice, mSwapchain, mRenderPass, (int)i, mDepthImageView));
+		}
+	}
+
+	mVP.mProjection = glm::perspective(glm::radians(45.0f), (float)extent.width / (float)extent.height, 0.1f, 1000.0f);
+	mVP.mProjection[1][1] *= -1;
+}
+
+VkExtent2D Renderer::GetRenderExtent() {
+	return IsHeadless() ? mOffscreenTarget->GetExtent() : mSwapchain->GetSwapchainExtent();
+}
+
+/*
+
+	Copies the given image's readback buffer into a streamer buffer and queues it for the sink. The
+	GPU must be done with the image, the caller waits on the frame's timeline value first.
+
+*/
+void Renderer::StreamReadback(uint32_t imageIndex) {
+	PendingReadback& readback = mPendingReadbacks.at(imageIndex);
+	if (mFrameStreamer == nullptr || !readback.mPending)
+		return;
+
+	std::vector<uint8_t> pixels = mFrameStreamer->AcquireBuffer();
+	memcpy(pixels.data(), mOffscreenTarget->GetReadbackData(imageIndex), mOffscreenTarget->GetReadbackSize());
+	mFrameStreamer->Submit(std::move(pixels), readback.mFrameNumber);
+	readback.mPending = false;
+}
+
+void Renderer::DestroySwapchainResources() {
+	for (size_t i = 0; i < mFramebuffers.size(); i++) {
+		delete mFramebuffers.at(i);
+	}
+	mFramebuffers.clear();
+	delete mDepthImageView;
+	delete mDepthImage;
+}
+
+void Renderer::CreateFrameContexts(uint32_t count) {
+	// The ranges cover one element, the actual position comes from the dynamic offsets. That makes the
+	// contents the same for every frame, so the cache hands all of them one set.
+	DescriptorSetContents uniforms(mDescriptorSetLayout);
+	uniforms.SetBuffer(0, mUniformRing->GetBuffer(), sizeof(UboViewProjection));
+	uniforms.SetBuffer(1, mUniformRing->GetBuffer(), sizeof(glm::mat4));
+
+	for (uint32_t i = 0; i < count; i++) {
+		DescriptorSetWrapper* descriptorSet = mDescriptorSetCache->GetDescriptorSet(uniforms);
+		mFrames.push_back(new FrameContext(mPhysicalDevice, mLogicalDevice, i, mThreadPool->GetThreadCount(), mUniformRing, descriptorSet));
+	}
+	mCurrentFrame = 0;
+}
+
+void Renderer::DestroyFrameContexts() {
+	for (size_t i = 0; i < mFrames.size(); i++) {
+		delete mFrames.at(i);
+	}
+	mFrames.clear();
+}
+
+/*
+
+	Records the command buffers for the given frame. Must only be called after FrameContext::Begin().
+	The visible meshes are split into contiguous ranges, one per recording task, and each task records
+	its range into a secondary command buffer with its own command pool. The primary only begins the
+	render pass on the acquired framebuffer and executes the secondaries.
+
+*/
+void Renderer::RecordFrameCommands(FrameContext* frame, uint32_t imageIndex) {
+	// Handed out on this thread, the ring is not thread safe. Same allocation order every frame, so
+	// cached secondaries still point at the right offsets.
+	FrameUniforms uniforms = AllocateFrameUniforms(frame);
+	*(UboViewProjection*)uniforms.mViewProjection.mData = mVP;
+	for (size_t i = 0; i < mMeshList.size(); i++) {
+		if (mMeshList.at(i) != nullptr) {
+			*(glm::mat4*)uniforms.mModels.at(i).mData = mMeshList.at(i)->GetModel();
+		}
+	}
+
+	// Something that was drawn with the fallback may have its own pipeline now
+	uint64_t pipelineGeneration = mPipelineRegistry->GetReadyGeneration();
+	if (pipelineGeneration != mPipelineGeneration) {
+		mPipelineGeneration = pipelineGeneration;
+		mSceneVersion++;
+	}
+
+	if (!CACHE_UNCHANGED_COMMANDS || frame->GetRecordedSceneVersion() != mSceneVersion) {
+		// Pipelines are resolved here, the workers only ever see ready ones
+		std::vector<size_t> drawList;
+		std::vector<PipelineWrapper*> pipelines;
+		for (size_t i = 0; i < mMeshList.size(); i++) {
+			if (mMeshList.at(i) == nullptr || !mMeshList.at(i)->IsVisible()) {
+				continue;
+			}
+
+			PipelineWrapper* pipeline = mPipelineRegistry->RequestPipeline(mMeshList.at(i)->GetDrawPipelineState(), mPipelineLayout, mRenderPass)->mPipeline.load();
+			if (pipeline == nullptr) {
+				if (!DRAW_PENDING_WITH_FALLBACK) {
+					continue;
+				}
+				pipeline = mFallbackPipeline;
+			}
+			drawList.push_back(i);
+			pipelines.push_back(pipeline);
+		}
+
+		size_t taskCount = std::min(frame->GetRecordingTaskCount(), drawList.size());
+		for (size_t task = 0; task < taskCount; task++) {
+			size_t first = drawList.size() * task / taskCount;
+			size_t last = drawList.size() * (task + 1) / taskCount;
+
+			mThreadPool->Submit([this, frame, task, first, last, &drawList, &pipelines, &uniforms]() {
+				RecordSecondaryCommands(frame, task, drawList, pipelines, first, last, uniforms);
+			});
+		}
+		mThreadPool->Wait();
+
+		frame->SetRecorded(mSceneVersion, taskCount);
+	}
+
+	std::vector<VkCommandBuffer> secondaryCommandBuffers;
+	for (size_t task = 0; task < frame->GetRecordedDrawTaskCount(); task++) {
+		secondaryCommandBuffers.push_back(frame->GetSecondaryCommandBuffer(task)->GetCommandBuffer());
+	}
+
+	frame->GetCommandPool()->Reset();
+
 	VkCommandBufferBeginInfo commandBufferBI = {
 		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
 		.pNext = nullptr,
-		.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
 		.pInheritanceInfo = nullptr
 	};
 	VkClearValue clearValue = { 0.0f, 0.0f, 0.2f, 1.0f };
@@ -240,67 +884,222 @@ void Renderer::RecordCommands() {
 		.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
 		.pNext = nullptr,
 		.renderPass = mRenderPass->GetRenderPass(),
-		.framebuffer = VK_NULL_HANDLE,
+		.framebuffer = mFramebuffers.at(imageIndex)->GetFramebuffer(),
 		.renderArea = {
 			.offset = {
 				.x = 0,
 				.y = 0
 			},
-			.extent = {
-				.width = mSwapchain->GetSwapchainExtent().width,
-				.height = mSwapchain->GetSwapchainExtent().height
-			}
+			.extent = GetRenderExtent()
 		},
 		.clearValueCount = (uint32_t)clearValues.size(),
 		.pClearValues = clearValues.data()
 	};
 
-	for (size_t i = 0; i < mCommandBuffers.size(); i++) {
-		renderPassBI.framebuffer = mFramebuffers.at(i)->GetFramebuffer();
+	VkCommandBuffer commandBuffer = frame->GetCommandBuffer()->GetCommandBuffer();
+
+	VkResult result;
+	result = vkBeginCommandBuffer(commandBuffer, &commandBufferBI);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to begin recording command buffer! Error Code: " + NT_CHECK_RESULT(result));
+	}
+
+		// Ownership of whatever the last compute batch released moves over before anything reads it
+		mComputeWaitValue = mComputeContext->RecordAcquires(commandBuffer, &mComputeWaitStages);
+
+		vkCmdBeginRenderPass(commandBuffer, &renderPassBI, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+			if (!secondaryCommandBuffers.empty()) {
+				vkCmdExecuteCommands(commandBuffer, (uint32_t)secondaryCommandBuffers.size(), secondaryCommandBuffers.data());
+			}
+
+		vkCmdEndRenderPass(commandBuffer);
 
-		VkResult result;
-		result = vkBeginCommandBuffer(mCommandBuffers.at(i)->GetCommandBuffer(), &commandBufferBI);
-		if (result != VK_SUCCESS) {
-			throw std::runtime_error("Failed to begin recording command buffer! Error Code: " + NT_CHECK_RESULT(result));
+		if (IsHeadless()) {
+			mOffscreenTarget->RecordReadback(commandBuffer, imageIndex);
 		}
 
-			vkCmdBeginRenderPass(mCommandBuffers.at(i)->GetCommandBuffer(), &renderPassBI, VK_SUBPASS_CONTENTS_INLINE);
+	result = vkEndCommandBuffer(commandBuffer);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to end recording command buffer! Error Code: " + NT_CHECK_RESULT(result));
+	}
+}
 
-				vkCmdBindPipeline(mCommandBuffers.at(i)->GetCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline->GetPipeline());
+/*
 
-				for (size_t j = 0; j < mMeshList.size(); j++) {
-					VkBuffer vertexBuffers[] = { mMeshList.at(j)->GetVertexBuffer()->GetBuffer() };
-					VkDeviceSize offsets[] = { 0 };
+	Records drawList[first, last) into the frame's secondary command buffer for the given task, after
+	resetting that task's pool. pipelines[k] is the pipeline for drawList[k]. The framebuffer is left
+	out of the inheritance info so the buffer can be reused with any swapchain image. Runs on a worker
+	thread.
 
-					vkCmdBindVertexBuffers(mCommandBuffers.at(i)->GetCommandBuffer(), 0, 1, vertexBuffers, offsets);
+*/
+void Renderer::RecordSecondaryCommands(FrameContext* frame, size_t task, std::vector<size_t>& drawList, std::vector<PipelineWrapper*>& pipelines, size_t first, size_t last, FrameUniforms& uniforms) {
+	frame->GetRecordingCommandPool(task)->Reset();
 
-					vkCmdBindIndexBuffer(mCommandBuffers.at(i)->GetCommandBuffer(), mMeshList.at(j)->GetIndexBuffer()->GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
+	VkCommandBufferInheritanceInfo inheritanceInfo = {
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+		.pNext = nullptr,
+		.renderPass = mRenderPass->GetRenderPass(),
+		.subpass = 0,
+		.framebuffer = VK_NULL_HANDLE,
+		.occlusionQueryEnable = VK_FALSE,
+		.queryFlags = 0,
+		.pipelineStatistics = 0
+	};
+	VkCommandBufferBeginInfo commandBufferBI = {
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.pNext = nullptr,
+		.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+		.pInheritanceInfo = &inheritanceInfo
+	};
 
-					uint32_t dynamicOffset = (uint32_t)(mModelUniformAlignment * j);
+	VkCommandBuffer cmd = frame->GetSecondaryCommandBuffer(task)->GetCommandBuffer();
 
-					std::vector<VkDescriptorSet> descriptorSets = { mDescriptorSets.at(i)->GetDescriptorSet(), mTextureDescriptorSet->GetDescriptorSet()};
-						
-					vkCmdBindDescriptorSets(mCommandBuffers.at(i)->GetCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline->GetPipelineLayout(), 0, descriptorSets.size(), descriptorSets.data(), 1, &dynamicOffset);
-				
-					vkCmdDrawIndexed(mCommandBuffers.at(i)->GetCommandBuffer(), mMeshList.at(j)->GetIndexCount(), 1, 0, 0, 0);
-				}
+	VkResult result = vkBeginCommandBuffer(cmd, &commandBufferBI);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to begin recording secondary command buffer! Error Code: " + NT_CHECK_RESULT(result));
+	}
+
+		// Dynamic state isn't inherited from the primary, every secondary sets its own
+		VkExtent2D extent = GetRenderExtent();
+		VkViewport viewport = { 0.0f, 0.0f, (float)extent.width, (float)extent.height, 0.0f, 1.0f };
+		VkRect2D scissor = { { 0, 0 }, extent };
+		vkCmdSetViewport(cmd, 0, 1, &viewport);
+		vkCmdSetScissor(cmd, 0, 1, &scissor);
 
-			vkCmdEndRenderPass(mCommandBuffers.at(i)->GetCommandBuffer());
+		VkDescriptorSet uniformSet = frame->GetDescriptorSet()->GetDescriptorSet();
 
-		result = vkEndCommandBuffer(mCommandBuffers.at(i)->GetCommandBuffer());
-		if (result != VK_SUCCESS) {
-			throw std::runtime_error("Failed to end recording command buffer! Error Code: " + NT_CHECK_RESULT(result));
+		// The bindless table holds every texture, bind it once and pick the texture per draw with push
+		// constants. Untextured meshes are specialized with USE_TEXTURE off and never index it.
+		VkDescriptorSet textureSet = mBindlessTable->GetDescriptorSet()->GetDescriptorSet();
+		vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout->GetPipelineLayout(), 1, 1, &textureSet, 0, nullptr);
+
+		VkPipeline boundPipeline = VK_NULL_HANDLE;
+		for (size_t k = first; k < last; k++) {
+			size_t j = drawList.at(k);
+
+			// All pipelines share mPipelineLayout, so the descriptor sets stay bound across a switch
+			if (pipelines.at(k)->GetPipeline() != boundPipeline) {
+				boundPipeline = pipelines.at(k)->GetPipeline();
+				vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, boundPipeline);
+			}
+
+			VkBuffer vertexBuffers[] = { mMeshList.at(j)->GetVertexBuffer()->GetBuffer() };
+			VkDeviceSize offsets[] = { 0 };
+
+			vkCmdBindVertexBuffers(cmd, 0, 1, vertexBuffers, offsets);
+
+			vkCmdBindIndexBuffer(cmd, mMeshList.at(j)->GetIndexBuffer()->GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
+
+			uint32_t dynamicOffsets[] = { (uint32_t)uniforms.mViewProjection.mOffset, (uint32_t)uniforms.mModels.at(j).mOffset };
+
+			vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout->GetPipelineLayout(), 0, 1, &uniformSet, 2, dynamicOffsets);
+
+			// Every submesh draws out of the buffers bound above, only the material changes in between
+			const std::vector<Submesh>& submeshes = mMeshList.at(j)->GetSubmeshes();
+			for (size_t s = 0; s < submeshes.size(); s++) {
+				MaterialPushConstants material = {
+					.mTextureIndex = (uint32_t)std::max(submeshes.at(s).mTexID, 0),
+					.mSamplerIndex = mDefaultSamplerIndex
+				};
+				vkCmdPushConstants(cmd, mPipelineLayout->GetPipelineLayout(), VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(MaterialPushConstants), &material);
+
+				vkCmdDrawIndexed(cmd, submeshes.at(s).mIndexCount, 1, submeshes.at(s).mFirstIndex, submeshes.at(s).mVertexOffset, 0);
+			}
+		}
+
+	result = vkEndCommandBuffer(cmd);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to end recording secondary command buffer! Error Code: " + NT_CHECK_RESULT(result));
+	}
+}
+
+/*
+
+	Hands out the view projection followed by one model slot per mesh from the frame's ring region.
+
+*/
+FrameUniforms Renderer::AllocateFrameUniforms(FrameContext* frame) {
+	FrameUniforms uniforms;
+
+	uniforms.mViewProjection = frame->AllocateUniform(sizeof(UboViewProjection));
+	for (size_t i = 0; i < mMeshList.size(); i++) {
+		uniforms.mModels.push_back(frame->AllocateUniform(sizeof(glm::mat4)));
+	}
+
+	return uniforms;
+}
+
+/*
+
+	Deletes removed meshes once no frame in flight can reference them anymore. A mesh removed during frame
+	N was last recorded into frame N - 1, which is guaranteed finished once frame N - 1 + frames in flight
+	has begun, since Begin() waits for the graphics timeline to reach the value its slot last submitted.
+	Passing true deletes everything (only after vkDeviceWaitIdle!).
+
+*/
+void Renderer::DeleteRetiredMeshes(bool all) {
+	for (size_t i = 0; i < mPendingMeshDeletes.size(); ) {
+		if (all || mFrameNumber >= mPendingMeshDeletes.at(i).mFrameNumber + mFrames.size()) {
+			delete mPendingMeshDeletes.at(i).mMesh;
+			mPendingMeshDeletes.erase(mPendingMeshDeletes.begin() + i);
+		} else {
+			i++;
 		}
 	}
 }
 
-void Renderer::allocateDynamicBufferTransferSpace() {
-	// Grab the minimum required size for uniform buffer offsets
-	mMinUniformBufferOffset = mPhysicalDevice->GetPhysicalDeviceProperties().limits.minUniformBufferOffsetAlignment;
+/*
 
-	// Do some weird bit shifting magic
-	mModelUniformAlignment = (sizeof(glm::mat4) + mMinUniformBufferOffset - 1) & ~(mMinUniformBufferOffset - 1);
+	Recompiles the shaders the watcher saw change and has the registry rebuild the pipelines that use
+	them. A shader that doesn't compile is reported and the old one stays, so a typo doesn't end the
+	session.
 
-	// Create space in memory to hold the dynamic buffer that is now aligned and holds MAX_OBJECTS
-	mModelTransferSpace = (glm::mat4*)_aligned_malloc(mModelUniformAlignment * MAX_OBJECTS, mModelUniformAlignment);
+*/
+void Renderer::ReloadChangedShaders() {
+	if (mShaderWatcher == nullptr) {
+		return;
+	}
+
+	std::vector<std::string> changed = mShaderWatcher->TakeChangedFiles();
+	for (size_t i = 0; i < changed.size(); i++) {
+		try {
+			if (!mShaderCompiler->CompileFile(changed.at(i))) {
+				continue;
+			}
+			uint32_t rebuilt = mPipelineRegistry->ReloadShader(changed.at(i) + ".spv");
+			std::cout << "Reloaded " << changed.at(i) << ", rebuilding " << rebuilt << " pipelines." << std::endl;
+		} catch (const std::runtime_error& e) {
+			std::cout << "Nocturne Error: " << e.what() << std::endl;
+		}
+	}
+}
+
+/*
+
+	Takes the pipelines the registry swapped out and deletes them once the GPU is past every frame that
+	was submitted before they were taken. Everything recorded after that already uses the new ones.
+	Passing true deletes everything (only after vkDeviceWaitIdle!).
+
+*/
+void Renderer::DeleteRetiredPipelines(bool all) {
+	std::vector<PipelineWrapper*> retired = mPipelineRegistry->TakeRetiredPipelines();
+	if (!retired.empty()) {
+		// The fallback may have been one of them
+		mFallbackPipeline = mPipelineRegistry->RequestPipeline(DefaultPipelineState(), mPipelineLayout, mRenderPass)->mPipeline.load();
+	}
+
+	uint64_t pendingValue = mLogicalDevice->GetGraphicsTimeline()->GetPendingValue();
+	for (size_t i = 0; i < retired.size(); i++) {
+		mRetiredPipelines.push_back({ retired.at(i), pendingValue });
+	}
+
+	for (size_t i = 0; i < mRetiredPipelines.size(); ) {
+		if (all || mLogicalDevice->GetGraphicsTimeline()->IsComplete(mRetiredPipelines.at(i).mTimelineValue)) {
+			delete mRetiredPipelines.at(i).mPipeline;
+			mRetiredPipelines.erase(mRetiredPipelines.begin() + i);
+		} else {
+			i++;
+		}
+	}
 }
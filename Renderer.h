@@ -9,7 +9,9 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <vector>
+#include <string>
 #include <iostream>
+#include "UniformRingBuffer.h"
 
 class WindowWrapper;
 class InstanceWrapper;
@@ -17,37 +19,134 @@ class SurfaceWrapper;
 class PhysicalDeviceWrapper;
 class LogicalDeviceWrapper;
 class SwapchainWrapper;
+class OffscreenTarget;
 class ShaderWrapper;
 class RenderPassWrapper;
 class PipelineWrapper;
+class PipelineLayoutWrapper;
+class PipelineRegistry;
+class ComputeContext;
+class ShaderCompiler;
+class ShaderWatcher;
+struct PipelineStateDescription;
+struct PipelineRegistryStats;
 class FramebufferWrapper;
 class CommandPoolWrapper;
 class CommandBufferWrapper;
-class SemaphoreWrapper;
-class FenceWrapper;
+class FrameContext;
 class BufferWrapper;
 class Mesh;
+struct Vertex;
+struct Submesh;
+struct ModelMaterial;
 class DescriptorSetLayoutWrapper;
-class DescriptorPoolWrapper;
+class DescriptorAllocator;
+class DescriptorSetCache;
+struct DescriptorSetCacheStats;
+struct DescriptorAllocatorStats;
+class BindlessTextureTable;
 class DescriptorSetWrapper;
 class ImageWrapper;
 class ImageViewWrapper;
 class SamplerWrapper;
+class UploadContext;
+class ThreadPool;
+class FrameSink;
+class FrameStreamer;
 
 struct UboViewProjection {
 	glm::mat4 mProjection;
 	glm::mat4 mView;
 };
 
+// Where this frame's uniforms live in the UniformRingBuffer. mModels is indexed like mMeshList.
+struct FrameUniforms {
+	UniformAllocation mViewProjection;
+	std::vector<UniformAllocation> mModels;
+};
+
+// A removed mesh can still be referenced by frames in flight, so it is only deleted once those are done
+struct PendingMeshDelete {
+	Mesh* mMesh;
+	uint64_t mFrameNumber;
+};
+
+// A pipeline replaced by a shader reload, deleted once the graphics timeline passes mTimelineValue
+struct RetiredPipeline {
+	PipelineWrapper* mPipeline;
+	uint64_t mTimelineValue;
+};
+
+// Pushed per draw, indices into the bindless texture table (see simple.frag)
+struct MaterialPushConstants {
+	uint32_t mTextureIndex;
+	uint32_t mSamplerIndex;
+};
+
+// A headless frame whose readback buffer hasn't been handed to the frame sink yet
+struct PendingReadback {
+	bool mPending;
+	uint64_t mFrameNumber;								// Position in the stream, not mFrameNumber
+};
+
+// How long the CPU sat waiting on the GPU at the start of Draw(), in milliseconds
+struct FramePacingStats {
+	double mLastStall;
+	double mAverageStall;								// Exponential moving average
+	double mMaxStall;
+	uint64_t mFrameCount;
+};
+
 /*
 
-	
+	Notes:
+		- Everything a frame writes to lives in its FrameContext, indexed by frame slot. Between 1 and
+		  MAX_FRAMES_IN_FLIGHT frames can be in flight, selectable at runtime with SetFramesInFlight().
+		  Fewer means less input latency, more means the CPU stalls less on the GPU.
+		- Command buffers are recorded every frame. Once the graphics timeline reaches the value a
+		  FrameContext last submitted its pools are reset and the visible draw list is recorded again.
+		- With CACHE_UNCHANGED_COMMANDS the secondary command buffers of a frame are kept as long as
+		  the scene version hasn't changed since they were recorded. Only the (tiny) primary is
+		  re-recorded then, since it has to point at whichever framebuffer was acquired.
+		- The window can be resized. The swapchain, depth image and framebuffers are rebuilt in place
+		  when the surface reports OUT_OF_DATE / SUBOPTIMAL or the window signals a resize. While the
+		  window is minimized Draw() does nothing.
+		- Renderer(width, height) creates a headless renderer. There is no window, surface or swapchain,
+		  frames are rendered into an OffscreenTarget and copied to host memory at the end of the frame.
+		  ReadbackLastFrame() / SaveLastFrame() wait for the last submitted frame and return its pixels.
+		- SetFrameSink() streams every headless frame instead. Nothing waits on the copy: frame N's
+		  readback buffer is picked up when its frame slot comes around again, by which point Begin()
+		  has already waited on it, and a FrameStreamer writes it out on a worker thread.
+		- Every mesh carries a PipelineStateDescription. Pipelines come from the PipelineRegistry, which
+		  builds each distinct state once on its compile threads. They are resolved on the render thread
+		  before recording, and the secondaries only rebind when consecutive draws use different pipelines.
+		- All pipelines share mPipelineLayout, the layout the default state's shaders declare, so the
+		  descriptor sets and push constants stay bound across a switch. SetMeshPipelineState() and
+		  PrewarmPipelines() throw for states whose shaders declare a different layout.
+		- A mesh whose pipeline is still compiling is drawn with the fallback (default state) pipeline, or
+		  skipped, see DRAW_PENDING_WITH_FALLBACK. Once the registry's ready generation moves the frames
+		  are recorded again with the real pipeline.
+		- With ENABLE_SHADER_HOT_RELOAD a ShaderWatcher watches SHADER_DIRECTORY. At the start of Draw()
+		  changed sources are recompiled and only the pipelines using them are rebuilt, same path as above.
+		  The pipelines they replace are deleted once the graphics timeline passes the last frame that
+		  could have used them.
+		- Async compute goes through the ComputeContext. Draw() submits its batch before the frame and the
+		  frame acquires whatever the batch released to graphics, waiting on the compute timeline only
+		  when compute runs on a queue of its own.
+		- Textures live in one BindlessTextureTable. AddTexture() returns the texture's slot in it, which is
+		  what AddMesh() takes as texID. Every secondary binds the table once and draws push their slot.
+		- Mesh IDs are indices into mMeshList and stay valid until the mesh is removed. Removed meshes
+		  leave a nullptr behind that AddMesh() reuses.
+		- LoadModel() imports a model file as a single mesh, one draw per submesh out of shared buffers.
+		  Its textures are added to the bindless table, the geometry goes out with the same upload batch.
+		  A current cooked file (see CookedModel) is mapped and uploaded as is, Assimp only runs without one.
 
 */
 
 class Renderer {
 public:
 	Renderer(WindowWrapper*);
+	Renderer(uint32_t, uint32_t);
 	~Renderer();
 
 	void Draw();
@@ -55,20 +154,73 @@ public:
 	void UpdateModel(int, glm::mat4);
 
 	void UpdateCamera(glm::mat4);
+
+	int AddTexture(std::string);
+	int AddMesh(std::vector<Vertex>*, std::vector<uint32_t>*);
+	int AddMesh(std::vector<Vertex>*, std::vector<uint32_t>*, int);
+	int LoadModel(std::string);
+	void RemoveMesh(int);
+	void SetMeshVisible(int, bool);
+	void SetMeshPipelineState(int, PipelineStateDescription);
+	void PrewarmPipelines(std::vector<PipelineStateDescription>);
+
+	void SetFramesInFlight(uint32_t);
+	uint32_t GetFramesInFlight();
+
+	FramePacingStats GetFramePacingStats();
+	PipelineRegistryStats GetPipelineStats();
+	DescriptorAllocatorStats GetDescriptorStats();
+	DescriptorSetCacheStats GetDescriptorSetCacheStats();
+
+	PhysicalDeviceWrapper* GetPhysicalDevice();
+	LogicalDeviceWrapper* GetLogicalDevice();
+	ComputeContext* GetComputeContext();
+	DescriptorSetCache* GetDescriptorSetCache();
+	PipelineWrapper* GetComputePipeline(std::string);
+
+	bool IsHeadless();
+	std::vector<uint8_t> ReadbackLastFrame();
+	void SaveLastFrame(std::string);
+	void SetFrameSink(FrameSink*);
+	void FlushFrameSink();
 private:
-	void RecordCommands();
+	void Initialize();
+	void Present(FrameContext*, uint32_t);
+	VkExtent2D GetRenderExtent();
+	void StreamReadback(uint32_t);
 
-	void allocateDynamicBufferTransferSpace();
+	void RecreateSwapchain();
+	void CreateSwapchainResources();
+	void DestroySwapchainResources();
+
+	void CreateFrameContexts(uint32_t);
+	void DestroyFrameContexts();
+
+	void RecordFrameCommands(FrameContext*, uint32_t);
+	void RecordSecondaryCommands(FrameContext*, size_t, std::vector<size_t>&, std::vector<PipelineWrapper*>&, size_t, size_t, FrameUniforms&);
+
+	FrameUniforms AllocateFrameUniforms(FrameContext*);
+	int CreateModelMesh(const Vertex*, uint32_t, const uint32_t*, uint32_t, std::vector<Submesh>, const std::vector<ModelMaterial>&);
+	int InsertMesh(Mesh*);
+	void DeleteRetiredMeshes(bool);
+	void CheckPipelineLayout(const PipelineStateDescription&);
+	void ReloadChangedShaders();
+	void DeleteRetiredPipelines(bool);
 
 	std::vector<Mesh*> mMeshList;
+	std::vector<PendingMeshDelete> mPendingMeshDeletes;
+	uint64_t mSceneVersion;
+	uint64_t mFrameNumber;
 
 	UboViewProjection mVP;
 
-	int mCurrentFrame;
-
-	VkDeviceSize mMinUniformBufferOffset;
-	size_t mModelUniformAlignment;
-	glm::mat4* mModelTransferSpace;
+	uint32_t mCurrentFrame;
+	FramePacingStats mPacingStats;
+	bool mSwapchainDirty;								// Out of date or suboptimal, recreate before the next frame
+	uint32_t mLastImageIndex;
+	uint64_t mLastSubmittedValue;						// Graphics timeline value of the last submitted frame
+	std::vector<PendingReadback> mPendingReadbacks;		// Indexed like the OffscreenTarget's images
+	uint64_t mStreamedFrameCount;
 
 	WindowWrapper* mWindow;
 	InstanceWrapper* mInstance;
@@ -76,27 +228,33 @@ private:
 	PhysicalDeviceWrapper* mPhysicalDevice;
 	LogicalDeviceWrapper* mLogicalDevice;
 	SwapchainWrapper* mSwapchain;
+	OffscreenTarget* mOffscreenTarget;
+	FrameStreamer* mFrameStreamer;
 	RenderPassWrapper* mRenderPass;
-	PipelineWrapper* mPipeline;
+	PipelineLayoutWrapper* mPipelineLayout;				// Layouts are owned by the registry
+	PipelineRegistry* mPipelineRegistry;
+	PipelineWrapper* mFallbackPipeline;
+	uint64_t mPipelineGeneration;						// Registry ready generation the scene was last recorded against
+	std::vector<RetiredPipeline> mRetiredPipelines;
+	ShaderCompiler* mShaderCompiler;					// Both nullptr unless ENABLE_SHADER_HOT_RELOAD
+	ShaderWatcher* mShaderWatcher;
 	std::vector<FramebufferWrapper*> mFramebuffers;
-	CommandPoolWrapper* mGraphicsCommandPool;
-	CommandPoolWrapper* mTransferCommandPool;
-	DescriptorPoolWrapper* mDescriptorPool;
-	DescriptorPoolWrapper* mTDescriptorPool;
+	DescriptorAllocator* mDescriptorAllocator;			// Long-lived sets, frames have transient allocators of their own
+	DescriptorSetCache* mDescriptorSetCache;			// Allocates from mDescriptorAllocator
 	ImageWrapper* mDepthImage;
 	ImageViewWrapper* mDepthImageView;
-	ImageWrapper* mTextureImage;
-	ImageViewWrapper* mTextureImageView;
-	std::vector<CommandBufferWrapper*> mCommandBuffers;
-	std::vector<SemaphoreWrapper*> mImageAvailableSemaphores;
-	std::vector<SemaphoreWrapper*> mRenderFinishedSemaphores;
-	std::vector<FenceWrapper*> mDrawFences;
+	std::vector<ImageWrapper*> mTextureImages;
+	std::vector<ImageViewWrapper*> mTextureImageViews;
+	BindlessTextureTable* mBindlessTable;
+	uint32_t mDefaultSamplerIndex;
+	ThreadPool* mThreadPool;
+	std::vector<FrameContext*> mFrames;
 	DescriptorSetLayoutWrapper* mDescriptorSetLayout;
-	DescriptorSetLayoutWrapper* mTSDescriptorSetLayout;
-	std::vector<BufferWrapper*> mUniformBuffers;
-	std::vector<BufferWrapper*> mDynamicUniformBuffers;
-	std::vector<DescriptorSetWrapper*> mDescriptorSets;
-	DescriptorSetWrapper* mTextureDescriptorSet;
+	UniformRingBuffer* mUniformRing;
 	SamplerWrapper* mSampler;
+	UploadContext* mUploadContext;
+	ComputeContext* mComputeContext;
+	uint64_t mComputeWaitValue;							// Compute timeline value the frame being recorded waits on, 0 for none
+	VkPipelineStageFlags mComputeWaitStages;
 };
 #endif
@@ -1,16 +1,27 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout (constant_id = 0) const bool USE_TEXTURE = true;
 
 layout (location = 0) in vec2 fragUV;
 layout (location = 1) in vec3 fragCol;
 
-layout (set = 1, binding = 0) uniform sampler2D textureSampler;
+// Bindless table, every texture and sampler the renderer knows about
+layout (set = 1, binding = 0) uniform texture2D textures[];
+layout (set = 1, binding = 1) uniform sampler samplers[];
+
+layout (push_constant) uniform Material {
+	uint textureIndex;
+	uint samplerIndex;
+} material;
 
 layout (location = 0) out vec4 outColor;
 
 void main(void) {
-	if (fragUV.x == 0 && fragUV.y == 0) {
-		outColor = vec4(fragCol.x, fragCol.y, fragCol.z, 1.0);
+	// Specialization constant, the untaken side is removed when the pipeline is built
+	if (USE_TEXTURE) {
+		outColor = texture(sampler2D(textures[material.textureIndex], samplers[material.samplerIndex]), fragUV);
 	} else {
-		outColor = texture(textureSampler, fragUV);
+		outColor = vec4(fragCol.x, fragCol.y, fragCol.z, 1.0);
 	}
 }
\ No newline at end of file
@@ -3,7 +3,16 @@
 #include "LogicalDeviceWrapper.h"
 
 SamplerWrapper::SamplerWrapper(LogicalDeviceWrapper* lDevice) : mLogicalDevice(lDevice) {
-	CreateSampler();
+	CreateSampler(0.0f);
+}
+
+/*
+
+	Sampler for an image with the given number of mip levels. The LOD range covers the whole chain.
+
+*/
+SamplerWrapper::SamplerWrapper(LogicalDeviceWrapper* lDevice, uint32_t mipLevels) : mLogicalDevice(lDevice) {
+	CreateSampler((float)(mipLevels - 1));
 }
 
 SamplerWrapper::~SamplerWrapper() {
@@ -14,7 +23,7 @@ VkSampler SamplerWrapper::GetSampler() {
 	return mSampler;
 }
 
-void SamplerWrapper::CreateSampler() {
+void SamplerWrapper::CreateSampler(float maxLod) {
 	VkSamplerCreateInfo samplerCI = {
 		.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
 		.pNext = nullptr,
@@ -31,7 +40,7 @@ void SamplerWrapper::CreateSampler() {
 		.compareEnable = VK_FALSE,
 		.compareOp = VK_COMPARE_OP_NEVER,
 		.minLod = 0.0f,
-		.maxLod = 0.0f,
+		.maxLod = maxLod,
 		.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
 		.unnormalizedCoordinates = VK_FALSE
 	};
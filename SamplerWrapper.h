@@ -8,11 +8,12 @@ class LogicalDeviceWrapper;
 class SamplerWrapper {
 public:
 	SamplerWrapper(LogicalDeviceWrapper*);
+	SamplerWrapper(LogicalDeviceWrapper*, uint32_t);
 	~SamplerWrapper();
 
 	VkSampler GetSampler();
 private:
-	void CreateSampler();
+	void CreateSampler(float);
 
 	VkSampler mSampler;
 
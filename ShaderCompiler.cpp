@@ -0,0 +1,260 @@
+#include "ShaderCompiler.h"
+#include "globals.h"
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <stdexcept>
+#include <shaderc/shaderc.hpp>
+#include "ThreadPool.h"
+
+static std::string ReadTextFile(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open()) {
+		throw std::runtime_error("Failed to open file " + path + "!");
+	}
+	std::stringstream contents;
+	contents << file.rdbuf();
+	return contents.str();
+}
+
+static uint64_t HashBytes(uint64_t hash, const void* data, size_t size) {
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+static bool ShaderKindFromPath(const std::string& path, shaderc_shader_kind& kind) {
+	std::string extension = std::filesystem::path(path).extension().string();
+	if (extension == ".vert") {
+		kind = shaderc_vertex_shader;
+	} else if (extension == ".tesc") {
+		kind = shaderc_tess_control_shader;
+	} else if (extension == ".tese") {
+		kind = shaderc_tess_evaluation_shader;
+	} else if (extension == ".geom") {
+		kind = shaderc_geometry_shader;
+	} else if (extension == ".frag") {
+		kind = shaderc_fragment_shader;
+	} else if (extension == ".comp") {
+		kind = shaderc_compute_shader;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+// Resolves #include "file" relative to the including file
+class ShaderIncluder : public shaderc::CompileOptions::IncluderInterface {
+public:
+	shaderc_include_result* GetInclude(const char* requested, shaderc_include_type, const char* requesting, size_t) override {
+		IncludeData* data = new IncludeData();
+		data->mPath = (std::filesystem::path(requesting).parent_path() / requested).string();
+		try {
+			data->mContent = ReadTextFile(data->mPath);
+		} catch (const std::runtime_error& e) {
+			// shaderc reports an include error as an empty source name with the message as content
+			data->mPath.clear();
+			data->mContent = e.what();
+		}
+
+		data->mResult.source_name = data->mPath.c_str();
+		data->mResult.source_name_length = data->mPath.size();
+		data->mResult.content = data->mContent.c_str();
+		data->mResult.content_length = data->mContent.size();
+		data->mResult.user_data = data;
+		return &data->mResult;
+	}
+
+	void ReleaseInclude(shaderc_include_result* result) override {
+		delete (IncludeData*)result->user_data;
+	}
+private:
+	struct IncludeData {
+		std::string mPath;
+		std::string mContent;
+		shaderc_include_result mResult;
+	};
+};
+
+ShaderCompiler::ShaderCompiler(uint32_t threadCount) {
+	mThreadPool = new ThreadPool(threadCount);
+	std::cout << "Success: Shader Compiler created." << std::endl;
+}
+
+ShaderCompiler::~ShaderCompiler() {
+	delete mThreadPool; std::cout << "Success: Shader Compiler destroyed." << std::endl;
+}
+
+void ShaderCompiler::AddDefine(std::string name, std::string value) {
+	mDefines.push_back({ name, value });
+}
+
+/*
+
+	Compiles every shader source in the directory that is out of date. Throws with every error
+	message if any of them failed.
+
+*/
+ShaderCompileStats ShaderCompiler::CompileDirectory(std::string directory) {
+	auto start = std::chrono::high_resolution_clock::now();
+
+	std::vector<std::string> sources;
+	for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+		if (entry.is_regular_file() && IsShaderSource(entry.path().string())) {
+			sources.push_back(entry.path().string());
+		}
+	}
+
+	ShaderCompileStats stats = { };
+	std::mutex statsMutex;
+	mErrors.clear();
+	for (size_t i = 0; i < sources.size(); i++) {
+		std::string source = sources.at(i);
+		mThreadPool->Submit([this, source, &stats, &statsMutex]() {
+			bool compiled = false;
+			bool failed = false;
+			try {
+				compiled = CompileFile(source);
+			} catch (const std::runtime_error& e) {
+				std::lock_guard<std::mutex> lock(mErrorMutex);
+				mErrors.push_back(e.what());
+				failed = true;
+			}
+
+			std::lock_guard<std::mutex> lock(statsMutex);
+			if (failed) {
+				stats.mFailed++;
+			} else if (compiled) {
+				stats.mCompiled++;
+			} else {
+				stats.mUpToDate++;
+			}
+		});
+	}
+	mThreadPool->Wait();
+
+	stats.mTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	std::cout << "Shader Compiler: " << stats.mCompiled << " compiled, " << stats.mUpToDate << " up to date, " << stats.mFailed << " failed in " << stats.mTime << " ms" << std::endl;
+
+	if (!mErrors.empty()) {
+		std::string message = "Failed to compile shaders!";
+		for (size_t i = 0; i < mErrors.size(); i++) {
+			message += "\n" + mErrors.at(i);
+		}
+		throw std::runtime_error(message);
+	}
+	return stats;
+}
+
+/*
+
+	Compiles source to source.spv unless source.spv.hash says it's up to date. Returns whether it
+	compiled. Thread safe, shaderc compilers are cheap so every call makes its own.
+
+*/
+bool ShaderCompiler::CompileFile(std::string source) {
+	shaderc_shader_kind kind;
+	if (!ShaderKindFromPath(source, kind)) {
+		throw std::runtime_error("Failed to compile " + source + "! Invalid file extension.");
+	}
+
+	std::string output = source + ".spv";
+	std::string hashPath = output + ".hash";
+
+	uint64_t hash = HashInputs(source);
+	std::string hashText = std::to_string(hash);
+	if (std::filesystem::exists(output) && std::filesystem::exists(hashPath) && ReadTextFile(hashPath) == hashText) {
+		return false;
+	}
+
+	shaderc::Compiler compiler;
+	shaderc::CompileOptions options;
+	options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
+	options.SetIncluder(std::make_unique<ShaderIncluder>());
+	for (size_t i = 0; i < mDefines.size(); i++) {
+		options.AddMacroDefinition(mDefines.at(i).first, mDefines.at(i).second);
+	}
+
+	std::string code = ReadTextFile(source);
+	shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(code, kind, source.c_str(), options);
+	if (result.GetCompilationStatus() != shaderc_compilation_status_success) {
+		throw std::runtime_error(result.GetErrorMessage());
+	}
+
+	// Hash last, a crash in between leaves a stale hash behind which just means compiling again
+	std::ofstream spv(output, std::ios::binary | std::ios::trunc);
+	spv.write((const char*)result.cbegin(), (std::streamsize)((result.cend() - result.cbegin()) * sizeof(uint32_t)));
+	spv.close();
+	std::ofstream hashFile(hashPath, std::ios::binary | std::ios::trunc);
+	hashFile << hashText;
+	if (!spv || !hashFile) {
+		throw std::runtime_error("Failed to write " + output + "!");
+	}
+
+	std::cout << "Success: Compiled " << source << std::endl;
+	return true;
+}
+
+bool ShaderCompiler::IsShaderSource(std::string path) {
+	shaderc_shader_kind kind;
+	return ShaderKindFromPath(path, kind);
+}
+
+uint64_t ShaderCompiler::HashInputs(std::string source) {
+	uint64_t hash = 14695981039346656037ull;
+
+	std::vector<std::string> visited;
+	HashFile(source, hash, visited);
+
+	for (size_t i = 0; i < mDefines.size(); i++) {
+		hash = HashBytes(hash, mDefines.at(i).first.data(), mDefines.at(i).first.size() + 1);
+		hash = HashBytes(hash, mDefines.at(i).second.data(), mDefines.at(i).second.size() + 1);
+	}
+
+	// shaderc has no version query of its own, but it ships with the Vulkan SDK we build against, so the
+	// SDK's header version stands in for the compiler build. The SPIR-V version only changes with the target.
+	uint32_t sdkVersion = VK_HEADER_VERSION_COMPLETE;
+	unsigned int spvVersion = 0;
+	unsigned int spvRevision = 0;
+	shaderc_get_spv_version(&spvVersion, &spvRevision);
+	hash = HashBytes(hash, &sdkVersion, sizeof(sdkVersion));
+	hash = HashBytes(hash, &spvVersion, sizeof(spvVersion));
+	hash = HashBytes(hash, &spvRevision, sizeof(spvRevision));
+	hash = HashBytes(hash, &SHADER_CACHE_VERSION, sizeof(SHADER_CACHE_VERSION));
+	return hash;
+}
+
+// Hashes the file and, depth first, every file it includes. Each file is only hashed once.
+void ShaderCompiler::HashFile(std::string path, uint64_t& hash, std::vector<std::string>& visited) {
+	std::string canonical = std::filesystem::weakly_canonical(path).string();
+	if (std::find(visited.begin(), visited.end(), canonical) != visited.end()) {
+		return;
+	}
+	visited.push_back(canonical);
+
+	std::string code = ReadTextFile(path);
+	hash = HashBytes(hash, code.data(), code.size());
+
+	std::istringstream lines(code);
+	std::string line;
+	while (std::getline(lines, line)) {
+		size_t include = line.find("#include");
+		if (include == std::string::npos) {
+			continue;
+		}
+		size_t open = line.find_first_of("\"<", include);
+		size_t close = open == std::string::npos ? std::string::npos : line.find_first_of("\">", open + 1);
+		if (close == std::string::npos) {
+			continue;
+		}
+		std::string included = (std::filesystem::path(path).parent_path() / line.substr(open + 1, close - open - 1)).string();
+		if (std::filesystem::exists(included)) {
+			HashFile(included, hash, visited);
+		}
+	}
+}
@@ -0,0 +1,57 @@
+#ifndef SHADER_COMPILER_H
+#define SHADER_COMPILER_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+class ThreadPool;
+
+struct ShaderCompileStats {
+	uint32_t mCompiled;
+	uint32_t mUpToDate;									// Skipped, the .spv on disk was built from the same inputs
+	uint32_t mFailed;
+	double mTime;										// Wall clock time of the whole CompileDirectory() call, in milliseconds
+};
+
+/*
+
+	ShaderCompiler turns GLSL into SPIR-V in process with shaderc and skips anything that hasn't changed.
+
+	Notes:
+		- Next to every X.spv sits X.spv.hash, the hash of everything the SPIR-V was built from: the
+		  source, every file it #includes (recursively), the defines, the Vulkan SDK version (shaderc comes
+		  with the SDK and can't report its own version) and the SPIR-V version shaderc emits. A shader is
+		  only compiled again when that hash changes, so a warm start compiles nothing. Bump
+		  SHADER_CACHE_VERSION after swapping shaderc without changing the SDK.
+		- The .spv and .spv.hash files are build output and aren't checked in. main() compiles
+		  SHADER_DIRECTORY before the renderer loads anything.
+		- Includes are resolved relative to the including file. The hash finds them by scanning for
+		  #include lines, the compile itself resolves them through shaderc.
+		- CompileDirectory() compiles every shader in a directory in parallel, one task per file. All
+		  errors are collected and thrown together once every file has been tried.
+		- Stage comes from the extension, same as ShaderWrapper: .vert .tesc .tese .geom .frag .comp
+
+*/
+
+class ShaderCompiler {
+public:
+	ShaderCompiler(uint32_t);
+	~ShaderCompiler();
+
+	void AddDefine(std::string, std::string);
+
+	ShaderCompileStats CompileDirectory(std::string);
+	bool CompileFile(std::string);
+	static bool IsShaderSource(std::string);
+private:
+	uint64_t HashInputs(std::string);
+	void HashFile(std::string, uint64_t&, std::vector<std::string>&);
+
+	std::vector<std::pair<std::string, std::string>> mDefines;
+	ThreadPool* mThreadPool;
+	std::mutex mErrorMutex;
+	std::vector<std::string> mErrors;
+};
+#endif
@@ -0,0 +1,334 @@
+#include "ShaderReflection.h"
+#include "globals.h"
+#include <cstring>
+#include <algorithm>
+
+// The few SPIR-V enums the interface is made of, see the SPIR-V specification
+enum SpirvOp {
+	SPV_OP_ENTRY_POINT = 15,
+	SPV_OP_TYPE_INT = 21,
+	SPV_OP_TYPE_FLOAT = 22,
+	SPV_OP_TYPE_VECTOR = 23,
+	SPV_OP_TYPE_MATRIX = 24,
+	SPV_OP_TYPE_IMAGE = 25,
+	SPV_OP_TYPE_SAMPLER = 26,
+	SPV_OP_TYPE_SAMPLED_IMAGE = 27,
+	SPV_OP_TYPE_ARRAY = 28,
+	SPV_OP_TYPE_RUNTIME_ARRAY = 29,
+	SPV_OP_TYPE_STRUCT = 30,
+	SPV_OP_TYPE_POINTER = 32,
+	SPV_OP_CONSTANT = 43,
+	SPV_OP_VARIABLE = 59,
+	SPV_OP_DECORATE = 71,
+	SPV_OP_MEMBER_DECORATE = 72
+};
+
+enum SpirvDecoration {
+	SPV_DECORATION_BLOCK = 2,
+	SPV_DECORATION_BUFFER_BLOCK = 3,
+	SPV_DECORATION_ARRAY_STRIDE = 6,
+	SPV_DECORATION_MATRIX_STRIDE = 7,
+	SPV_DECORATION_BUILT_IN = 11,
+	SPV_DECORATION_LOCATION = 30,
+	SPV_DECORATION_BINDING = 33,
+	SPV_DECORATION_DESCRIPTOR_SET = 34,
+	SPV_DECORATION_OFFSET = 35
+};
+
+enum SpirvStorageClass {
+	SPV_STORAGE_UNIFORM_CONSTANT = 0,
+	SPV_STORAGE_INPUT = 1,
+	SPV_STORAGE_UNIFORM = 2,
+	SPV_STORAGE_PUSH_CONSTANT = 9,
+	SPV_STORAGE_STORAGE_BUFFER = 12
+};
+
+const uint32_t SPV_MAGIC_NUMBER = 0x07230203;
+const uint32_t SPV_DIM_BUFFER = 5;
+const uint32_t SPV_DIM_SUBPASS_DATA = 6;
+
+ShaderReflection::ShaderReflection(const std::vector<char>& code) : mStage(VK_SHADER_STAGE_ALL), mPushConstantSize(0) {
+	Parse(code);
+
+	for (size_t i = 0; i < mVariables.size(); i++) {
+		ReflectVariable(mIds[mVariables.at(i)]);
+	}
+
+	std::sort(mBindings.begin(), mBindings.end(), [](const ReflectedBinding& a, const ReflectedBinding& b) {
+		return a.mSet != b.mSet ? a.mSet < b.mSet : a.mBinding < b.mBinding;
+	});
+	std::sort(mInputs.begin(), mInputs.end(), [](const ReflectedInput& a, const ReflectedInput& b) {
+		return a.mLocation < b.mLocation;
+	});
+
+	// Only needed while reflecting
+	mIds.clear();
+	mVariables.clear();
+}
+
+VkShaderStageFlagBits ShaderReflection::GetStage() {
+	return mStage;
+}
+
+std::vector<ReflectedBinding> ShaderReflection::GetBindings() {
+	return mBindings;
+}
+
+uint32_t ShaderReflection::GetPushConstantSize() {
+	return mPushConstantSize;
+}
+
+std::vector<ReflectedInput> ShaderReflection::GetInputs() {
+	return mInputs;
+}
+
+/*
+
+	Every instruction starts with a word holding its length in words (high half) and its opcode (low
+	half), the operands follow. Ids are collected first since decorations come before the types and
+	variables they apply to.
+
+*/
+void ShaderReflection::Parse(const std::vector<char>& code) {
+	if (code.size() < 20 || code.size() % 4 != 0) {
+		throw std::runtime_error("Failed to reflect shader! Not a SPIR-V module.");
+	}
+
+	std::vector<uint32_t> words(code.size() / 4);
+	std::memcpy(words.data(), code.data(), code.size());
+	if (words.at(0) != SPV_MAGIC_NUMBER) {
+		throw std::runtime_error("Failed to reflect shader! Invalid SPIR-V magic number.");
+	}
+
+	// Skip the header: magic, version, generator, bound, schema
+	size_t offset = 5;
+	while (offset < words.size()) {
+		uint32_t wordCount = words.at(offset) >> 16;
+		uint32_t opcode = words.at(offset) & 0xFFFF;
+		if (wordCount == 0 || offset + wordCount > words.size()) {
+			throw std::runtime_error("Failed to reflect shader! Truncated SPIR-V instruction.");
+		}
+		const uint32_t* operands = words.data() + offset + 1;
+
+		switch (opcode) {
+			case SPV_OP_ENTRY_POINT:
+				switch (operands[0]) {
+					case 0: mStage = VK_SHADER_STAGE_VERTEX_BIT; break;
+					case 1: mStage = VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT; break;
+					case 2: mStage = VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT; break;
+					case 3: mStage = VK_SHADER_STAGE_GEOMETRY_BIT; break;
+					case 4: mStage = VK_SHADER_STAGE_FRAGMENT_BIT; break;
+					case 5: mStage = VK_SHADER_STAGE_COMPUTE_BIT; break;
+				}
+				break;
+			case SPV_OP_DECORATE: {
+				SpirvId& id = mIds[operands[0]];
+				switch (operands[1]) {
+					case SPV_DECORATION_BLOCK: id.mBlock = true; break;
+					case SPV_DECORATION_BUFFER_BLOCK: id.mBufferBlock = true; break;
+					case SPV_DECORATION_ARRAY_STRIDE: id.mArrayStride = operands[2]; break;
+					case SPV_DECORATION_BUILT_IN: id.mBuiltIn = true; break;
+					case SPV_DECORATION_LOCATION: id.mLocation = operands[2]; id.mHasLocation = true; break;
+					case SPV_DECORATION_BINDING: id.mBinding = operands[2]; id.mHasBinding = true; break;
+					case SPV_DECORATION_DESCRIPTOR_SET: id.mSet = operands[2]; id.mHasSet = true; break;
+				}
+				break;
+			}
+			case SPV_OP_MEMBER_DECORATE: {
+				SpirvId& id = mIds[operands[0]];
+				uint32_t member = operands[1];
+				if (operands[2] == SPV_DECORATION_OFFSET) {
+					id.mMemberOffsets.resize(std::max(id.mMemberOffsets.size(), (size_t)member + 1), 0);
+					id.mMemberOffsets.at(member) = operands[3];
+				} else if (operands[2] == SPV_DECORATION_MATRIX_STRIDE) {
+					id.mMemberMatrixStrides.resize(std::max(id.mMemberMatrixStrides.size(), (size_t)member + 1), 0);
+					id.mMemberMatrixStrides.at(member) = operands[3];
+				} else if (operands[2] == SPV_DECORATION_BUILT_IN) {
+					id.mBuiltIn = true;
+				}
+				break;
+			}
+			case SPV_OP_TYPE_INT:
+				mIds[operands[0]].mOpcode = opcode;
+				mIds[operands[0]].mValue = operands[1];
+				mIds[operands[0]].mSigned = operands[2] != 0;
+				break;
+			case SPV_OP_TYPE_FLOAT:
+				mIds[operands[0]].mOpcode = opcode;
+				mIds[operands[0]].mValue = operands[1];
+				break;
+			case SPV_OP_TYPE_VECTOR:
+			case SPV_OP_TYPE_MATRIX:
+				mIds[operands[0]].mOpcode = opcode;
+				mIds[operands[0]].mType = operands[1];
+				mIds[operands[0]].mValue = operands[2];
+				break;
+			case SPV_OP_TYPE_IMAGE:
+				mIds[operands[0]].mOpcode = opcode;
+				mIds[operands[0]].mDim = operands[2];
+				mIds[operands[0]].mSampled = operands[6];
+				break;
+			case SPV_OP_TYPE_SAMPLER:
+				mIds[operands[0]].mOpcode = opcode;
+				break;
+			case SPV_OP_TYPE_SAMPLED_IMAGE:
+			case SPV_OP_TYPE_RUNTIME_ARRAY:
+				mIds[operands[0]].mOpcode = opcode;
+				mIds[operands[0]].mType = operands[1];
+				break;
+			case SPV_OP_TYPE_ARRAY:
+				// The length is the id of a constant, resolved once everything is parsed
+				mIds[operands[0]].mOpcode = opcode;
+				mIds[operands[0]].mType = operands[1];
+				mIds[operands[0]].mValue = operands[2];
+				break;
+			case SPV_OP_TYPE_STRUCT:
+				mIds[operands[0]].mOpcode = opcode;
+				mIds[operands[0]].mMembers.assign(operands + 1, operands + wordCount - 1);
+				break;
+			case SPV_OP_TYPE_POINTER:
+				mIds[operands[0]].mOpcode = opcode;
+				mIds[operands[0]].mStorageClass = operands[1];
+				mIds[operands[0]].mType = operands[2];
+				break;
+			case SPV_OP_CONSTANT:
+				mIds[operands[1]].mOpcode = opcode;
+				mIds[operands[1]].mValue = operands[2];
+				break;
+			case SPV_OP_VARIABLE:
+				mIds[operands[1]].mOpcode = opcode;
+				mIds[operands[1]].mType = operands[0];
+				mIds[operands[1]].mStorageClass = operands[2];
+				mVariables.push_back(operands[1]);
+				break;
+		}
+
+		offset += wordCount;
+	}
+}
+
+void ShaderReflection::ReflectVariable(SpirvId& variable) {
+	uint32_t type = mIds[variable.mType].mType;
+
+	switch (variable.mStorageClass) {
+		case SPV_STORAGE_UNIFORM_CONSTANT:
+		case SPV_STORAGE_UNIFORM:
+		case SPV_STORAGE_STORAGE_BUFFER: {
+			if (!variable.mHasBinding) {
+				return;
+			}
+
+			// Arrays of descriptors become one binding with descriptorCount elements
+			uint32_t count = 1;
+			if (mIds[type].mOpcode == SPV_OP_TYPE_ARRAY) {
+				count = mIds[mIds[type].mValue].mValue;
+				type = mIds[type].mType;
+			} else if (mIds[type].mOpcode == SPV_OP_TYPE_RUNTIME_ARRAY) {
+				count = 0;
+				type = mIds[type].mType;
+			}
+
+			mBindings.push_back({
+				.mSet = variable.mHasSet ? variable.mSet : 0,
+				.mBinding = variable.mBinding,
+				.mType = GetDescriptorType(variable.mStorageClass, type),
+				.mCount = count
+			});
+			break;
+		}
+		case SPV_STORAGE_PUSH_CONSTANT:
+			mPushConstantSize = std::max(mPushConstantSize, GetTypeSize(type, 0));
+			break;
+		case SPV_STORAGE_INPUT:
+			// Only vertex inputs come from buffers, everything else is fed by the previous stage
+			if (mStage == VK_SHADER_STAGE_VERTEX_BIT && variable.mHasLocation && !variable.mBuiltIn && !mIds[type].mBuiltIn) {
+				mInputs.push_back({ variable.mLocation, GetInputFormat(type) });
+			}
+			break;
+	}
+}
+
+VkDescriptorType ShaderReflection::GetDescriptorType(uint32_t storageClass, uint32_t type) {
+	SpirvId& id = mIds[type];
+
+	if (storageClass == SPV_STORAGE_STORAGE_BUFFER || id.mBufferBlock) {
+		return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	}
+	if (storageClass == SPV_STORAGE_UNIFORM) {
+		return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	}
+
+	switch (id.mOpcode) {
+		case SPV_OP_TYPE_SAMPLED_IMAGE:
+			return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		case SPV_OP_TYPE_SAMPLER:
+			return VK_DESCRIPTOR_TYPE_SAMPLER;
+		case SPV_OP_TYPE_IMAGE:
+			// Sampled 2 means used without a sampler, i.e. storage
+			if (id.mDim == SPV_DIM_BUFFER) {
+				return id.mSampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+			}
+			if (id.mDim == SPV_DIM_SUBPASS_DATA) {
+				return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+			}
+			return id.mSampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+	}
+	throw std::runtime_error("Failed to reflect shader! Unsupported descriptor type.");
+}
+
+VkFormat ShaderReflection::GetInputFormat(uint32_t type) {
+	uint32_t componentCount = 1;
+	if (mIds[type].mOpcode == SPV_OP_TYPE_VECTOR) {
+		componentCount = mIds[type].mValue;
+		type = mIds[type].mType;
+	}
+
+	SpirvId& component = mIds[type];
+	if (component.mValue != 32 || componentCount < 1 || componentCount > 4) {
+		throw std::runtime_error("Failed to reflect shader! Only 32 bit scalar and vector inputs are supported.");
+	}
+
+	const VkFormat floatFormats[] = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT };
+	const VkFormat intFormats[] = { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT };
+	const VkFormat uintFormats[] = { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT };
+
+	if (component.mOpcode == SPV_OP_TYPE_FLOAT) {
+		return floatFormats[componentCount - 1];
+	}
+	if (component.mOpcode == SPV_OP_TYPE_INT) {
+		return component.mSigned ? intFormats[componentCount - 1] : uintFormats[componentCount - 1];
+	}
+	throw std::runtime_error("Failed to reflect shader! Unsupported vertex input type.");
+}
+
+/*
+
+	Size in bytes of a type inside a push constant block. matrixStride comes from the member decoration
+	when the type is a struct member, 0 otherwise.
+
+*/
+uint32_t ShaderReflection::GetTypeSize(uint32_t type, uint32_t matrixStride) {
+	SpirvId& id = mIds[type];
+
+	switch (id.mOpcode) {
+		case SPV_OP_TYPE_INT:
+		case SPV_OP_TYPE_FLOAT:
+			return id.mValue / 8;
+		case SPV_OP_TYPE_VECTOR:
+			return id.mValue * GetTypeSize(id.mType, 0);
+		case SPV_OP_TYPE_MATRIX:
+			return id.mValue * (matrixStride != 0 ? matrixStride : GetTypeSize(id.mType, 0));
+		case SPV_OP_TYPE_ARRAY:
+			return mIds[id.mValue].mValue * (id.mArrayStride != 0 ? id.mArrayStride : GetTypeSize(id.mType, matrixStride));
+		case SPV_OP_TYPE_STRUCT: {
+			uint32_t size = 0;
+			for (size_t i = 0; i < id.mMembers.size(); i++) {
+				uint32_t memberOffset = i < id.mMemberOffsets.size() ? id.mMemberOffsets.at(i) : 0;
+				uint32_t memberStride = i < id.mMemberMatrixStrides.size() ? id.mMemberMatrixStrides.at(i) : 0;
+				size = std::max(size, memberOffset + GetTypeSize(id.mMembers.at(i), memberStride));
+			}
+			return size;
+		}
+	}
+	return 0;
+}
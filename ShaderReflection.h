@@ -0,0 +1,90 @@
+#ifndef SHADER_REFLECTION_H
+#define SHADER_REFLECTION_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// One descriptor a shader reads, as declared with layout(set = X, binding = Y)
+struct ReflectedBinding {
+	uint32_t mSet;
+	uint32_t mBinding;
+	VkDescriptorType mType;
+	uint32_t mCount;									// Array size, 0 for a runtime sized array
+};
+
+// One vertex shader input, as declared with layout(location = X) in
+struct ReflectedInput {
+	uint32_t mLocation;
+	VkFormat mFormat;
+};
+
+/*
+
+	ShaderReflection reads the interface of a SPIR-V module: which descriptors it uses, how big its push
+	constant block is and, for vertex shaders, which inputs it reads. That's all it takes to build the
+	descriptor set layouts, pool sizes, push constant ranges and vertex attributes the shader expects.
+
+	Notes:
+		- Walks the instruction stream once, no external reflection library. Only the handful of opcodes
+		  that make up the interface are looked at, everything else is skipped by its word count.
+		- Plain and dynamic uniform buffers look the same in SPIR-V. Reflection always reports
+		  UNIFORM_BUFFER, the DescriptorLayoutCache turns it into UNIFORM_BUFFER_DYNAMIC for the sets in
+		  DYNAMIC_UNIFORM_SET_MASK.
+		- Push constant size is the end of the block's last member, using the Offset / ArrayStride /
+		  MatrixStride decorations the compiler emits.
+		- Built-ins (gl_VertexIndex and friends) aren't inputs. 64 bit inputs aren't supported.
+
+*/
+
+class ShaderReflection {
+public:
+	ShaderReflection(const std::vector<char>&);
+
+	VkShaderStageFlagBits GetStage();
+	std::vector<ReflectedBinding> GetBindings();
+	uint32_t GetPushConstantSize();
+	std::vector<ReflectedInput> GetInputs();
+private:
+	// What the parser remembers about a result id, only the fields its opcode uses are set
+	struct SpirvId {
+		uint32_t mOpcode;
+		uint32_t mType;									// Pointee, element, component or column type
+		uint32_t mStorageClass;
+		uint32_t mValue;								// Constants: the value. Int / float: width. Vector / matrix: count.
+		uint32_t mDim;
+		uint32_t mSampled;
+		bool mSigned;
+		std::vector<uint32_t> mMembers;
+		std::vector<uint32_t> mMemberOffsets;
+		std::vector<uint32_t> mMemberMatrixStrides;
+
+		// Decorations
+		uint32_t mSet;
+		uint32_t mBinding;
+		uint32_t mLocation;
+		uint32_t mArrayStride;
+		bool mHasSet;
+		bool mHasBinding;
+		bool mHasLocation;
+		bool mBuiltIn;
+		bool mBlock;
+		bool mBufferBlock;
+	};
+
+	void Parse(const std::vector<char>&);
+	void ReflectVariable(SpirvId&);
+	VkDescriptorType GetDescriptorType(uint32_t, uint32_t);
+	VkFormat GetInputFormat(uint32_t);
+	uint32_t GetTypeSize(uint32_t, uint32_t);
+
+	std::unordered_map<uint32_t, SpirvId> mIds;
+	std::vector<uint32_t> mVariables;
+
+	VkShaderStageFlagBits mStage;
+	std::vector<ReflectedBinding> mBindings;
+	uint32_t mPushConstantSize;
+	std::vector<ReflectedInput> mInputs;
+};
+#endif
@@ -0,0 +1,113 @@
+#include "ShaderWatcher.h"
+#include "globals.h"
+#include <stdexcept>
+#include "ShaderCompiler.h"
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+ShaderWatcher::ShaderWatcher(std::string directory) : mDirectory(directory), mStopping(false) {
+#ifdef __linux__
+	mInotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (mInotify < 0) {
+		throw std::runtime_error("Failed to create shader watcher! inotify_init1 failed.");
+	}
+	mWatch = inotify_add_watch(mInotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (mWatch < 0) {
+		close(mInotify);
+		throw std::runtime_error("Failed to watch " + directory + "!");
+	}
+	mThread = std::thread(&ShaderWatcher::WatchLoop, this);
+#else
+	mThread = std::thread(&ShaderWatcher::PollLoop, this);
+#endif
+	std::cout << "Success: Shader Watcher created. (" << directory << ")" << std::endl;
+}
+
+ShaderWatcher::~ShaderWatcher() {
+	mStopping = true;
+	mThread.join();
+#ifdef __linux__
+	inotify_rm_watch(mInotify, mWatch);
+	close(mInotify);
+#endif
+	std::cout << "Success: Shader Watcher destroyed." << std::endl;
+}
+
+/*
+
+	Returns (and forgets) every source that changed, once the directory has been quiet for the
+	debounce interval. Paths are SHADER_DIRECTORY joined with the file name.
+
+*/
+std::vector<std::string> ShaderWatcher::TakeChangedFiles() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (mChangedFiles.empty() || std::chrono::steady_clock::now() - mLastChange < std::chrono::milliseconds(SHADER_RELOAD_DEBOUNCE_MS)) {
+		return { };
+	}
+
+	std::vector<std::string> changed(mChangedFiles.begin(), mChangedFiles.end());
+	mChangedFiles.clear();
+	return changed;
+}
+
+void ShaderWatcher::MarkChanged(std::string path) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	mChangedFiles.insert(path);
+	mLastChange = std::chrono::steady_clock::now();
+}
+
+bool ShaderWatcher::IsWatchedFile(const std::filesystem::path& path) {
+	// Same test the compiler uses, so the watcher never reports a file it won't compile or the other way around
+	return ShaderCompiler::IsShaderSource(path.string());
+}
+
+void ShaderWatcher::WatchLoop() {
+#ifdef __linux__
+	alignas(inotify_event) char buffer[4096];
+	while (!mStopping) {
+		// Wake up every now and then to notice mStopping
+		pollfd descriptor = { mInotify, POLLIN, 0 };
+		if (poll(&descriptor, 1, 100) <= 0) {
+			continue;
+		}
+
+		ssize_t length = read(mInotify, buffer, sizeof(buffer));
+		for (ssize_t offset = 0; offset < length;) {
+			inotify_event* event = (inotify_event*)(buffer + offset);
+			if (event->len > 0 && IsWatchedFile(event->name)) {
+				MarkChanged((std::filesystem::path(mDirectory) / event->name).string());
+			}
+			offset += sizeof(inotify_event) + event->len;
+		}
+	}
+#endif
+}
+
+void ShaderWatcher::PollLoop() {
+	std::map<std::string, std::filesystem::file_time_type> writeTimes;
+	bool first = true;
+	while (!mStopping) {
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator(mDirectory, error)) {
+			if (!entry.is_regular_file() || !IsWatchedFile(entry.path())) {
+				continue;
+			}
+
+			std::string path = (std::filesystem::path(mDirectory) / entry.path().filename()).string();
+			std::filesystem::file_time_type writeTime = entry.last_write_time(error);
+			auto known = writeTimes.find(path);
+			if (known == writeTimes.end() || known->second != writeTime) {
+				writeTimes[path] = writeTime;
+				if (!first) {
+					MarkChanged(path);
+				}
+			}
+		}
+		first = false;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+}
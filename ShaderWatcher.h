@@ -0,0 +1,54 @@
+#ifndef SHADER_WATCHER_H
+#define SHADER_WATCHER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+
+/*
+
+	ShaderWatcher watches a shader directory on a background thread and collects the shader sources
+	that changed. The Renderer picks them up with TakeChangedFiles() at the start of a frame.
+
+	Notes:
+		- On Linux it sleeps on inotify (IN_CLOSE_WRITE / IN_MOVED_TO, which covers editors that save
+		  through a temporary file and rename). Everywhere else it polls the write times every 100 ms.
+		- A file is only handed out once nothing in the directory changed for SHADER_RELOAD_DEBOUNCE_MS,
+		  so a burst of writes turns into one reload.
+		- Only shader sources are reported (see ShaderCompiler::IsShaderSource()), the .spv files the
+		  reload writes next to them don't trigger another one.
+
+*/
+
+class ShaderWatcher {
+public:
+	ShaderWatcher(std::string);
+	~ShaderWatcher();
+
+	std::vector<std::string> TakeChangedFiles();
+private:
+	void WatchLoop();
+	void PollLoop();
+	void MarkChanged(std::string);
+	bool IsWatchedFile(const std::filesystem::path&);
+
+	std::string mDirectory;
+	std::thread mThread;
+	std::atomic<bool> mStopping;
+
+	std::mutex mMutex;
+	std::set<std::string> mChangedFiles;
+	std::chrono::steady_clock::time_point mLastChange;
+
+#ifdef __linux__
+	int mInotify;
+	int mWatch;
+#endif
+};
+#endif
@@ -2,6 +2,7 @@
 #include "globals.h"
 #include <fstream>
 #include "LogicalDeviceWrapper.h"
+#include "ShaderReflection.h"
 
 std::vector<char> readShaderFile(std::string filename) {
 	// Open stream from given file
@@ -34,6 +35,7 @@ ShaderWrapper::ShaderWrapper(LogicalDeviceWrapper* lDevice, std::string filename
 }
 
 ShaderWrapper::~ShaderWrapper() {
+	delete mReflection;
 	vkDestroyShaderModule(mLogicalDevice->GetLogicalDevice(), mShaderModule, nullptr); std::cout << "Success: Shader module destroyed." << std::endl;
 }
 
@@ -41,8 +43,20 @@ VkShaderModule ShaderWrapper::GetShaderModule() {
 	return mShaderModule;
 }
 
-VkPipelineShaderStageCreateInfo ShaderWrapper::GetShaderCI() {
-	return mShaderCI;
+/*
+
+	The specialization info is only referenced, it has to outlive the pipeline creation. nullptr leaves
+	every constant at the default the shader declares.
+
+*/
+VkPipelineShaderStageCreateInfo ShaderWrapper::GetShaderCI(const VkSpecializationInfo* specializationInfo) {
+	VkPipelineShaderStageCreateInfo shaderCI = mShaderCI;
+	shaderCI.pSpecializationInfo = specializationInfo;
+	return shaderCI;
+}
+
+ShaderReflection* ShaderWrapper::GetReflection() {
+	return mReflection;
 }
 
 void ShaderWrapper::CreateShaderModule(std::string filename) {
@@ -69,6 +83,9 @@ void ShaderWrapper::CreateShaderModule(std::string filename) {
 		throw std::runtime_error("Failed to create Shader Module! Invalid file extension.");
 	}
 
+	// Reflect before creating the module, a module that doesn't parse never makes it to the driver
+	mReflection = new ShaderReflection(mShaderCode);
+
 	VkShaderModuleCreateInfo shaderModuleCI = {
 		.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
 		.pNext = nullptr,
@@ -81,6 +98,7 @@ void ShaderWrapper::CreateShaderModule(std::string filename) {
 	if (result == VK_SUCCESS) {
 		std::cout << "Success: Shader module created." << std::endl;
 	} else {
+		delete mReflection;
 		throw std::runtime_error("Failed to create Shader Module! Error Code: " + NT_CHECK_RESULT(result));
 	}
 }
@@ -6,6 +6,7 @@
 #include <vector>
 
 class LogicalDeviceWrapper;
+class ShaderReflection;
 
 /*
 
@@ -16,6 +17,8 @@ class LogicalDeviceWrapper;
 		- I just noticed that I have the shaderc library in my project.
 		Already have an implementation of my own so for now leave it alone.
 		But worth taking a look at in the future.
+		- Every module is reflected when it's loaded, GetReflection() tells what descriptors, push
+		constants and vertex inputs it expects.
 
 	Assumptions:
 		- All files it reads end in .spv
@@ -31,7 +34,8 @@ public:
 	~ShaderWrapper();
 
 	VkShaderModule GetShaderModule();
-	VkPipelineShaderStageCreateInfo GetShaderCI();
+	VkPipelineShaderStageCreateInfo GetShaderCI(const VkSpecializationInfo*);
+	ShaderReflection* GetReflection();
 private:
 	void CreateShaderModule(std::string);
 	void CreateShaderCI();
@@ -40,6 +44,7 @@ private:
 	VkShaderStageFlagBits mShaderStage;
 	VkPipelineShaderStageCreateInfo mShaderCI;
 	std::vector<char> mShaderCode;
+	ShaderReflection* mReflection;
 
 	LogicalDeviceWrapper* mLogicalDevice;
 };
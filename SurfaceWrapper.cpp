@@ -63,4 +63,15 @@ void SurfaceWrapper::AcquireSurfaceProperties(VkPhysicalDevice pDevice) {
 
 	mBestSurfaceFormat = ChooseBestSurfaceFormat();
 	mBestPresentMode = ChooseBestPresentMode();
+}
+
+/*
+
+	Size of the window's framebuffer in pixels. Used when the surface leaves the swapchain extent up to us.
+
+*/
+VkExtent2D SurfaceWrapper::GetFramebufferExtent() {
+	int width = 0, height = 0;
+	glfwGetFramebufferSize(mWindow->GetWindow(), &width, &height);
+	return { (uint32_t)width, (uint32_t)height };
 }
\ No newline at end of file
@@ -25,6 +25,7 @@ public:
 	const VkSurfaceCapabilitiesKHR& GetSurfaceCapabilities();
 	const VkSurfaceFormatKHR& GetBestSurfaceFormat();
 	const VkPresentModeKHR& GetBestPresentMode();
+	VkExtent2D GetFramebufferExtent();
 private:
 	void CreateSurface();
 
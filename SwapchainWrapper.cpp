@@ -1,18 +1,17 @@
 #include "SwapchainWrapper.h"
 #include "globals.h"
+#include <algorithm>
 #include "SurfaceWrapper.h"
 #include "PhysicalDeviceWrapper.h"
 #include "LogicalDeviceWrapper.h"
 #include "ImageViewWrapper.h"
 
 SwapchainWrapper::SwapchainWrapper(PhysicalDeviceWrapper* pDevice, LogicalDeviceWrapper* lDevice, SurfaceWrapper* surface) : mPhysicalDevice(pDevice), mLogicalDevice(lDevice), mSurface(surface) {
-	CreateSwapchain();
+	CreateSwapchain(VK_NULL_HANDLE);
 }
 
 SwapchainWrapper::~SwapchainWrapper() {
-	for (size_t i = 0; i < mSwapchainImages.size(); i++) {
-		delete mSwapchainImages.at(i).mImageView;
-	}
+	DestroyImageViews();
 	vkDestroySwapchainKHR(mLogicalDevice->GetLogicalDevice(), mSwapchain, nullptr); std:: cout << "Success: Swapchain destroyed." << std::endl;
 }
 
@@ -28,23 +27,38 @@ std::vector<SwapchainImage> SwapchainWrapper::GetSwapchainImages() {
 	return mSwapchainImages;
 }
 
-void SwapchainWrapper::CreateSwapchain() {
+void SwapchainWrapper::Recreate() {
+	VkSwapchainKHR oldSwapchain = mSwapchain;
+
+	DestroyImageViews();
+	CreateSwapchain(oldSwapchain);
+
+	vkDestroySwapchainKHR(mLogicalDevice->GetLogicalDevice(), oldSwapchain, nullptr); std::cout << "Success: Old Swapchain destroyed." << std::endl;
+}
+
+void SwapchainWrapper::CreateSwapchain(VkSwapchainKHR oldSwapchain) {
 	// Ask Surface to Provide Swapchain Details
 	mSurface->AcquireSurfaceProperties(mPhysicalDevice->GetPhysicalDevice());
 
+	// maxImageCount of 0 means there is no upper limit
+	const VkSurfaceCapabilitiesKHR& capabilities = mSurface->GetSurfaceCapabilities();
+	uint32_t imageCount = std::max(SWAPCHAIN_IMAGE_COUNT, capabilities.minImageCount);
+	if (capabilities.maxImageCount > 0) {
+		imageCount = std::min(imageCount, capabilities.maxImageCount);
+	}
+
+	mSwapchainExtent = ChooseSwapchainExtent();
+
 	// Describe the swapchain
 	VkSwapchainCreateInfoKHR swapchainCI = {
 		.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
 		.pNext = nullptr,
 		.flags = 0,
 		.surface = mSurface->GetSurface(),
-		.minImageCount = 3,
+		.minImageCount = imageCount,
 		.imageFormat = mSurface->GetBestSurfaceFormat().format,
 		.imageColorSpace = mSurface->GetBestSurfaceFormat().colorSpace,
-		.imageExtent = { 
-			.width = WINDOW_WIDTH, 
-			.height = WINDOW_HEIGHT 
-		},
+		.imageExtent = mSwapchainExtent,
 		.imageArrayLayers = 1,
 		.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
 		.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
@@ -54,7 +68,7 @@ void SwapchainWrapper::CreateSwapchain() {
 		.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
 		.presentMode = mSurface->GetBestPresentMode(),
 		.clipped = VK_TRUE,
-		.oldSwapchain = VK_NULL_HANDLE
+		.oldSwapchain = oldSwapchain
 	};
 
 	// Check if the queue families are the same
@@ -78,12 +92,6 @@ void SwapchainWrapper::CreateSwapchain() {
 		throw std::runtime_error("Failed to create swapchain! Error Code: " + NT_CHECK_RESULT(result));
 	}
 
-	// Establish the Swapchain Extent
-	mSwapchainExtent = {
-		.width = (uint32_t)WINDOW_WIDTH,
-		.height = (uint32_t)WINDOW_HEIGHT
-	};
-
 	// Grab the Swapchain Images
 	uint32_t swapchainImagesCount = 0;
 	vkGetSwapchainImagesKHR(mLogicalDevice->GetLogicalDevice(), mSwapchain, &swapchainImagesCount, nullptr);
@@ -95,3 +103,28 @@ void SwapchainWrapper::CreateSwapchain() {
 		mSwapchainImages.push_back({swapchainImages.at(i), new ImageViewWrapper(mLogicalDevice, swapchainImages.at(i), mSurface->GetBestSurfaceFormat().format, VK_IMAGE_ASPECT_COLOR_BIT) });
 	}
 }
+
+void SwapchainWrapper::DestroyImageViews() {
+	for (size_t i = 0; i < mSwapchainImages.size(); i++) {
+		delete mSwapchainImages.at(i).mImageView;
+	}
+	mSwapchainImages.clear();
+}
+
+/*
+
+	The surface usually dictates the extent. If it doesn't (currentExtent is 0xFFFFFFFF) we take the
+	window's framebuffer size, clamped to what the surface supports.
+
+*/
+VkExtent2D SwapchainWrapper::ChooseSwapchainExtent() {
+	const VkSurfaceCapabilitiesKHR& capabilities = mSurface->GetSurfaceCapabilities();
+	if (capabilities.currentExtent.width != UINT32_MAX) {
+		return capabilities.currentExtent;
+	}
+
+	VkExtent2D extent = mSurface->GetFramebufferExtent();
+	extent.width = std::clamp(extent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
+	extent.height = std::clamp(extent.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
+	return extent;
+}
@@ -12,7 +12,11 @@ class ImageViewWrapper;
 
 /*
 
-	
+	Notes:
+		- Recreate() builds a new swapchain for the current surface extent, passing the old one as
+		  oldSwapchain so the presentation engine can hand over its images, and then destroys the old
+		  one. The caller has to make sure the GPU is done with the old images and has to rebuild
+		  everything sized to the swapchain (framebuffers, depth image).
 
 */
 
@@ -29,8 +33,13 @@ public:
 	VkSwapchainKHR GetSwapchain();
 	VkExtent2D GetSwapchainExtent();
 	std::vector<SwapchainImage> GetSwapchainImages();
+
+	void Recreate();
 private:
-	void CreateSwapchain();
+	void CreateSwapchain(VkSwapchainKHR);
+	void DestroyImageViews();
+
+	VkExtent2D ChooseSwapchainExtent();
 
 	VkSwapchainKHR mSwapchain;
 	std::vector<SwapchainImage> mSwapchainImages;
@@ -29,6 +29,86 @@ void SemaphoreWrapper::CreateSemaphore() {
 	}
 }
 
+TimelineSemaphoreWrapper::TimelineSemaphoreWrapper(LogicalDeviceWrapper* lDevice, uint64_t initialValue) : mPendingValue(initialValue), mLogicalDevice(lDevice) {
+	CreateTimelineSemaphore(initialValue);
+}
+
+TimelineSemaphoreWrapper::~TimelineSemaphoreWrapper() {
+	vkDestroySemaphore(mLogicalDevice->GetLogicalDevice(), mSemaphore, nullptr); std::cout << "Success: Timeline Semaphore destroyed." << std::endl;
+}
+
+VkSemaphore TimelineSemaphoreWrapper::GetSemaphore() {
+	return mSemaphore;
+}
+
+/*
+
+	Hands out the value the next submission on this timeline has to signal. Values must be signalled in
+	submission order, so only call this right before the submission that will use it.
+
+*/
+uint64_t TimelineSemaphoreWrapper::NextValue() {
+	return ++mPendingValue;
+}
+
+uint64_t TimelineSemaphoreWrapper::GetPendingValue() {
+	return mPendingValue;
+}
+
+uint64_t TimelineSemaphoreWrapper::GetCompletedValue() {
+	uint64_t value;
+	VkResult result = vkGetSemaphoreCounterValue(mLogicalDevice->GetLogicalDevice(), mSemaphore, &value);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to read timeline semaphore value! Error Code: " + NT_CHECK_RESULT(result));
+	}
+	return value;
+}
+
+bool TimelineSemaphoreWrapper::IsComplete(uint64_t value) {
+	return value <= GetCompletedValue();
+}
+
+void TimelineSemaphoreWrapper::Wait(uint64_t value) {
+	if (value > mPendingValue) {
+		throw std::runtime_error("Attempted to wait on a timeline value that was never submitted!");
+	}
+
+	VkSemaphoreWaitInfo waitInfo = {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+		.pNext = nullptr,
+		.flags = 0,
+		.semaphoreCount = 1,
+		.pSemaphores = &mSemaphore,
+		.pValues = &value
+	};
+
+	VkResult result = vkWaitSemaphores(mLogicalDevice->GetLogicalDevice(), &waitInfo, UINT64_MAX);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to wait on timeline semaphore! Error Code: " + NT_CHECK_RESULT(result));
+	}
+}
+
+void TimelineSemaphoreWrapper::CreateTimelineSemaphore(uint64_t initialValue) {
+	VkSemaphoreTypeCreateInfo semaphoreTypeCI = {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+		.pNext = nullptr,
+		.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+		.initialValue = initialValue
+	};
+	VkSemaphoreCreateInfo semaphoreCI = {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+		.pNext = &semaphoreTypeCI,
+		.flags = 0
+	};
+
+	VkResult result = vkCreateSemaphore(mLogicalDevice->GetLogicalDevice(), &semaphoreCI, nullptr, &mSemaphore);
+	if (result == VK_SUCCESS) {
+		std::cout << "Success: Timeline Semaphore created." << std::endl;
+	} else {
+		throw std::runtime_error("Failed to create a timeline semaphore! Error Code: " + NT_CHECK_RESULT(result));
+	}
+}
+
 FenceWrapper::FenceWrapper(LogicalDeviceWrapper* lDevice, VkFenceCreateFlags flags) : mLogicalDevice(lDevice) {
 	CreateFence(flags);
 }
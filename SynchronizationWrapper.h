@@ -7,7 +7,12 @@ class LogicalDeviceWrapper;
 
 /*
 
-	
+	Notes:
+		- Binary semaphores are only used where the swapchain requires them (acquire and present).
+		- A TimelineSemaphoreWrapper holds one monotonically increasing value. Whoever submits work asks
+		  for NextValue() and signals it from that submission, everybody else can wait on (or poll)
+		  that exact point from the CPU or from another submission. The LogicalDeviceWrapper owns one
+		  per queue.
 
 */
 
@@ -25,6 +30,29 @@ private:
 	LogicalDeviceWrapper* mLogicalDevice;
 };
 
+class TimelineSemaphoreWrapper {
+public:
+	TimelineSemaphoreWrapper(LogicalDeviceWrapper*, uint64_t);
+	~TimelineSemaphoreWrapper();
+
+	VkSemaphore GetSemaphore();
+
+	uint64_t NextValue();
+	uint64_t GetPendingValue();
+	uint64_t GetCompletedValue();
+
+	bool IsComplete(uint64_t);
+	void Wait(uint64_t);
+private:
+	void CreateTimelineSemaphore(uint64_t);
+
+	VkSemaphore mSemaphore;
+
+	uint64_t mPendingValue;							// Highest value handed out by NextValue()
+
+	LogicalDeviceWrapper* mLogicalDevice;
+};
+
 class FenceWrapper {
 public:
 	FenceWrapper(LogicalDeviceWrapper*, VkFenceCreateFlags);
@@ -0,0 +1,83 @@
+#include "ThreadPool.h"
+#include "globals.h"
+
+ThreadPool::ThreadPool(uint32_t threadCount) : mUnfinishedTasks(0), mException(nullptr), mStopping(false) {
+	if (threadCount == 0) {
+		threadCount = 1;
+	}
+
+	for (uint32_t i = 0; i < threadCount; i++) {
+		mThreads.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+	}
+	std::cout << "Success: Thread Pool created. (" << threadCount << " threads)" << std::endl;
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+	mTaskAvailable.notify_all();
+
+	for (size_t i = 0; i < mThreads.size(); i++) {
+		mThreads.at(i).join();
+	}
+	std::cout << "Success: Thread Pool destroyed." << std::endl;
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mTasks.push(task);
+		mUnfinishedTasks++;
+	}
+	mTaskAvailable.notify_one();
+}
+
+void ThreadPool::Wait() {
+	std::unique_lock<std::mutex> lock(mMutex);
+	mTasksFinished.wait(lock, [this] { return mUnfinishedTasks == 0; });
+
+	if (mException != nullptr) {
+		std::exception_ptr exception = mException;
+		mException = nullptr;
+		std::rethrow_exception(exception);
+	}
+}
+
+uint32_t ThreadPool::GetThreadCount() {
+	return (uint32_t)mThreads.size();
+}
+
+void ThreadPool::WorkerLoop() {
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mTaskAvailable.wait(lock, [this] { return mStopping || !mTasks.empty(); });
+
+			if (mStopping && mTasks.empty()) {
+				return;
+			}
+
+			task = mTasks.front();
+			mTasks.pop();
+		}
+
+		std::exception_ptr exception = nullptr;
+		try {
+			task();
+		} catch (...) {
+			exception = std::current_exception();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (exception != nullptr && mException == nullptr) {
+				mException = exception;
+			}
+			mUnfinishedTasks--;
+		}
+		mTasksFinished.notify_all();
+	}
+}
@@ -0,0 +1,47 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+/*
+
+	Fixed size pool of worker threads pulling tasks off a shared queue.
+
+	Notes:
+		- Wait() blocks until every submitted task has finished. If a task threw, the first exception
+		  is rethrown from Wait() on the calling thread so errors don't silently die on a worker.
+		- The pool knows nothing about Vulkan. Anything a task touches that needs external
+		  synchronization (command pools!) has to be owned by that task.
+
+*/
+
+class ThreadPool {
+public:
+	ThreadPool(uint32_t);
+	~ThreadPool();
+
+	void Submit(std::function<void()>);
+	void Wait();
+
+	uint32_t GetThreadCount();
+private:
+	void WorkerLoop();
+
+	std::vector<std::thread> mThreads;
+	std::queue<std::function<void()>> mTasks;
+
+	std::mutex mMutex;
+	std::condition_variable mTaskAvailable;
+	std::condition_variable mTasksFinished;
+
+	uint32_t mUnfinishedTasks;
+	std::exception_ptr mException;
+	bool mStopping;
+};
+#endif
@@ -0,0 +1,64 @@
+#include "UniformRingBuffer.h"
+#include "globals.h"
+#include "PhysicalDeviceWrapper.h"
+#include "LogicalDeviceWrapper.h"
+#include "BufferWrapper.h"
+
+UniformRingBuffer::UniformRingBuffer(PhysicalDeviceWrapper* pDevice, LogicalDeviceWrapper* lDevice, VkDeviceSize frameSize, uint32_t frameCount) : mPhysicalDevice(pDevice), mLogicalDevice(lDevice) {
+	mAlignment = mPhysicalDevice->GetPhysicalDeviceProperties().limits.minUniformBufferOffsetAlignment;
+	mFrameSize = AlignSize(frameSize);
+	mFrameCount = frameCount;
+	mFrameStart = 0;
+	mHead = 0;
+
+	// Host visible is a must since we write straight into it, device local (ReBAR / UMA) is a bonus
+	mBuffer = new BufferWrapper(mPhysicalDevice, mLogicalDevice, mFrameSize * mFrameCount, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, { VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0 });
+	if (mBuffer->GetMappedData() == nullptr) {
+		throw std::runtime_error("Uniform Ring Buffer memory is not mapped!");
+	}
+	std::cout << "Success: Uniform Ring Buffer created. (" << mFrameCount << " x " << mFrameSize << " bytes)" << std::endl;
+}
+
+UniformRingBuffer::~UniformRingBuffer() {
+	delete mBuffer; std::cout << "Success: Uniform Ring Buffer destroyed." << std::endl;
+}
+
+void UniformRingBuffer::BeginFrame(uint32_t frame) {
+	if (frame >= mFrameCount) {
+		throw std::runtime_error("Attempted to begin a Uniform Ring Buffer frame out of range!");
+	}
+	mFrameStart = mFrameSize * frame;
+	mHead = mFrameStart;
+}
+
+UniformAllocation UniformRingBuffer::Allocate(VkDeviceSize size) {
+	VkDeviceSize alignedSize = AlignSize(size);
+	if (mHead + alignedSize > mFrameStart + mFrameSize) {
+		throw std::runtime_error("Uniform Ring Buffer frame region is full!");
+	}
+
+	UniformAllocation allocation = {
+		.mBuffer = mBuffer->GetBuffer(),
+		.mOffset = mHead,
+		.mData = (char*)mBuffer->GetMappedData() + mHead
+	};
+	mHead += alignedSize;
+
+	return allocation;
+}
+
+VkDeviceSize UniformRingBuffer::AlignSize(VkDeviceSize size) {
+	return (size + mAlignment - 1) & ~(mAlignment - 1);
+}
+
+BufferWrapper* UniformRingBuffer::GetBuffer() {
+	return mBuffer;
+}
+
+VkDeviceSize UniformRingBuffer::GetFrameSize() {
+	return mFrameSize;
+}
+
+uint32_t UniformRingBuffer::GetFrameCount() {
+	return mFrameCount;
+}
@@ -0,0 +1,59 @@
+#ifndef UNIFORM_RING_BUFFER_H
+#define UNIFORM_RING_BUFFER_H
+
+#include <vulkan/vulkan.h>
+
+class PhysicalDeviceWrapper;
+class LogicalDeviceWrapper;
+class BufferWrapper;
+
+/*
+
+	UniformRingBuffer is one persistently mapped uniform buffer split into a region per frame. At the
+	start of a frame BeginFrame() rewinds the head to the start of that frame's region and Allocate()
+	bumps it forward, handing back the buffer, the offset to bind at and a pointer to write through.
+	Nothing is ever mapped, unmapped or copied through a staging array.
+
+	Notes:
+		- Every allocation is aligned to minUniformBufferOffsetAlignment so the offset can be used
+		  directly as a dynamic offset.
+		- A region must not be rewritten while the GPU can still read it. The caller has to make sure
+		  the frame that last used the region has finished before calling BeginFrame() on it.
+		- Allocation order within a frame is deterministic, so the same sequence of Allocate() calls
+		  always produces the same offsets. The Renderer relies on that for its pre-recorded command buffers.
+
+*/
+
+struct UniformAllocation {
+	VkBuffer mBuffer;
+	VkDeviceSize mOffset;
+	void* mData;
+};
+
+class UniformRingBuffer {
+public:
+	UniformRingBuffer(PhysicalDeviceWrapper*, LogicalDeviceWrapper*, VkDeviceSize, uint32_t);
+	~UniformRingBuffer();
+
+	void BeginFrame(uint32_t);
+	UniformAllocation Allocate(VkDeviceSize);
+
+	VkDeviceSize AlignSize(VkDeviceSize);
+
+	BufferWrapper* GetBuffer();
+	VkDeviceSize GetFrameSize();
+	uint32_t GetFrameCount();
+private:
+	BufferWrapper* mBuffer;
+
+	VkDeviceSize mAlignment;
+	VkDeviceSize mFrameSize;
+	uint32_t mFrameCount;
+
+	VkDeviceSize mFrameStart;
+	VkDeviceSize mHead;
+
+	PhysicalDeviceWrapper* mPhysicalDevice;
+	LogicalDeviceWrapper* mLogicalDevice;
+};
+#endif
@@ -0,0 +1,264 @@
+#include "UploadContext.h"
+#include "globals.h"
+#include <algorithm>
+#include "PhysicalDeviceWrapper.h"
+#include "LogicalDeviceWrapper.h"
+#include "CommandPoolWrapper.h"
+#include "CommandBufferWrapper.h"
+#include "SynchronizationWrapper.h"
+#include "BufferWrapper.h"
+#include "ImageWrapper.h"
+
+UploadContext::UploadContext(PhysicalDeviceWrapper* pDevice, LogicalDeviceWrapper* lDevice) : mRecordingBatch(nullptr), mLastTicket(0), mPhysicalDevice(pDevice), mLogicalDevice(lDevice) {
+	mCommandPool = new CommandPoolWrapper(mLogicalDevice, mPhysicalDevice->GetQueueFamilyIndices().mGraphics);
+	std::cout << "Success: Upload Context created." << std::endl;
+}
+
+UploadContext::~UploadContext() {
+	// Send off anything still recording and wait for every batch, so all staging memory is free to go
+	Flush();
+
+	for (size_t i = 0; i < mFreeBatches.size(); i++) {
+		delete mFreeBatches.at(i)->mCommandBuffer;
+		delete mFreeBatches.at(i);
+	}
+	for (size_t i = 0; i < mFreeStagingChunks.size(); i++) {
+		delete mFreeStagingChunks.at(i)->mBuffer;
+		delete mFreeStagingChunks.at(i);
+	}
+	delete mCommandPool;
+	std::cout << "Success: Upload Context destroyed." << std::endl;
+}
+
+void UploadContext::UploadBuffer(BufferWrapper* dstBuffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset) {
+	StagingRegion staging = AllocateStaging(size, 16);
+	memcpy(staging.mData, data, (size_t)size);
+
+	VkBufferCopy bufferCopy = {
+		.srcOffset = staging.mOffset,
+		.dstOffset = dstOffset,
+		.size = size
+	};
+
+	vkCmdCopyBuffer(GetCommandBuffer(), staging.mBuffer, dstBuffer->GetBuffer(), 1, &bufferCopy);
+
+	mRecordingBatch->mCopyCount++;
+	mRecordingBatch->mByteCount += size;
+}
+
+/*
+
+	Copies tightly packed pixel data into the first mip level of the image, blits the rest of the mip
+	chain from it and leaves the whole image in SHADER_READ_ONLY_OPTIMAL. All of it is recorded into
+	the current batch.
+
+*/
+void UploadContext::UploadImage(ImageWrapper* dstImage, const void* data, VkDeviceSize size, uint32_t width, uint32_t height) {
+	StagingRegion staging = AllocateStaging(size, 16);
+	memcpy(staging.mData, data, (size_t)size);
+
+	VkCommandBuffer commandBuffer = GetCommandBuffer();
+	RecordTransitionImageLayout(commandBuffer, dstImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, dstImage->GetMipLevels());
+	RecordCopyBufferToImage(commandBuffer, staging.mBuffer, staging.mOffset, dstImage, width, height);
+	RecordGenerateMipmaps(commandBuffer, dstImage);
+
+	mRecordingBatch->mCopyCount++;
+	mRecordingBatch->mByteCount += size;
+}
+
+/*
+
+	Returns the command buffer of the batch being recorded, starting a new batch if there is none. Can be
+	used to record extra commands that have to execute together with the uploads.
+
+*/
+VkCommandBuffer UploadContext::GetCommandBuffer() {
+	if (mRecordingBatch == nullptr) {
+		BeginBatch();
+	}
+	return mRecordingBatch->mCommandBuffer->GetCommandBuffer();
+}
+
+/*
+
+	Submits the batch being recorded and returns its ticket. If nothing was recorded the ticket of the
+	last submitted batch is returned instead (0 if nothing was ever submitted, which is always complete).
+	Other graphics submissions (frames) advance the same timeline in between, so tickets aren't consecutive.
+
+*/
+UploadTicket UploadContext::Submit() {
+	if (mRecordingBatch == nullptr) {
+		return mLastTicket;
+	}
+
+	VkCommandBuffer commandBuffer = mRecordingBatch->mCommandBuffer->GetCommandBuffer();
+
+	// Make the transfer writes visible to everything submitted to the queue after this batch
+	VkMemoryBarrier memoryBarrier = {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		.pNext = nullptr,
+		.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+		.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT
+	};
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+	VkResult result = vkEndCommandBuffer(commandBuffer);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to end recording upload command buffer! Error Code: " + NT_CHECK_RESULT(result));
+	}
+
+	TimelineSemaphoreWrapper* timeline = mLogicalDevice->GetGraphicsTimeline();
+	VkSemaphore timelineSemaphore = timeline->GetSemaphore();
+	uint64_t ticket = timeline->NextValue();
+
+	VkTimelineSemaphoreSubmitInfo timelineSI = {
+		.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+		.pNext = nullptr,
+		.waitSemaphoreValueCount = 0,
+		.pWaitSemaphoreValues = nullptr,
+		.signalSemaphoreValueCount = 1,
+		.pSignalSemaphoreValues = &ticket
+	};
+	VkSubmitInfo submitInfo = {
+		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.pNext = &timelineSI,
+		.waitSemaphoreCount = 0,
+		.pWaitSemaphores = nullptr,
+		.pWaitDstStageMask = nullptr,
+		.commandBufferCount = 1,
+		.pCommandBuffers = &commandBuffer,
+		.signalSemaphoreCount = 1,
+		.pSignalSemaphores = &timelineSemaphore
+	};
+
+	result = vkQueueSubmit(mLogicalDevice->GetGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to submit upload batch to queue! Error Code: " + NT_CHECK_RESULT(result));
+	}
+
+	mRecordingBatch->mTicket = ticket;
+	mLastTicket = ticket;
+	std::cout << "Success: Upload batch " << mRecordingBatch->mTicket << " submitted. (" << mRecordingBatch->mCopyCount << " copies, " << mRecordingBatch->mByteCount << " bytes)" << std::endl;
+
+	mInFlightBatches.push_back(mRecordingBatch);
+	mRecordingBatch = nullptr;
+
+	return mInFlightBatches.back()->mTicket;
+}
+
+bool UploadContext::IsComplete(UploadTicket ticket) {
+	RetireBatches();
+	return mLogicalDevice->GetGraphicsTimeline()->IsComplete(ticket);
+}
+
+void UploadContext::Wait(UploadTicket ticket) {
+	if (ticket > mLastTicket) {
+		throw std::runtime_error("Attempted to wait on an upload ticket that was never submitted!");
+	}
+
+	mLogicalDevice->GetGraphicsTimeline()->Wait(ticket);
+
+	RetireBatches();
+}
+
+void UploadContext::Flush() {
+	Wait(Submit());
+}
+
+void UploadContext::BeginBatch() {
+	RetireBatches();
+
+	if (mFreeBatches.empty()) {
+		UploadBatch* batch = new UploadBatch();
+		batch->mCommandBuffer = new CommandBufferWrapper(mLogicalDevice, mCommandPool);
+		mFreeBatches.push_back(batch);
+	}
+
+	mRecordingBatch = mFreeBatches.back();
+	mFreeBatches.pop_back();
+
+	mRecordingBatch->mTicket = 0;
+	mRecordingBatch->mCopyCount = 0;
+	mRecordingBatch->mByteCount = 0;
+
+	// The pool was created with RESET_COMMAND_BUFFER_BIT, so beginning implicitly resets the command buffer
+	VkCommandBufferBeginInfo commandBufferBI = {
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.pNext = nullptr,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+		.pInheritanceInfo = nullptr
+	};
+
+	VkResult result = vkBeginCommandBuffer(mRecordingBatch->mCommandBuffer->GetCommandBuffer(), &commandBufferBI);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to begin recording upload command buffer! Error Code: " + NT_CHECK_RESULT(result));
+	}
+}
+
+/*
+
+	Moves every batch whose ticket has been reached back to the free list and recycles its staging chunks.
+
+*/
+void UploadContext::RetireBatches() {
+	uint64_t completed = mLogicalDevice->GetGraphicsTimeline()->GetCompletedValue();
+
+	for (size_t i = 0; i < mInFlightBatches.size(); ) {
+		UploadBatch* batch = mInFlightBatches.at(i);
+
+		if (batch->mTicket > completed) {
+			i++;
+			continue;
+		}
+
+		for (size_t j = 0; j < batch->mStagingChunks.size(); j++) {
+			StagingChunk* chunk = batch->mStagingChunks.at(j);
+			if (chunk->mSize > STAGING_CHUNK_SIZE) {
+				delete chunk->mBuffer;
+				delete chunk;
+			} else {
+				chunk->mHead = 0;
+				mFreeStagingChunks.push_back(chunk);
+			}
+		}
+		batch->mStagingChunks.clear();
+
+		mFreeBatches.push_back(batch);
+		mInFlightBatches.erase(mInFlightBatches.begin() + i);
+	}
+}
+
+StagingRegion UploadContext::AllocateStaging(VkDeviceSize size, VkDeviceSize alignment) {
+	if (mRecordingBatch == nullptr) {
+		BeginBatch();
+	}
+
+	std::vector<StagingChunk*>& chunks = mRecordingBatch->mStagingChunks;
+
+	StagingChunk* chunk = chunks.empty() ? nullptr : chunks.back();
+	VkDeviceSize offset = chunk == nullptr ? 0 : (chunk->mHead + alignment - 1) / alignment * alignment;
+
+	if (chunk == nullptr || offset + size > chunk->mSize) {
+		if (size <= STAGING_CHUNK_SIZE && !mFreeStagingChunks.empty()) {
+			chunk = mFreeStagingChunks.back();
+			mFreeStagingChunks.pop_back();
+		} else {
+			chunk = new StagingChunk();
+			chunk->mSize = std::max(STAGING_CHUNK_SIZE, size);
+			chunk->mHead = 0;
+			chunk->mBuffer = new BufferWrapper(mPhysicalDevice, mLogicalDevice, chunk->mSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		}
+		chunks.push_back(chunk);
+		offset = 0;
+	}
+
+	chunk->mHead = offset + size;
+
+	StagingRegion region = {
+		.mBuffer = chunk->mBuffer->GetBuffer(),
+		.mOffset = offset,
+		.mData = (char*)chunk->mBuffer->GetMappedData() + offset
+	};
+
+	return region;
+}
@@ -0,0 +1,86 @@
+#ifndef UPLOAD_CONTEXT_H
+#define UPLOAD_CONTEXT_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+
+class PhysicalDeviceWrapper;
+class LogicalDeviceWrapper;
+class CommandPoolWrapper;
+class CommandBufferWrapper;
+class BufferWrapper;
+class ImageWrapper;
+
+/*
+
+	UploadContext batches uploads. Every UploadBuffer() / UploadImage() call copies its data into
+	staging memory and records the copy into the current batch's command buffer. Nothing is sent to the
+	GPU until Submit(), which hands back a ticket that can be polled with IsComplete() or waited on with Wait().
+	A ticket is the graphics timeline value the batch signals, so other submissions can wait on it too.
+
+	Notes:
+		- Batches go to the graphics queue. Images need layout transitions (and blits later on), and
+		  staying on one queue family means no ownership transfers for our EXCLUSIVE resources.
+		- Every batch ends with a memory barrier, so anything submitted to the graphics queue after the
+		  batch sees the uploaded data. The renderer doesn't have to wait on the CPU before drawing.
+		- Staging memory comes from STAGING_CHUNK_SIZE chunks that are bump allocated. A batch keeps
+		  its chunks until its timeline value is reached, then they go back on the free list. Uploads bigger than
+		  a chunk get a chunk of their own which is destroyed once the batch retires.
+		- Command buffers are recycled the same way.
+
+*/
+
+typedef uint64_t UploadTicket;
+
+struct StagingChunk {
+	BufferWrapper* mBuffer;
+	VkDeviceSize mSize;
+	VkDeviceSize mHead;
+};
+
+struct StagingRegion {
+	VkBuffer mBuffer;
+	VkDeviceSize mOffset;
+	void* mData;
+};
+
+struct UploadBatch {
+	UploadTicket mTicket;
+	CommandBufferWrapper* mCommandBuffer;
+	std::vector<StagingChunk*> mStagingChunks;
+	uint32_t mCopyCount;
+	VkDeviceSize mByteCount;
+};
+
+class UploadContext {
+public:
+	UploadContext(PhysicalDeviceWrapper*, LogicalDeviceWrapper*);
+	~UploadContext();
+
+	void UploadBuffer(BufferWrapper*, const void*, VkDeviceSize, VkDeviceSize);
+	void UploadImage(ImageWrapper*, const void*, VkDeviceSize, uint32_t, uint32_t);
+
+	VkCommandBuffer GetCommandBuffer();
+
+	UploadTicket Submit();
+	bool IsComplete(UploadTicket);
+	void Wait(UploadTicket);
+	void Flush();
+private:
+	void BeginBatch();
+	void RetireBatches();
+	StagingRegion AllocateStaging(VkDeviceSize, VkDeviceSize);
+
+	CommandPoolWrapper* mCommandPool;
+
+	UploadBatch* mRecordingBatch;
+	std::vector<UploadBatch*> mInFlightBatches;
+	std::vector<UploadBatch*> mFreeBatches;
+	std::vector<StagingChunk*> mFreeStagingChunks;
+
+	UploadTicket mLastTicket;
+
+	PhysicalDeviceWrapper* mPhysicalDevice;
+	LogicalDeviceWrapper* mLogicalDevice;
+};
+#endif
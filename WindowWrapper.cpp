@@ -1,6 +1,5 @@
 #include "WindowWrapper.h"
 #include "globals.h"
-#include <Windows.h>
 
 WindowWrapper::WindowWrapper() {
 	if (glfwInit()) {
@@ -10,7 +9,7 @@ WindowWrapper::WindowWrapper() {
 	}
 
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-	glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+	glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
 
 	mWindow = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, APPLICATION_TITLE.c_str(), nullptr, nullptr);
 
@@ -20,14 +19,18 @@ WindowWrapper::WindowWrapper() {
 		throw std::runtime_error("Failed to create a GLFW Window!");
 	}
 
-	RECT desktopRect;
-	const HWND hDesktop = GetDesktopWindow();
-	GetWindowRect(hDesktop, &desktopRect);
+	// Center on the primary monitor
+	const GLFWvidmode* videoMode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+	if (videoMode != nullptr) {
+		int middleX = videoMode->width / 2 - WINDOW_WIDTH / 2;
+		int middleY = videoMode->height / 2 - WINDOW_HEIGHT / 2;
 
-	int middleX = desktopRect.right / 2 - WINDOW_WIDTH / 2;
-	int middleY = desktopRect.bottom / 2 - WINDOW_HEIGHT / 2;
+		glfwSetWindowPos(mWindow, middleX, middleY);
+	}
 
-	glfwSetWindowPos(mWindow, middleX, middleY);
+	mFramebufferResized = false;
+	glfwSetWindowUserPointer(mWindow, this);
+	glfwSetFramebufferSizeCallback(mWindow, FramebufferResizeCallback);
 }
 
 WindowWrapper::WindowWrapper(std::vector<std::pair<int, int>>& hints) {
@@ -38,6 +41,10 @@ WindowWrapper::WindowWrapper(std::vector<std::pair<int, int>>& hints) {
 	}
 
 	mWindow = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, APPLICATION_TITLE.c_str(), nullptr, nullptr);
+
+	mFramebufferResized = false;
+	glfwSetWindowUserPointer(mWindow, this);
+	glfwSetFramebufferSizeCallback(mWindow, FramebufferResizeCallback);
 }
 
 WindowWrapper::~WindowWrapper() {
@@ -47,4 +54,23 @@ WindowWrapper::~WindowWrapper() {
 
 GLFWwindow* WindowWrapper::GetWindow() {
 	return mWindow;
+}
+
+bool WindowWrapper::GetFramebufferResized() {
+	return mFramebufferResized;
+}
+
+void WindowWrapper::SetFramebufferResized(bool resized) {
+	mFramebufferResized = resized;
+}
+
+bool WindowWrapper::IsMinimized() {
+	int width = 0, height = 0;
+	glfwGetFramebufferSize(mWindow, &width, &height);
+	return width == 0 || height == 0;
+}
+
+void WindowWrapper::FramebufferResizeCallback(GLFWwindow* window, int width, int height) {
+	WindowWrapper* wrapper = (WindowWrapper*)glfwGetWindowUserPointer(window);
+	wrapper->SetFramebufferResized(true);
 }
\ No newline at end of file
@@ -8,7 +8,9 @@
 
 /*
 
-	
+	Notes:
+		- The window is resizable. A framebuffer size callback raises a flag the Renderer checks
+		  (and clears) to know the swapchain has to be recreated.
 
 */
 
@@ -19,7 +21,14 @@ public:
 	~WindowWrapper();
 
 	GLFWwindow* GetWindow();
+
+	bool GetFramebufferResized();
+	void SetFramebufferResized(bool);
+	bool IsMinimized();
 private:
+	static void FramebufferResizeCallback(GLFWwindow*, int, int);
+
 	GLFWwindow* mWindow;
+	bool mFramebufferResized;
 };
 #endif
\ No newline at end of file
@@ -9,14 +9,24 @@
 
 #ifdef NDEBUG
 const bool ENABLE_VALIDATION_LAYERS = false;
+const bool ENABLE_SHADER_HOT_RELOAD = false;
 #else
 const bool ENABLE_VALIDATION_LAYERS = true;
+const bool ENABLE_SHADER_HOT_RELOAD = true;
 #endif
 
-const uint32_t MAX_CONCURRENT_FRAMES = 3;
-const uint32_t MAX_FRAMES_DRAW = 2;
-const uint32_t SWAPCHAIN_IMAGE_COUNT = 3;
+const uint32_t MAX_FRAMES_IN_FLIGHT = 4;					// Upper bound for Renderer::SetFramesInFlight(), sizes the per-frame pools
+const uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+const uint32_t SWAPCHAIN_IMAGE_COUNT = 3;					// Requested minImageCount, independent of the frames in flight
 const uint32_t MAX_OBJECTS = 20;
+const bool CACHE_UNCHANGED_COMMANDS = true;		// Reuse a frame's secondary command buffers while the scene hasn't changed
+const bool DRAW_PENDING_WITH_FALLBACK = true;		// Draw meshes whose pipeline is still compiling with the default pipeline instead of skipping them
+const uint32_t BINDLESS_TEXTURE_CAPACITY = 4096;			// Descriptors in an unbounded texture array (the bindless table)
+const uint32_t BINDLESS_SAMPLER_CAPACITY = 16;
+const uint32_t DESCRIPTOR_POOL_MAX_SETS = 4096;				// DescriptorAllocator pools double in size up to this
+const uint32_t DYNAMIC_UNIFORM_SET_MASK = 1 << 0;			// Uniform buffers in these descriptor sets are bound with dynamic offsets (UniformRingBuffer)
+const VkDeviceSize MEMORY_BLOCK_SIZE = 64 * 1024 * 1024;
+const VkDeviceSize STAGING_CHUNK_SIZE = 16 * 1024 * 1024;
 
 const std::vector<const char*> ENABLED_VALIDATION_LAYERS = {
 	"VK_LAYER_KHRONOS_validation",
@@ -31,8 +41,14 @@ const std::vector<const char*> ENABLED_PHYSICAL_DEVICE_EXTENSIONS = {
 
 };
 const std::vector<const char*> ENABLED_LOGICAL_DEVICE_EXTENSIONS = { 
+
+};
+const std::vector<const char*> PRESENT_LOGICAL_DEVICE_EXTENSIONS = {		// Only enabled when rendering to a window
 	VK_KHR_SWAPCHAIN_EXTENSION_NAME
 };
+const std::vector<const char*> OPTIONAL_LOGICAL_DEVICE_EXTENSIONS = {		// Enabled when the device has them, nothing depends on them
+	VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME
+};
 const VkPhysicalDeviceFeatures ENABLED_PHYSICAL_DEVICE_FEATURES = {
 	0, // VkBool32    robustBufferAccess;
 	0, // VkBool32    fullDrawIndexUint32;
@@ -68,7 +84,7 @@ const VkPhysicalDeviceFeatures ENABLED_PHYSICAL_DEVICE_FEATURES = {
 	0, // VkBool32    shaderStorageImageReadWithoutFormat;
 	0, // VkBool32    shaderStorageImageWriteWithoutFormat;
 	0, // VkBool32    shaderUniformBufferArrayDynamicIndexing;
-	0, // VkBool32    shaderSampledImageArrayDynamicIndexing;
+	1, // VkBool32    shaderSampledImageArrayDynamicIndexing;
 	0, // VkBool32    shaderStorageBufferArrayDynamicIndexing;
 	0, // VkBool32    shaderStorageImageArrayDynamicIndexing;
 	0, // VkBool32    shaderClipDistance;
@@ -90,13 +106,35 @@ const VkPhysicalDeviceFeatures ENABLED_PHYSICAL_DEVICE_FEATURES = {
 	0, // VkBool32    variableMultisampleRate;
 	0  // VkBool32    inheritedQueries;
 };
+// Chained into the logical device. Devices that don't support every feature enabled here are skipped.
+const VkPhysicalDeviceVulkan12Features ENABLED_VULKAN_12_FEATURES = {
+	.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+	.pNext = nullptr,
+	.descriptorIndexing = VK_TRUE,
+	.shaderSampledImageArrayNonUniformIndexing = VK_TRUE,
+	.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+	.descriptorBindingUpdateUnusedWhilePending = VK_TRUE,
+	.descriptorBindingPartiallyBound = VK_TRUE,
+	.runtimeDescriptorArray = VK_TRUE,
+	.timelineSemaphore = VK_TRUE
+};
 const int WINDOW_WIDTH = 1280;
 const int WINDOW_HEIGHT = 960;
+const VkFormat HEADLESS_COLOR_FORMAT = VK_FORMAT_R8G8B8A8_UNORM;			// Tightly packed RGBA, so readbacks can be written out as is
+const uint32_t FRAME_STREAM_QUEUE_DEPTH = 8;				// Frames the sink worker may fall behind before Draw() blocks on it
+const uint32_t FRAME_STREAM_FPS = 60;
+const std::string PIPELINE_CACHE_PATH = "./pipeline_cache.bin";
+const std::string SHADER_DIRECTORY = "./Resources/Shaders";
+const uint32_t SHADER_CACHE_VERSION = 1;						// Bump to force every shader to recompile
+const uint32_t SHADER_RELOAD_DEBOUNCE_MS = 50;				// Editors save in bursts, wait for the directory to settle
+const std::string MODEL_DIRECTORY = "./Resources/Models";
+const std::string COOKED_MODEL_EXTENSION = ".ntmodel";		// Cooked file sits next to its source, X.obj -> X.obj.ntmodel
+const uint32_t COOKED_MODEL_VERSION = 1;					// Bump when the cooked layout or the import settings change
 const std::string APPLICATION_TITLE = "Nocturne Renderer";
 const std::string ENGINE_TITLE = "Nocturne Engine";
 const uint32_t APPLICATION_VERSION = VK_MAKE_VERSION(1, 0, 0);
 const uint32_t ENGINE_VERSION = VK_MAKE_VERSION(1, 0, 0);
-const uint32_t VULKAN_API_VERSION = VK_API_VERSION_1_1;
+const uint32_t VULKAN_API_VERSION = VK_API_VERSION_1_2;
 
 static std::string NT_CHECK_RESULT(int code) {
 	switch (code) {
@@ -220,25 +258,114 @@ static std::string NT_CHECK_RESULT(int code) {
 	}
 }
 
+static std::string NT_MEMORY_PROPERTY_STRING(VkMemoryPropertyFlags flags) {
+	std::string result;
+	if (flags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) {
+		result += "DEVICE_LOCAL | ";
+	}
+	if (flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+		result += "HOST_VISIBLE | ";
+	}
+	if (flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) {
+		result += "HOST_COHERENT | ";
+	}
+	if (flags & VK_MEMORY_PROPERTY_HOST_CACHED_BIT) {
+		result += "HOST_CACHED | ";
+	}
+	if (flags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) {
+		result += "LAZILY_ALLOCATED | ";
+	}
+	if (flags & VK_MEMORY_PROPERTY_PROTECTED_BIT) {
+		result += "PROTECTED | ";
+	}
+	return result.empty() ? "NONE" : result.substr(0, result.size() - 3);
+}
+
+/*
+
+	Describes what a resource wants from the memory it lives in.
+		- mRequired:  every one of these flags must be present
+		- mPreferred: every one of these flags that is present makes the memory type rank higher
+		- mForbidden: none of these flags may be present
+
+*/
+struct MemoryTypeRequest {
+	VkMemoryPropertyFlags mRequired;
+	VkMemoryPropertyFlags mPreferred;
+	VkMemoryPropertyFlags mForbidden;
+};
+
+static uint32_t CountFlagBits(VkMemoryPropertyFlags flags) {
+	uint32_t count = 0;
+	for (; flags != 0; flags &= flags - 1) {
+		count++;
+	}
+	return count;
+}
+
+/*
+
+	Ranks every allowed memory type against the request and returns the best one, or UINT32_MAX if none qualify.
+	Ranking (most important first):
+		1. Number of preferred flags present
+		2. Fewest flags nobody asked for. This keeps staging buffers out of the device local BAR
+		   window and keeps device local resources out of host visible types they don't need.
+		3. Size of the heap backing the memory type
+
+*/
+static uint32_t RankMemoryTypes(const VkPhysicalDeviceMemoryProperties& memoryProperties, uint32_t allowedTypes, MemoryTypeRequest request) {
+	uint32_t bestIndex = UINT32_MAX;
+	uint32_t bestPreferred = 0, bestUnwanted = 0;
+	VkDeviceSize bestHeapSize = 0;
+
+	for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+		VkMemoryPropertyFlags flags = memoryProperties.memoryTypes[i].propertyFlags;
+
+		if (!(allowedTypes & (1 << i)) || (flags & request.mRequired) != request.mRequired || (flags & request.mForbidden) != 0) {
+			continue;
+		}
+
+		uint32_t preferred = CountFlagBits(flags & request.mPreferred);
+		uint32_t unwanted = CountFlagBits(flags & ~(request.mRequired | request.mPreferred));
+		VkDeviceSize heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[i].heapIndex].size;
+
+		bool better = bestIndex == UINT32_MAX;
+		if (!better && preferred != bestPreferred) {
+			better = preferred > bestPreferred;
+		} else if (!better && unwanted != bestUnwanted) {
+			better = unwanted < bestUnwanted;
+		} else if (!better) {
+			better = heapSize > bestHeapSize;
+		}
+
+		if (better) {
+			bestIndex = i;
+			bestPreferred = preferred;
+			bestUnwanted = unwanted;
+			bestHeapSize = heapSize;
+		}
+	}
+
+	return bestIndex;
+}
+
 /*
 
 	This function is used to find the memory type index that has all the required property bits set.
 	It loops through all the memory types available on the device and checks if their bit field matches
-	the desired properties. Once it finds a memory type that fits all the properties we need, it returns
+	the desired properties. The candidates are ranked with RankMemoryTypes() so the first match isn't
+	blindly taken (e.g. a host visible request landing in the device local BAR window).
 
 */
 static uint32_t FindMemoryTypeIndex(VkPhysicalDevice device, uint32_t allowedTypes, VkMemoryPropertyFlags properties) {
 	VkPhysicalDeviceMemoryProperties memoryProperties;
 	vkGetPhysicalDeviceMemoryProperties(device, &memoryProperties);
 
-	for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
-		if ((allowedTypes & (1 << i)) && ((memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)) {
-			return i; // Valid Memory type, so return its index
-		}
+	uint32_t index = RankMemoryTypes(memoryProperties, allowedTypes, { properties, 0, 0 });
+	if (index == UINT32_MAX) {
+		throw std::runtime_error("Failed to find a suitable memory type!");
 	}
 
-	throw std::runtime_error("Failed to find a suitable memory type!");
-
-	return UINT32_MAX;
+	return index;
 }
 #endif
\ No newline at end of file
@@ -3,43 +3,181 @@
 #include "stb_image.h"
 
 #include <iostream>
-#include <filesystem>
+#include <thread>
+#include <string>
+#include <cstring>
+#include <algorithm>
 
 #include "WindowWrapper.h"
 #include "Renderer.h"
+#include "FrameSink.h"
+#include "PipelineRegistry.h"
+#include "ShaderCompiler.h"
+#include "CookedModel.h"
+#include "globals.h"
 
+// Compiles whatever changed since the last run, in parallel. Warm starts only hash the sources.
 void PreCompileShaders() {
-	std::string pathToPrint = std::filesystem::current_path().string() + "\\Resources\\Shaders\\";
-
-	for (const auto& entry : std::filesystem::directory_iterator(pathToPrint)) {
-		std::string extension = entry.path().extension().string();
-		std::string filename = entry.path().filename().string();
-		// std::string justFileName = filename.substr(0, filename.rfind('.'));
-
-		if (extension != ".spv") {
-			std::cout << "Precompiling "; std::string command = "C:\\VulkanSDK\\1.3.250.1\\Bin\\glslangValidator.exe -o .\\Resources\\Shaders\\" + filename + ".spv -V .\\Resources\\Shaders\\" + filename;
-			int returnValue = system(command.c_str());
-			if (returnValue != 0) {
-				throw std::runtime_error("Failed to pre-compile shader!");
+	ShaderCompiler compiler(std::thread::hardware_concurrency());
+	compiler.CompileDirectory(SHADER_DIRECTORY);
+}
+
+/*
+
+	Every combination of a handful of raster, depth and blend settings, with and without USE_TEXTURE,
+	192 in total. Stands in for a scene with a lot of materials: they're all queued at startup and
+	compiled in the background. Meshes pick the USE_TEXTURE variant that matches their texture, so
+	both have to be prewarmed.
+
+*/
+std::vector<PipelineStateDescription> MaterialPermutations() {
+	std::vector<VkCullModeFlags> cullModes = { VK_CULL_MODE_NONE, VK_CULL_MODE_BACK_BIT, VK_CULL_MODE_FRONT_BIT };
+	std::vector<VkCompareOp> compareOps = { VK_COMPARE_OP_LESS, VK_COMPARE_OP_LESS_OR_EQUAL, VK_COMPARE_OP_ALWAYS, VK_COMPARE_OP_NOT_EQUAL };
+
+	std::vector<PipelineStateDescription> permutations;
+	for (VkCullModeFlags cullMode : cullModes) {
+		for (VkCompareOp compareOp : compareOps) {
+			for (uint32_t flags = 0; flags < 16; flags++) {
+				PipelineStateDescription state = DefaultPipelineState();
+				state.mCullMode = cullMode;
+				state.mDepthCompareOp = compareOp;
+				state.mFrontFace = (flags & 1) ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE;
+				state.mBlendEnable = (flags & 2) ? VK_FALSE : VK_TRUE;
+				state.mDepthWriteEnable = (flags & 4) ? VK_FALSE : VK_TRUE;
+				state.mSpecialization[SPEC_USE_TEXTURE] = (flags & 8) ? VK_TRUE : VK_FALSE;
+				permutations.push_back(state);
 			}
+		}
+	}
+	return permutations;
+}
+
+// Spins the two cubes, the model and the camera, shared by the windowed and the headless loop
+void UpdateScene(Renderer& renderer, float angle) {
+	glm::mat4 model1(1.0f);
+
+	model1 = glm::scale(model1, glm::vec3(0.5f, 0.5f, 0.5f));
+
+	model1 = glm::translate(model1, glm::vec3(-2.0f, 0.0f, 0.0f));
+
+	model1 = glm::rotate(model1, angle, glm::vec3(1.0f, 0.0f, 1.0f));
+
+	renderer.UpdateModel(0, model1);
+
+	glm::mat4 model2(1.0f);
+
+	model2 = glm::scale(model2, glm::vec3(0.5f, 0.5f, 0.5f));
+
+	model2 = glm::translate(model2, glm::vec3(2.0f, 0.0f, 0.0f));
+
+	model2 = glm::rotate(model2, -angle, glm::vec3(1.0f, 0.0f, 1.0f));
+
+	renderer.UpdateModel(1, model2);
+
+	glm::mat4 model3(1.0f);
+
+	model3 = glm::translate(model3, glm::vec3(0.0f, 1.5f, 0.0f));
+
+	model3 = glm::scale(model3, glm::vec3(0.3f, 0.3f, 0.3f));
+
+	model3 = glm::rotate(model3, angle, glm::vec3(0.0f, 1.0f, 0.0f));
+
+	renderer.UpdateModel(3, model3);
+
+	glm::mat4 view(1.0f);
+
+	view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -5.0f));
+
+	view = glm::rotate(view, angle, glm::vec3(0.0f, 1.0f, 0.0f));
+
+	renderer.UpdateCamera(view);
+}
+
+/*
+
+	Renders a fixed number of frames without a window, stepping time at 60 Hz so the output is the
+	same on every machine. Either every frame is streamed into a frame sink, or only the last one is
+	written to disk.
+
+*/
+void RunHeadless(uint32_t frameCount, std::string outputPath, std::string streamPath) {
+	FrameSink* sink = streamPath.empty() ? nullptr : CreateFrameSink(streamPath);
+
+	try {
+		Renderer gRenderer(WINDOW_WIDTH, WINDOW_HEIGHT);
+		gRenderer.SetFrameSink(sink);
+
+		float angle = 0.0f;
+		for (uint32_t i = 0; i < frameCount; i++) {
+			angle = angle + 1.0f / (float)FRAME_STREAM_FPS;
+			UpdateScene(gRenderer, angle);
+			gRenderer.Draw();
+		}
+
+		if (sink != nullptr) {
+			gRenderer.SetFrameSink(nullptr);
 		} else {
-			continue;
+			gRenderer.SaveLastFrame(outputPath);
 		}
+	} catch (...) {
+		delete sink;
+		throw;
 	}
+	delete sink;
 }
 
-int main() {
+int main(int argc, char** argv) {
 	int gProgramSuccess = EXIT_SUCCESS;
 
+	bool headless = false;
+	bool cook = false;
+	uint32_t frameCount = 1;
+	std::string outputPath = "frame.png";
+	std::string streamPath;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--headless") == 0) {
+			headless = true;
+		} else if (strcmp(argv[i], "--cook") == 0) {
+			cook = true;
+		} else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+			frameCount = (uint32_t)std::max(1, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+			outputPath = argv[++i];
+		} else if (strcmp(argv[i], "--stream") == 0 && i + 1 < argc) {
+			streamPath = argv[++i];
+		} else {
+			std::cout << "Usage: " << argv[0] << " [--cook] [--headless [--frames N] [--output path.png|path.ppm] [--stream path.rgba|path.y4m|prefix]]" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
 	try {
+		// Offline step, writes the cooked files LoadModel() maps instead of importing and exits
+		if (cook) {
+			uint32_t cooked = CookModelDirectory(MODEL_DIRECTORY);
+			std::cout << "Cooked " << cooked << " model(s) in " << MODEL_DIRECTORY << "." << std::endl;
+			return gProgramSuccess;
+		}
+
 		PreCompileShaders();
 
+		if (headless) {
+			RunHeadless(frameCount, outputPath, streamPath);
+			return gProgramSuccess;
+		}
+
 		WindowWrapper gWindow;
 		Renderer gRenderer(&gWindow);
 
+		std::vector<PipelineStateDescription> materials = MaterialPermutations();
+		gRenderer.PrewarmPipelines(materials);
+		size_t material = 0;
+		bool materialKeyDown = false;
+
 		float angle = 0.0f;
 		float deltaTime = 0.0f;
 		float lastTime = 0.0f;
+		float lastTitleTime = 0.0f;
 
 		while (!glfwWindowShouldClose(gWindow.GetWindow())) {
 			float now = (float)glfwGetTime();
@@ -48,37 +186,41 @@ int main() {
 
 			glfwPollEvents();
 
-			angle = angle + 1.0f * deltaTime;
-
-			glm::mat4 model1(1.0f);
-
-			model1 = glm::scale(model1, glm::vec3(0.5f, 0.5f, 0.5f));
-
-			model1 = glm::translate(model1, glm::vec3(-2.0f, 0.0f, 0.0f));
-
-			model1 = glm::rotate(model1, angle, glm::vec3(1.0f, 0.0f, 1.0f));			
-
-			gRenderer.UpdateModel(0, model1);
-
-			glm::mat4 model2(1.0f);
-
-			model2 = glm::scale(model2, glm::vec3(0.5f, 0.5f, 0.5f));
-
-			model2 = glm::translate(model2, glm::vec3(2.0f, 0.0f, 0.0f));
-
-			model2 = glm::rotate(model2, -angle, glm::vec3(1.0f, 0.0f, 1.0f));
-
-			gRenderer.UpdateModel(1, model2);
+			// Don't spin while minimized, the renderer would skip the frames anyway
+			if (gWindow.IsMinimized()) {
+				glfwWaitEvents();
+				continue;
+			}
 
-			glm::mat4 view(1.0f);
+			// 1-4 select how many frames may be in flight
+			for (int key = GLFW_KEY_1; key <= GLFW_KEY_4; key++) {
+				if (glfwGetKey(gWindow.GetWindow(), key) == GLFW_PRESS) {
+					gRenderer.SetFramesInFlight((uint32_t)(key - GLFW_KEY_0));
+				}
+			}
 
-			view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -5.0f));
+			// M gives the cubes the next material, whether or not its pipeline has finished compiling
+			bool materialKeyPressed = glfwGetKey(gWindow.GetWindow(), GLFW_KEY_M) == GLFW_PRESS;
+			if (materialKeyPressed && !materialKeyDown) {
+				material = (material + 1) % materials.size();
+				gRenderer.SetMeshPipelineState(0, materials.at(material));
+				gRenderer.SetMeshPipelineState(1, materials.at(material));
+			}
+			materialKeyDown = materialKeyPressed;
 
-			view = glm::rotate(view, angle, glm::vec3(0.0f, 1.0f, 0.0f));
+			angle = angle + 1.0f * deltaTime;
 
-			gRenderer.UpdateCamera(view);
+			UpdateScene(gRenderer, angle);
 
 			gRenderer.Draw();
+
+			if (now - lastTitleTime > 0.5f) {
+				lastTitleTime = now;
+				FramePacingStats stats = gRenderer.GetFramePacingStats();
+				PipelineRegistryStats pipelineStats = gRenderer.GetPipelineStats();
+				std::string title = APPLICATION_TITLE + " | " + std::to_string(gRenderer.GetFramesInFlight()) + " frames in flight | CPU stall " + std::to_string(stats.mAverageStall) + " ms avg, " + std::to_string(stats.mMaxStall) + " ms max | " + std::to_string(pipelineStats.mPipelinesCreated) + " pipelines, " + std::to_string(pipelineStats.mPipelinesPending) + " compiling";
+				glfwSetWindowTitle(gWindow.GetWindow(), title.c_str());
+			}
 		}
 
 	} catch (const std::runtime_error& e) {
@@ -86,8 +228,10 @@ int main() {
 		gProgramSuccess = EXIT_FAILURE;
 	}
 
-	#ifndef NDEBUG
-		system("PAUSE");
+	#if defined(_WIN32) && !defined(NDEBUG)
+		if (!headless) {
+			system("PAUSE");
+		}
 	#endif
 
 	return gProgramSuccess;